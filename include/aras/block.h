@@ -36,6 +36,7 @@
 #define ARAS_BLOCK_MAX_NAME             256
 #define ARAS_BLOCK_MAX_TYPE             32
 #define ARAS_BLOCK_MAX_DATA             1024
+#define ARAS_BLOCK_MAX_FADE             32
 
 #define ARAS_BLOCK_TYPE_FILE            0
 #define ARAS_BLOCK_TYPE_PLAYLIST        1
@@ -43,14 +44,21 @@
 #define ARAS_BLOCK_TYPE_RANDOM_FILE     3
 #define ARAS_BLOCK_TYPE_INTERLEAVE      4
 
+#define ARAS_BLOCK_TRANSITION_CROSSFADE 0
+#define ARAS_BLOCK_TRANSITION_GAPLESS   1
+
 struct aras_block_node {
-        char name[ARAS_BLOCK_MAX_NAME];
+        const char *name;                   /* Interned block name */
         int type;
-        char data[ARAS_BLOCK_MAX_DATA];
+        char *data;
+        int fade_curve;                     /* Fade curve, -1 for the global one */
+        int fade_time;                      /* Fade time, -1 for the global one */
+        int transition;                     /* Transition between consecutive files */
 };
 
 struct aras_block {
         GList *list;
+        GHashTable *table;                  /* Block name quark to block node */
 };
 
 int aras_block_init(struct aras_block *block);
@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the command module. A command queue is a bounded ring with a single producer
+ * thread and a single consumer thread, which never lock each other.
+ */
+
+#ifndef _ARAS_COMMAND_H
+#define _ARAS_COMMAND_H
+
+#include <glib.h>
+
+#define ARAS_COMMAND_QUEUE_SIZE         64
+#define ARAS_COMMAND_MAX_ARGUMENT       1024
+
+#define ARAS_COMMAND_NONE               0
+#define ARAS_COMMAND_PLAY_PREVIOUS      1
+#define ARAS_COMMAND_PLAY_CURRENT       2
+#define ARAS_COMMAND_PLAY_NEXT          3
+#define ARAS_COMMAND_PLAY_DEFAULT       4
+#define ARAS_COMMAND_PLAY_BLOCK         5
+#define ARAS_COMMAND_INSERT_URI         6
+#define ARAS_COMMAND_FADE_OUT           7
+
+struct aras_command {
+        int type;                           /* ARAS_COMMAND_* value */
+        long long int time;                 /* Monotonic time at which the command was sent */
+        char argument[ARAS_COMMAND_MAX_ARGUMENT];  /* Block name or URI */
+};
+
+struct aras_command_queue {
+        struct aras_command commands[ARAS_COMMAND_QUEUE_SIZE];
+        gint head;                          /* Next command to pop, written by the consumer */
+        gint tail;                          /* Next free slot, written by the producer */
+        void (*callback_wake)(void *data);
+        void *callback_wake_data;
+};
+
+int aras_command_queue_init(struct aras_command_queue *queue);
+int aras_command_queue_push(struct aras_command_queue *queue, int type, char *argument);
+int aras_command_queue_pop(struct aras_command_queue *queue, struct aras_command *command);
+void aras_command_queue_set_callback_wake(struct aras_command_queue *queue, void (*callback_wake)(void *data), void *data);
+
+#endif  /* _ARAS_COMMAND_H */
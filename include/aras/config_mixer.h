@@ -0,0 +1,39 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Headers for
+ * application wide configuration.
+ */
+#ifndef _CONFIG_H
+#define _CONFIG_H
+
+#define ARAS_CONFIG_MEDIA_LIBRARY_GST   0
+#define ARAS_CONFIG_MEDIA_LIBRARY_VLC   1
+#define ARAS_CONFIG_MEDIA_LIBRARY_GST_MIXER 2
+#define ARAS_CONFIG_MEDIA_LIBRARY_SIM   3
+
+#define ARAS_CONFIG_MEDIA_LIBRARY       ARAS_CONFIG_MEDIA_LIBRARY_GST_MIXER
+
+#endif
\ No newline at end of file
@@ -31,6 +31,8 @@
 
 #define ARAS_CONFIG_MEDIA_LIBRARY_GST   0
 #define ARAS_CONFIG_MEDIA_LIBRARY_VLC   1
+#define ARAS_CONFIG_MEDIA_LIBRARY_GST_MIXER 2
+#define ARAS_CONFIG_MEDIA_LIBRARY_SIM   3
 
 #define ARAS_CONFIG_MEDIA_LIBRARY       ARAS_CONFIG_MEDIA_LIBRARY_VLC
 
@@ -34,12 +34,27 @@
 #define ARAS_CONFIGURATION_MAX_DIRECTIVE            32
 #define ARAS_CONFIGURATION_MAX_ARGUMENT             1024
 
+#define ARAS_CONFIGURATION_MIN_DECKS                2
+#define ARAS_CONFIGURATION_MAX_DECKS                8
+
 #define ARAS_CONFIGURATION_MODE_DEFAULT_BLOCK_OFF   0
 #define ARAS_CONFIGURATION_MODE_DEFAULT_BLOCK_ON    1
 
+#define ARAS_CONFIGURATION_MODE_CONFIGURATION_POLL  0
+#define ARAS_CONFIGURATION_MODE_CONFIGURATION_WATCH 1
+
+#define ARAS_CONFIGURATION_MODE_ENGINE_PERIODIC     0
+#define ARAS_CONFIGURATION_MODE_ENGINE_EVENT        1
+
 #define ARAS_CONFIGURATION_MODE_SCHEDULE_HARD       0
 #define ARAS_CONFIGURATION_MODE_SCHEDULE_SOFT       1
 
+#define ARAS_CONFIGURATION_MODE_FADE_CURVE_EXPONENTIAL  0
+#define ARAS_CONFIGURATION_MODE_FADE_CURVE_LINEAR       1
+#define ARAS_CONFIGURATION_MODE_FADE_CURVE_EQUAL_POWER  2
+#define ARAS_CONFIGURATION_MODE_FADE_CURVE_LOGARITHMIC  3
+#define ARAS_CONFIGURATION_MODE_FADE_CURVE_S_CURVE      4
+
 #define ARAS_CONFIGURATION_MODE_TIME_SIGNAL_OFF     0
 #define ARAS_CONFIGURATION_MODE_TIME_SIGNAL_HALF    1
 #define ARAS_CONFIGURATION_MODE_TIME_SIGNAL_HOUR    2
@@ -60,33 +75,46 @@
 #define ARAS_CONFIGURATION_MODE_VIDEO_FB            4
 #define ARAS_CONFIGURATION_MODE_VIDEO_GL            5
 #define ARAS_CONFIGURATION_MODE_VIDEO_FILE          6
+#define ARAS_CONFIGURATION_MODE_VIDEO_NONE          7
 
 struct aras_configuration {
 
         /* Configuration files */
         int configuration_period;
+        int configuration_mode;
         char schedule_file[ARAS_CONFIGURATION_MAX_ARGUMENT];
         char block_file[ARAS_CONFIGURATION_MAX_ARGUMENT];
         char log_file[ARAS_CONFIGURATION_MAX_ARGUMENT];
+        char media_index_file[ARAS_CONFIGURATION_MAX_ARGUMENT];
+        char status_segment[ARAS_CONFIGURATION_MAX_ARGUMENT];
+        int status_period;
+        char control_socket[ARAS_CONFIGURATION_MAX_ARGUMENT];
 
         /* Engine configuration */
         int engine_period;
+        int engine_mode;
         int schedule_mode;
+        int prefetch_time;
         int default_block_mode;
         char default_block[ARAS_CONFIGURATION_MAX_ARGUMENT];
         int fade_out_time;
         float fade_out_slope;
+        int fade_curve;
+        int preroll_time;
         int time_signal_mode;
         int time_signal_advance;
         char time_signal_block[ARAS_CONFIGURATION_MAX_ARGUMENT];
+        unsigned int random_seed;
 
         /* Block player configuration */
         char block_player_name[ARAS_CONFIGURATION_MAX_ARGUMENT];
+        int block_player_decks;
         int block_player_audio_output;
         char block_player_audio_device[ARAS_CONFIGURATION_MAX_ARGUMENT];
         float block_player_volume;
         int block_player_sample_rate;
         int block_player_channels;
+        int block_player_resample_quality;
         int block_player_video_output;
         char block_player_video_device[ARAS_CONFIGURATION_MAX_ARGUMENT];
         char block_player_video_display[ARAS_CONFIGURATION_MAX_ARGUMENT];
@@ -94,11 +122,13 @@ struct aras_configuration {
 
         /* Time signal player configuration */
         char time_signal_player_name[ARAS_CONFIGURATION_MAX_ARGUMENT];
+        int time_signal_player_decks;
         int time_signal_player_audio_output;
         char time_signal_player_audio_device[ARAS_CONFIGURATION_MAX_ARGUMENT];
         float time_signal_player_volume;
         int time_signal_player_sample_rate;
         int time_signal_player_channels;
+        int time_signal_player_resample_quality;
         int time_signal_player_video_output;
         char time_signal_player_video_device[ARAS_CONFIGURATION_MAX_ARGUMENT];
         char time_signal_player_video_display[ARAS_CONFIGURATION_MAX_ARGUMENT];
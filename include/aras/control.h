@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the control module. A control server listens on a Unix domain socket in the
+ * main context of a channel. Clients send one command per line and may
+ * subscribe to the engine events, which are written in batches without ever
+ * blocking the channel.
+ */
+
+#ifndef _ARAS_CONTROL_H
+#define _ARAS_CONTROL_H
+
+#include <glib.h>
+#include <aras/command.h>
+
+#define ARAS_CONTROL_MAX_PATH       108     /* Size of sun_path */
+#define ARAS_CONTROL_MAX_LINE       2048
+#define ARAS_CONTROL_MAX_BUFFER     65536   /* Pending output of a client before dropping it */
+#define ARAS_CONTROL_MAX_CLIENTS    32
+#define ARAS_CONTROL_BACKLOG        8
+
+struct aras_control;
+
+struct aras_control_client {
+        struct aras_control *control;
+        int fd;
+        GIOChannel *channel;
+        guint source_in;
+        guint source_out;                   /* Waiting for the socket to be writable, 0 if not */
+        GString *input;                     /* Incomplete command line */
+        GString *output;                    /* Replies and events not written yet */
+        int subscribed;                     /* 1 if the client receives events */
+        int closed;                         /* 1 if the client is to be dropped */
+};
+
+struct aras_control {
+        char path[ARAS_CONTROL_MAX_PATH];
+        int fd;
+        GMainContext *context;              /* Main context of the thread running the server */
+        GIOChannel *channel;
+        guint source;
+        guint source_flush;                 /* Pending flush of a batch, 0 if none */
+        GList *clients;
+        struct aras_command_queue *command_queue;
+        void (*callback_reload)(void *data);
+        void *callback_reload_data;
+};
+
+int aras_control_init(struct aras_control *control, char *path, struct aras_command_queue *command_queue);
+void aras_control_set_callback_reload(struct aras_control *control, void (*callback_reload)(void *data), void *data);
+void aras_control_event(struct aras_control *control, char *source, char *type, char *argument);
+
+#endif  /* _ARAS_CONTROL_H */
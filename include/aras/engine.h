@@ -35,11 +35,18 @@
 #include <aras/configuration.h>
 #include <aras/schedule.h>
 #include <aras/block.h>
+#include <aras/fade.h>
 #if (ARAS_CONFIG_MEDIA_LIBRARY == ARAS_CONFIG_MEDIA_LIBRARY_GST)
 #include <aras/player.h>
 #elif (ARAS_CONFIG_MEDIA_LIBRARY == ARAS_CONFIG_MEDIA_LIBRARY_VLC)
 #include <aras/player_vlc.h>
+#elif (ARAS_CONFIG_MEDIA_LIBRARY == ARAS_CONFIG_MEDIA_LIBRARY_GST_MIXER)
+#include <aras/player_mixer.h>
+#elif (ARAS_CONFIG_MEDIA_LIBRARY == ARAS_CONFIG_MEDIA_LIBRARY_SIM)
+#include <aras/player_sim.h>
 #endif
+#include <aras/command.h>
+#include <aras/status.h>
 
 #define ARAS_ENGINE_STATE_NULL                  0
 #define ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD 1
@@ -52,18 +59,57 @@
 #define ARAS_ENGINE_STATE_CROSSFADE             8
 #define ARAS_ENGINE_STATE_FADE_OUT              9
 
+#define ARAS_ENGINE_TIMEOUT_MAXIMUM             60000
+
+/* Playlist loaded in advance, shared by the engine and the prefetch thread */
+struct aras_engine_prefetch {
+        gint done;                          /* 1 once the playlist is loaded */
+        long int time;
+        const char *block_name;
+        struct aras_block *block;
+        struct aras_block_node *block_node;
+        GRand *rand;
+        GList *playlist;
+};
+
 struct aras_engine {
         int state;
-        long int state_time_elapsed;
+        gint64 state_time_start;            /* Monotonic start of the timed part of the state */
         long int state_time_maximum;
         GList *playlist;
         GList *playlist_current_node;
         int pending_playlist;
+        long int trigger_time;
+        int hold_default_block;             /* 1 to skip the default block until the next schedule node */
+        GRand *rand;
+        struct aras_engine_prefetch *prefetch;  /* Prefetch of the next schedule node, NULL if none */
+        char *preroll_uri;
+        int preroll_unit;
+        gint64 preroll_ready_time;
+        int block_fade_curve;               /* Fade curve of the current block, -1 for the global one */
+        int block_fade_time;                /* Fade time of the current block, -1 for the global one */
+        int block_transition;               /* Transition between files of the current block */
+        char *gapless_uri;                  /* URI queued in the current unit, NULL if none */
+        struct aras_fade fade;              /* Gain tables of the fade in progress */
+        struct aras_command_queue *command_queue;   /* Commands drained every cycle, NULL if none */
+        long long int command_time;         /* Monotonic time of the command to put on air, 0 if none */
+        char *event_uri;                    /* URI reported on air, NULL if none */
+        void (*callback_wake)(void *data);
+        void *callback_wake_data;
+        void (*callback_event)(void *data, char *type, char *argument);
+        void *callback_event_data;
 };
 
 int aras_engine_init(struct aras_engine *engine);
 void aras_engine_schedule(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration, struct aras_schedule *schedule, struct aras_block *block);
 void aras_engine_time_signal(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration, struct aras_block *block);
 void aras_engine_set_state(struct aras_engine *engine, int state, long int state_time_maximum);
+void aras_engine_set_random_seed(struct aras_engine *engine, unsigned int seed);
+void aras_engine_set_command_queue(struct aras_engine *engine, struct aras_command_queue *queue);
+void aras_engine_set_callback_wake(struct aras_engine *engine, void (*callback_wake)(void *data), void *data);
+void aras_engine_set_callback_event(struct aras_engine *engine, void (*callback_event)(void *data, char *type, char *argument), void *data);
+void aras_engine_status(struct aras_engine *engine, struct aras_player *player, struct aras_status_player *status);
+long int aras_engine_schedule_timeout(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration, struct aras_schedule *schedule);
+long int aras_engine_time_signal_timeout(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration);
 
 #endif  /* _ARAS_ENGINE_H */
@@ -0,0 +1,45 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the fade module.
+ */
+
+#ifndef _ARAS_FADE_H
+#define _ARAS_FADE_H
+
+#define ARAS_FADE_POINTS                64
+#define ARAS_FADE_LOGARITHMIC_RANGE     60.0    /* Range in dB of logarithmic curves */
+
+struct aras_fade {
+        int curve;                          /* ARAS_CONFIGURATION_MODE_FADE_CURVE_* value */
+        long int time;                      /* Duration in miliseconds */
+        float in[ARAS_FADE_POINTS + 1];     /* Progress of rising volumes */
+        float out[ARAS_FADE_POINTS + 1];    /* Progress of falling volumes */
+};
+
+void aras_fade_init(struct aras_fade *fade, int curve, long int time, float slope, int period);
+
+#endif  /* _ARAS_FADE_H */
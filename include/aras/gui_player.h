@@ -35,6 +35,8 @@
 #include <aras/schedule.h>
 #include <aras/block.h>
 #include <aras/engine.h>
+#include <aras/snapshot.h>
+#include <aras/command.h>
 
 #define ARAS_GUI_PLAYER_PATH_ICON       "/usr/share/aras/icons/aras-player-icon.png"
 #define ARAS_GUI_PLAYER_COMMENTS        "The ARAS Radio Automation System"
@@ -111,13 +113,36 @@ struct aras_gui_player {
         int quit_dialog_count;
 };
 
+/* Structure for the status of the block player, published by the engine thread */
+struct aras_gui_player_status {
+        GMutex mutex;
+        int engine_state;
+        int playlist;                       /* 1 if the engine has a playlist */
+        int file_current;                   /* 1 if a file has been played */
+        int file_previous;                  /* 1 if there is a previous file */
+        int file_next;                      /* 1 if there is a next file */
+        char file_current_name[ARAS_GUI_PLAYER_LABEL_MAX];
+        char file_next_name[ARAS_GUI_PLAYER_LABEL_MAX];
+        long int position;
+        long int duration;
+        int player_state;
+        int block_current;                  /* 1 if there is a current block */
+        int block_next;                     /* 1 if there is a next block */
+        char block_current_name[ARAS_GUI_PLAYER_LABEL_MAX];
+        char block_next_name[ARAS_GUI_PLAYER_LABEL_MAX];
+        long int block_current_time;
+        long int block_next_time;
+};
+
 /* Structure for callback data */
 struct aras_gui_player_callback {
-        struct aras_engine *engine;
-        struct aras_configuration *configuration;
+        struct aras_gui_player_status *status;
+        struct aras_command_queue *command_queue;
 };
 
-void aras_gui_player_update(struct aras_gui_player *gui, struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration, struct aras_schedule *schedule);
-void aras_gui_player_init(struct aras_gui_player *gui, struct aras_engine *engine, struct aras_configuration *configuration);
+void aras_gui_player_status_init(struct aras_gui_player_status *status);
+void aras_gui_player_status_publish(struct aras_gui_player_status *status, struct aras_engine *engine, struct aras_player *player, struct aras_schedule *schedule);
+void aras_gui_player_update(struct aras_gui_player *gui, struct aras_gui_player_status *status);
+void aras_gui_player_init(struct aras_gui_player *gui, struct aras_gui_player_status *status, struct aras_command_queue *command_queue);
 
 #endif  /* _ARAS_GUI_PLAYER_H */
@@ -0,0 +1,47 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the main benchmark module.
+ */
+
+#ifndef _ARAS_MAIN_BENCHMARK_H
+#define _ARAS_MAIN_BENCHMARK_H
+
+#include <aras/configuration.h>
+
+#define ARAS_MAIN_BENCHMARK_SOURCE_RATE     44100
+#define ARAS_MAIN_BENCHMARK_SAMPLES         1024
+#define ARAS_MAIN_BENCHMARK_TIME            60
+#define ARAS_MAIN_BENCHMARK_QUALITY_MIN     0
+#define ARAS_MAIN_BENCHMARK_QUALITY_MAX     10
+
+struct aras_main_benchmark {
+        char *configuration_file;
+        struct aras_configuration configuration;
+        int time;
+};
+
+#endif  /* _ARAS_MAIN_BENCHMARK_H */
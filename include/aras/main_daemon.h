@@ -24,7 +24,8 @@
  * @section DESCRIPTION
  *
  * Header file for the ARAS Radio Automation System. Types and definitions for
- * the main daemon module.
+ * the main daemon module. Each structure is a channel, the daemon runs one for
+ * each configuration file.
  */
 
 #ifndef _ARAS_MAIN_DAEMON_H
@@ -33,17 +34,30 @@
 #include <aras/configuration.h>
 #include <aras/schedule.h>
 #include <aras/block.h>
+#include <aras/snapshot.h>
 #include <aras/engine.h>
+#include <aras/status.h>
+#include <aras/command.h>
+#include <aras/control.h>
 
 struct aras_main_daemon {
+        int channel;                        /* Index of the channel in the daemon */
         char *configuration_file;
-        struct aras_configuration configuration;
-        struct aras_schedule schedule;
-        struct aras_block block;
+        GMainContext *context;              /* Main context of the channel thread */
+        GMainLoop *main_loop;
+        GThread *thread;
+        struct aras_snapshot *snapshot;
+        struct aras_snapshot_reload reload;
         struct aras_engine engine_block_player;
         struct aras_engine engine_time_signal_player;
         struct aras_player block_player;
         struct aras_player time_signal_player;
+        int engine_mode;
+        guint engine_source;
+        int engine_running;
+        struct aras_status status_segment;  /* Shared memory status segment */
+        struct aras_command_queue command_queue;
+        struct aras_control control;        /* Control socket */
 };
 
 #endif  /* _ARAS_MAIN_DAEMON_H */
@@ -33,18 +33,29 @@
 #include <aras/configuration.h>
 #include <aras/schedule.h>
 #include <aras/block.h>
+#include <aras/snapshot.h>
 #include <aras/engine.h>
+#include <aras/status.h>
+#include <aras/command.h>
 #include <aras/gui_player.h>
 
 struct aras_main_player {
         char *configuration_file;
-        struct aras_configuration configuration;
-        struct aras_schedule schedule;
-        struct aras_block block;
+        GMainContext *context;              /* Main context of the engine thread */
+        GMainLoop *main_loop;
+        GThread *thread;
+        struct aras_snapshot *snapshot;
+        struct aras_snapshot_reload reload;
         struct aras_engine engine_block_player;
         struct aras_engine engine_time_signal_player;
         struct aras_player block_player;
         struct aras_player time_signal_player;
+        int engine_mode;
+        guint engine_source;
+        int engine_running;
+        struct aras_status status_segment;  /* Shared memory status segment */
+        struct aras_command_queue command_queue;
+        struct aras_gui_player_status status;
         struct aras_gui_player gui;
 };
 
@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the media module.
+ */
+
+#ifndef _ARAS_MEDIA_H
+#define _ARAS_MEDIA_H
+
+#include <glib.h>
+#include <aras/block.h>
+
+#define ARAS_MEDIA_MAX_RECURSION_DEPTH  16
+#define ARAS_MEDIA_MAX_LINE             4096
+#define ARAS_MEDIA_WATCH_BUFFER         4096
+#define ARAS_MEDIA_UPDATE_DELAY         1000
+
+struct aras_media_stamp {
+        char *path;                         /* Path of a scanned directory */
+        gint64 mtime;                       /* Modification time of the directory */
+};
+
+struct aras_media_directory {
+        GPtrArray *files;                   /* URIs of the regular files */
+        GArray *stamps;                     /* Stamps of the scanned directories */
+        gint64 time;                        /* Time of the scan */
+        int dirty;                          /* Changed since the scan */
+};
+
+int aras_media_init(char *file);
+void aras_media_scan_block(struct aras_block *block);
+int aras_media_watch(void);
+char *aras_media_pick_file(char *path, GRand *rand);
+GList *aras_media_load_directory(GList *playlist, char *path);
+
+#endif  /* _ARAS_MEDIA_H */
@@ -39,8 +39,8 @@
 #define ARAS_PLAYER_MAX_URI             1024
 #define ARAS_PLAYER_MAX_DEVICE          1024
 
-#define ARAS_PLAYER_UNIT_A              0
-#define ARAS_PLAYER_UNIT_B              1
+#define ARAS_PLAYER_MAX_UNITS           8   /* Decks in the pool, see ARAS_CONFIGURATION_MAX_DECKS */
+#define ARAS_PLAYER_UNIT_NONE           -1
 
 #define ARAS_PLAYER_STATE_ERROR         0
 #define ARAS_PLAYER_STATE_BUFFERING     1
@@ -48,31 +48,61 @@
 #define ARAS_PLAYER_STATE_PLAYING       3
 #define ARAS_PLAYER_STATE_OTHER         4
 
+#define ARAS_PLAYER_FLAG_VIDEO          (1 << 0)    /* Playbin flags */
+#define ARAS_PLAYER_FLAG_TEXT           (1 << 2)
+#define ARAS_PLAYER_FLAG_VIS            (1 << 3)
+
 struct aras_player_sink {
         GstElement *bin;
         GstElement *convert;
+        GstElement *resample;
+        GstElement *volume;
         GstElement *sink;
+        GstControlSource *control;          /* Volume ramps */
+        GstControlBinding *binding;
         GstCaps *caps;
         GstPad *pad;
         GstPad *ghost_pad;
 };
 
+struct aras_player_status {
+        int state;                          /* ARAS_PLAYER_STATE_* value */
+        GstState target;                    /* Last requested state */
+        int prerolled;                      /* Paused with the media ready */
+        long int duration;                  /* Duration in miliseconds */
+        long int position;                  /* Position in miliseconds at clock_time */
+        GstClock *clock;                    /* Pipeline clock while playing */
+        GstClockTime clock_time;            /* Clock time of the position */
+        int buffer_percent;
+};
+
+struct aras_player_queue {
+        GMutex lock;                        /* Shared with the streaming threads */
+        char *uri;                          /* URI queued for about-to-finish, NULL if none */
+        int handed;                         /* Queued URI handed to the playbin */
+        int started;                        /* Queued URIs started since the last check */
+};
+
+struct aras_player_deck {
+        struct aras_player *player;         /* Player of the deck, for the bus callback */
+        int unit;
+        int allocated;                      /* Handed out by aras_player_alloc_unit */
+        float volume;
+        GstElement *playbin;
+        GstBus *bus;
+        struct aras_player_status status;   /* Status kept by the bus callback */
+        int playing;                        /* The deck is meant to be playing */
+        struct aras_player_queue queue;     /* Gapless queue */
+        struct aras_player_sink audio_sink;
+        struct aras_player_sink video_sink;
+};
+
 struct aras_player {
         int current_unit;
-        char uri_a[ARAS_PLAYER_MAX_URI];
-        char uri_b[ARAS_PLAYER_MAX_URI];
-        float volume_a;
-        float volume_b;
-        GstElement *playbin_a;
-        GstElement *playbin_b;
-        GstBus *bus_a;
-        GstBus *bus_b;
-        int buffer_percent_a;
-        int buffer_percent_b;
-        struct aras_player_sink audio_sink_a;
-        struct aras_player_sink video_sink_a;
-        struct aras_player_sink audio_sink_b;
-        struct aras_player_sink video_sink_b;
+        int units;                          /* Decks in the pool */
+        struct aras_player_deck deck[ARAS_PLAYER_MAX_UNITS];
+        void (*callback_wake)(void *data);
+        void *callback_wake_data;
 };
 
 int aras_player_init(struct aras_player *player,
@@ -87,20 +117,29 @@ int aras_player_init(struct aras_player *player,
                      int video_resolution[]);
 int aras_player_init_block_player(struct aras_player *player, struct aras_configuration *configuration);
 int aras_player_init_time_signal_player(struct aras_player *player, struct aras_configuration *configuration);
+void aras_player_init_audio_sink_bin(struct aras_player_sink *sink, char *name, int audio_output, char *audio_device, int sample_rate, int channels, int resample_quality);
 void aras_player_set_volume(struct aras_player *player, int unit, float volume);
 void aras_player_set_volume_increment(struct aras_player *player, int unit, float slope, float limit);
+void aras_player_set_volume_ramp(struct aras_player *player, int unit, float limit, long int time, const float *weights, int points);
 void aras_player_set_uri(struct aras_player *player, int unit, gchar *uri);
+int aras_player_set_next_uri(struct aras_player *player, int unit, gchar *uri);
 void aras_player_set_state_null(struct aras_player *player, int unit);
 void aras_player_set_state_ready(struct aras_player *player, int unit);
 void aras_player_set_state_paused(struct aras_player *player, int unit);
 void aras_player_set_state_playing(struct aras_player *player, int unit);
 void aras_player_set_current_unit(struct aras_player *player, int unit);
-void aras_player_swap_current_unit(struct aras_player *player);
+void aras_player_set_callback_wake(struct aras_player *player, void (*callback_wake)(void *data), void *data);
+int aras_player_alloc_unit(struct aras_player *player);
+void aras_player_release_unit(struct aras_player *player, int unit);
 float aras_player_get_volume(struct aras_player *player, int unit);
 void aras_player_get_state(struct aras_player *player, int unit, int *state);
+int aras_player_get_prerolled(struct aras_player *player, int unit);
 int aras_player_get_buffer_percent(struct aras_player *player, int unit);
 int aras_player_get_current_unit(struct aras_player *player);
+int aras_player_get_units(struct aras_player *player);
+int aras_player_get_allocated(struct aras_player *player, int unit);
 long int aras_player_get_duration(struct aras_player *player, int unit);
 long int aras_player_get_position(struct aras_player *player, int unit);
+int aras_player_take_next_started(struct aras_player *player, int unit);
 
 #endif  /* _ARAS_PLAYER_H */
@@ -0,0 +1,127 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the mixer player module, which plays the player units as inputs of a single
+ * audio mixer pipeline.
+ */
+
+#ifndef _ARAS_PLAYER_MIXER_H
+#define _ARAS_PLAYER_MIXER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#define ARAS_PLAYER_MAX_NAME            1024
+#define ARAS_PLAYER_MAX_URI             1024
+#define ARAS_PLAYER_MAX_DEVICE          1024
+
+#define ARAS_PLAYER_MAX_UNITS           8   /* Inputs in the pool, see ARAS_CONFIGURATION_MAX_DECKS */
+#define ARAS_PLAYER_UNITS               2   /* Default number of inputs */
+#define ARAS_PLAYER_UNIT_NONE           -1
+
+#define ARAS_PLAYER_STATE_ERROR         0
+#define ARAS_PLAYER_STATE_BUFFERING     1
+#define ARAS_PLAYER_STATE_STOP          2
+#define ARAS_PLAYER_STATE_PLAYING       3
+#define ARAS_PLAYER_STATE_OTHER         4
+
+#define ARAS_PLAYER_MIXER_START_DELAY   20  /* Miliseconds from start request to mixer input */
+#define ARAS_PLAYER_RESAMPLE_QUALITY    4   /* Default quality of the resamplers */
+
+struct aras_player_input {
+        int allocated;                      /* Handed out by aras_player_alloc_unit */
+        char uri[ARAS_PLAYER_MAX_URI];
+        float volume;
+        GstElement *bin;                    /* Decoding bin, NULL while detached */
+        GstPad *src;                        /* Source pad of the decoding chain */
+        GstPad *ghost_pad;
+        GstPad *mixer_pad;                  /* Mixer request pad, NULL until started */
+        GstControlSource *control;          /* Volume ramps */
+        GstControlBinding *binding;         /* Binding to the mixer pad volume */
+        gulong block_probe;                 /* Probe holding the prerolled data */
+        int state;                          /* ARAS_PLAYER_STATE_* value */
+        GstState target;                    /* Last requested state */
+        int prerolled;                      /* First buffer waiting for the mixer */
+        long int duration;                  /* Duration in miliseconds */
+        GstClockTime start_time;            /* Running time at which the input starts */
+        int buffer_percent;
+};
+
+struct aras_player {
+        int current_unit;
+        GstElement *pipeline;
+        GstElement *source;                 /* Silence keeping the mixer running */
+        GstElement *mixer;
+        GstElement *convert;
+        GstElement *sink;
+        GstCaps *caps;
+        GstBus *bus;
+        int resample_quality;               /* Quality of the resamplers of the inputs */
+        int units;                          /* Inputs in the pool */
+        struct aras_player_input input[ARAS_PLAYER_MAX_UNITS];
+        void (*callback_wake)(void *data);
+        void *callback_wake_data;
+};
+
+int aras_player_init(struct aras_player *player,
+                     char *name,
+                     int audio_output,
+                     char *audio_device,
+                     int audio_sample_rate,
+                     int audio_channels,
+                     int video_output,
+                     char *video_device,
+                     char *video_display,
+                     int video_resolution[]);
+int aras_player_init_block_player(struct aras_player *player, struct aras_configuration *configuration);
+int aras_player_init_time_signal_player(struct aras_player *player, struct aras_configuration *configuration);
+void aras_player_set_volume(struct aras_player *player, int unit, float volume);
+void aras_player_set_volume_increment(struct aras_player *player, int unit, float slope, float limit);
+void aras_player_set_volume_ramp(struct aras_player *player, int unit, float limit, long int time, const float *weights, int points);
+void aras_player_set_uri(struct aras_player *player, int unit, gchar *uri);
+int aras_player_set_next_uri(struct aras_player *player, int unit, gchar *uri);
+void aras_player_set_state_null(struct aras_player *player, int unit);
+void aras_player_set_state_ready(struct aras_player *player, int unit);
+void aras_player_set_state_paused(struct aras_player *player, int unit);
+void aras_player_set_state_playing(struct aras_player *player, int unit);
+void aras_player_set_current_unit(struct aras_player *player, int unit);
+void aras_player_set_callback_wake(struct aras_player *player, void (*callback_wake)(void *data), void *data);
+int aras_player_alloc_unit(struct aras_player *player);
+void aras_player_release_unit(struct aras_player *player, int unit);
+float aras_player_get_volume(struct aras_player *player, int unit);
+void aras_player_get_state(struct aras_player *player, int unit, int *state);
+int aras_player_get_prerolled(struct aras_player *player, int unit);
+int aras_player_get_buffer_percent(struct aras_player *player, int unit);
+int aras_player_get_current_unit(struct aras_player *player);
+int aras_player_get_units(struct aras_player *player);
+int aras_player_get_allocated(struct aras_player *player, int unit);
+long int aras_player_get_duration(struct aras_player *player, int unit);
+long int aras_player_get_position(struct aras_player *player, int unit);
+int aras_player_take_next_started(struct aras_player *player, int unit);
+
+#endif  /* _ARAS_PLAYER_MIXER_H */
@@ -0,0 +1,136 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the simulated player module, which models the player units without playing
+ * any media, following the virtual clock of the time module.
+ */
+
+#ifndef _ARAS_PLAYER_SIM_H
+#define _ARAS_PLAYER_SIM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <aras/configuration.h>
+#include <aras/fade.h>
+
+#define ARAS_PLAYER_MAX_NAME            1024
+#define ARAS_PLAYER_MAX_URI             1024
+
+#define ARAS_PLAYER_MAX_UNITS           8   /* Decks in the pool, see ARAS_CONFIGURATION_MAX_DECKS */
+#define ARAS_PLAYER_UNITS               2   /* Default number of decks */
+#define ARAS_PLAYER_UNIT_NONE           -1
+
+#define ARAS_PLAYER_STATE_ERROR         0
+#define ARAS_PLAYER_STATE_BUFFERING     1
+#define ARAS_PLAYER_STATE_STOP          2
+#define ARAS_PLAYER_STATE_PLAYING       3
+#define ARAS_PLAYER_STATE_OTHER         4
+
+#define ARAS_PLAYER_SIM_TARGET_READY    0
+#define ARAS_PLAYER_SIM_TARGET_PAUSED   1
+#define ARAS_PLAYER_SIM_TARGET_PLAYING  2
+
+/* Media model, derived from a hash of the URI so that runs are reproducible */
+#define ARAS_PLAYER_SIM_DURATION_MIN            120000  /* Block files */
+#define ARAS_PLAYER_SIM_DURATION_MAX            360000
+#define ARAS_PLAYER_SIM_SIGNAL_DURATION_MIN     3000    /* Time signal files */
+#define ARAS_PLAYER_SIM_SIGNAL_DURATION_MAX     6000
+#define ARAS_PLAYER_SIM_LATENCY_MIN             20      /* Preroll latency */
+#define ARAS_PLAYER_SIM_LATENCY_MAX             400
+#define ARAS_PLAYER_SIM_ERROR_RATE              500     /* One file in ERROR_RATE fails, 0 for none */
+
+struct aras_player_deck {
+        int allocated;                      /* Handed out by aras_player_alloc_unit */
+        char uri[ARAS_PLAYER_MAX_URI];
+        char next_uri[ARAS_PLAYER_MAX_URI]; /* Gapless queue, empty if none */
+        int next_started;                   /* Queued URIs started since the last take */
+        int state;                          /* ARAS_PLAYER_STATE_* value */
+        int target;                         /* ARAS_PLAYER_SIM_TARGET_* value */
+        int loads;                          /* Media loaded, varies the latency */
+        long int duration;                  /* Duration in miliseconds */
+        long long int ready_time;           /* Monotonic time at which the media is prerolled */
+        long long int start_time;           /* Monotonic time of the position 0 */
+        float volume;                       /* Volume at the start of the ramp */
+        float limit;                        /* Volume at the end of the ramp */
+        long long int ramp_start;           /* Monotonic start of the ramp */
+        long int ramp_time;                 /* Duration of the ramp, 0 if none */
+        int ramp_points;
+        float ramp_weights[ARAS_FADE_POINTS + 1];
+};
+
+struct aras_player {
+        int current_unit;
+        char name[ARAS_PLAYER_MAX_NAME];
+        int units;                          /* Decks in the pool */
+        long int duration_min;              /* Range of the simulated durations */
+        long int duration_max;
+        char *trace_file;                   /* As-run trace, NULL if none */
+        struct aras_player_deck deck[ARAS_PLAYER_MAX_UNITS];
+        void (*callback_wake)(void *data);
+        void *callback_wake_data;
+};
+
+int aras_player_init(struct aras_player *player,
+                     char *name,
+                     int audio_output,
+                     char *audio_device,
+                     int audio_sample_rate,
+                     int audio_channels,
+                     int video_output,
+                     char *video_device,
+                     char *video_display,
+                     int video_resolution[]);
+int aras_player_init_block_player(struct aras_player *player, struct aras_configuration *configuration);
+int aras_player_init_time_signal_player(struct aras_player *player, struct aras_configuration *configuration);
+void aras_player_set_volume(struct aras_player *player, int unit, float volume);
+void aras_player_set_volume_increment(struct aras_player *player, int unit, float slope, float limit);
+void aras_player_set_volume_ramp(struct aras_player *player, int unit, float limit, long int time, const float *weights, int points);
+void aras_player_set_uri(struct aras_player *player, int unit, gchar *uri);
+int aras_player_set_next_uri(struct aras_player *player, int unit, gchar *uri);
+void aras_player_set_state_null(struct aras_player *player, int unit);
+void aras_player_set_state_ready(struct aras_player *player, int unit);
+void aras_player_set_state_paused(struct aras_player *player, int unit);
+void aras_player_set_state_playing(struct aras_player *player, int unit);
+void aras_player_set_current_unit(struct aras_player *player, int unit);
+void aras_player_set_callback_wake(struct aras_player *player, void (*callback_wake)(void *data), void *data);
+void aras_player_set_trace_file(struct aras_player *player, char *trace_file);
+int aras_player_alloc_unit(struct aras_player *player);
+void aras_player_release_unit(struct aras_player *player, int unit);
+float aras_player_get_volume(struct aras_player *player, int unit);
+void aras_player_get_state(struct aras_player *player, int unit, int *state);
+int aras_player_get_prerolled(struct aras_player *player, int unit);
+int aras_player_get_buffer_percent(struct aras_player *player, int unit);
+int aras_player_get_current_unit(struct aras_player *player);
+int aras_player_get_units(struct aras_player *player);
+int aras_player_get_allocated(struct aras_player *player, int unit);
+long int aras_player_get_duration(struct aras_player *player, int unit);
+long int aras_player_get_position(struct aras_player *player, int unit);
+long int aras_player_get_timeout(struct aras_player *player);
+int aras_player_take_next_started(struct aras_player *player, int unit);
+
+#endif  /* _ARAS_PLAYER_SIM_H */
@@ -33,14 +33,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <glib.h>
 #include <vlc/vlc.h>
 
 #define ARAS_PLAYER_MAX_NAME            1024
 #define ARAS_PLAYER_MAX_URI             1024
 #define ARAS_PLAYER_MAX_DEVICE          1024
 
-#define ARAS_PLAYER_UNIT_A              0
-#define ARAS_PLAYER_UNIT_B              1
+#define ARAS_PLAYER_MAX_UNITS           8   /* Decks in the pool, see ARAS_CONFIGURATION_MAX_DECKS */
+#define ARAS_PLAYER_UNIT_NONE           -1
 
 #define ARAS_PLAYER_STATE_ERROR         0
 #define ARAS_PLAYER_STATE_BUFFERING     1
@@ -48,17 +49,37 @@
 #define ARAS_PLAYER_STATE_PLAYING       3
 #define ARAS_PLAYER_STATE_OTHER         4
 
+#define ARAS_PLAYER_RAMP_PERIOD         10  /* Miliseconds between volume ramp steps */
+
+struct aras_player_ramp {
+        struct aras_player *player;
+        int unit;
+        guint source;                       /* Timeout source, 0 without ramp */
+        gint64 start_time;                  /* Monotonic time of the start */
+        float start;                        /* Volume at the start */
+        float limit;
+        long int time;
+        const float *weights;               /* Progress weights, owned by the caller */
+        int points;
+};
+
+struct aras_player_deck {
+        int allocated;                      /* Handed out by aras_player_alloc_unit */
+        float volume;
+        int buffer_percent;
+        libvlc_media_player_t *player;
+        libvlc_media_t *media;
+        struct aras_player_ramp ramp;
+};
+
 struct aras_player {
         int current_unit;
-        float volume_a;
-        float volume_b;
-        int buffer_percent_a;
-        int buffer_percent_b;
+        int units;                          /* Decks in the pool */
         libvlc_instance_t *instance;
-        libvlc_media_player_t *player_a;
-        libvlc_media_player_t *player_b;
-        libvlc_media_t *media_a;
-        libvlc_media_t *media_b;
+        GMainContext *context;              /* Main context of the wake ups and ramps */
+        struct aras_player_deck deck[ARAS_PLAYER_MAX_UNITS];
+        void (*callback_wake)(void *data);
+        void *callback_wake_data;
 };
 
 int aras_player_init(struct aras_player *player,
@@ -75,18 +96,26 @@ int aras_player_init_block_player(struct aras_player *player, struct aras_config
 int aras_player_init_time_signal_player(struct aras_player *player, struct aras_configuration *configuration);
 void aras_player_set_volume(struct aras_player *player, int unit, float volume);
 void aras_player_set_volume_increment(struct aras_player *player, int unit, float slope, float limit);
+void aras_player_set_volume_ramp(struct aras_player *player, int unit, float limit, long int time, const float *weights, int points);
 void aras_player_set_uri(struct aras_player *player, int unit, char *uri);
+int aras_player_set_next_uri(struct aras_player *player, int unit, char *uri);
 void aras_player_set_state_null(struct aras_player *player, int unit);
 void aras_player_set_state_ready(struct aras_player *player, int unit);
 void aras_player_set_state_paused(struct aras_player *player, int unit);
 void aras_player_set_state_playing(struct aras_player *player, int unit);
 void aras_player_set_current_unit(struct aras_player *player, int unit);
-void aras_player_swap_current_unit(struct aras_player *player);
+void aras_player_set_callback_wake(struct aras_player *player, void (*callback_wake)(void *data), void *data);
+int aras_player_alloc_unit(struct aras_player *player);
+void aras_player_release_unit(struct aras_player *player, int unit);
 float aras_player_get_volume(struct aras_player *player, int unit);
 void aras_player_get_state(struct aras_player *player, int unit, int *state);
+int aras_player_get_prerolled(struct aras_player *player, int unit);
 int aras_player_get_buffer_percent(struct aras_player *player, int unit);
 int aras_player_get_current_unit(struct aras_player *player);
+int aras_player_get_units(struct aras_player *player);
+int aras_player_get_allocated(struct aras_player *player, int unit);
 long int aras_player_get_duration(struct aras_player *player, int unit);
 long int aras_player_get_position(struct aras_player *player, int unit);
+int aras_player_take_next_started(struct aras_player *player, int unit);
 
 #endif  /* _ARAS_PLAYER_VLCLIB_H */
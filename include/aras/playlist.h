@@ -37,6 +37,8 @@
 #define ARAS_PLAYLIST_MAX_RECURSION_DEPTH   16
 
 GList *aras_playlist_free(GList *playlist);
-GList *aras_playlist_load(GList *playlist, char *block_name, struct aras_block *block, int recursion);
+GList *aras_playlist_load_file(GList *playlist, char *data);
+GList *aras_playlist_load_block_node(GList *playlist, struct aras_block_node *block_node, struct aras_block *block, int recursion, GRand *rand);
+GList *aras_playlist_load(GList *playlist, char *block_name, struct aras_block *block, int recursion, GRand *rand);
 
 #endif  /* _ARAS_PLAYLIST_H */
@@ -31,6 +31,7 @@
 #define _ARAS_SCHEDULE_H
 
 #include <glib.h>
+#include <aras/block.h>
 
 #define ARAS_SCHEDULE_MAX_LINE          2048
 #define ARAS_SCHEDULE_MAX_DAY           16
@@ -39,16 +40,21 @@
 
 struct aras_schedule_node {
         long int time;
-        char block_name[ARAS_SCHEDULE_MAX_BLOCK_NAME];
+        const char *block_name;             /* Interned block name */
+        struct aras_block_node *block_node; /* Block node, NULL if unknown */
 };
 
 struct aras_schedule {
-        GList *list;
+        GList *list;                        /* Nodes being loaded */
+        struct aras_schedule_node *array;   /* Nodes sorted by week time */
+        int length;
 };
 
 int aras_schedule_init(struct aras_schedule *schedule);
 int aras_schedule_load_file(struct aras_schedule *schedule, char *file);
 int aras_schedule_list_free(struct aras_schedule *schedule);
+int aras_schedule_copy(struct aras_schedule *schedule, struct aras_schedule *source);
+int aras_schedule_resolve(struct aras_schedule *schedule, struct aras_block *block, char *log_file);
 struct aras_schedule_node *aras_schedule_seek_node_current(struct aras_schedule *schedule, long int time);
 struct aras_schedule_node *aras_schedule_seek_node_next(struct aras_schedule *schedule, long int time);
 void aras_schedule_print(struct aras_schedule *schedule);
@@ -0,0 +1,82 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the snapshot module.
+ */
+
+#ifndef _ARAS_SNAPSHOT_H
+#define _ARAS_SNAPSHOT_H
+
+#include <glib.h>
+#include <aras/configuration.h>
+#include <aras/schedule.h>
+#include <aras/block.h>
+
+#define ARAS_SNAPSHOT_FILES                 3
+#define ARAS_SNAPSHOT_FILE_CONFIGURATION    0
+#define ARAS_SNAPSHOT_FILE_SCHEDULE         1
+#define ARAS_SNAPSHOT_FILE_BLOCK            2
+#define ARAS_SNAPSHOT_FILE_ALL              ((1 << ARAS_SNAPSHOT_FILES) - 1)
+
+#define ARAS_SNAPSHOT_WATCH_BUFFER          4096
+
+struct aras_snapshot {
+        gint ref_count;
+        struct aras_configuration *configuration;
+        struct aras_schedule *schedule;
+        struct aras_block *block;
+};
+
+struct aras_snapshot_reload {
+        char *configuration_file;
+        struct aras_snapshot **snapshot;
+        struct aras_snapshot *retired;
+        GThread *thread;
+        GMainContext *context;              /* Main context running the callbacks */
+        gint64 time;
+        int pending;
+        int loading;
+        char *checksum[ARAS_SNAPSHOT_FILES];
+        int watch_fd;
+        int watch_descriptor[ARAS_SNAPSHOT_FILES];
+        char *watch_name[ARAS_SNAPSHOT_FILES];
+        GIOChannel *watch_channel;
+        guint watch_source;
+        void (*callback_done)(void *data);
+        void *callback_done_data;
+};
+
+struct aras_snapshot *aras_snapshot_new(void);
+int aras_snapshot_load_file(struct aras_snapshot *snapshot, char *configuration_file);
+struct aras_snapshot *aras_snapshot_ref(struct aras_snapshot *snapshot);
+void aras_snapshot_unref(struct aras_snapshot *snapshot);
+struct aras_snapshot *aras_snapshot_get(struct aras_snapshot **snapshot);
+int aras_snapshot_reload_init(struct aras_snapshot_reload *reload, struct aras_snapshot **snapshot, char *configuration_file);
+void aras_snapshot_reload_set_callback_done(struct aras_snapshot_reload *reload, void (*callback_done)(void *data), void *data);
+int aras_snapshot_reload_start(struct aras_snapshot_reload *reload, int files);
+int aras_snapshot_reload_watch(struct aras_snapshot_reload *reload);
+
+#endif  /* _ARAS_SNAPSHOT_H */
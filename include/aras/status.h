@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Header file for the ARAS Radio Automation System. Types and definitions for
+ * the status module. The engines publish their status in a named shared memory
+ * segment, protected by a sequence lock: the writer never waits for readers,
+ * and readers retry while the sequence is odd or changes during their copy.
+ * The layout only uses fixed size types, so that external monitors may map the
+ * segment and read it without linking ARAS.
+ */
+
+#ifndef _ARAS_STATUS_H
+#define _ARAS_STATUS_H
+
+#include <glib.h>
+#include <aras/schedule.h>
+
+#define ARAS_STATUS_VERSION         1
+
+#define ARAS_STATUS_MAX_NAME        256
+#define ARAS_STATUS_MAX_URI         1024
+#define ARAS_STATUS_MAX_DECKS       8
+#define ARAS_STATUS_MAX_RETRIES     1000
+
+struct aras_status_deck {
+        gint32 allocated;                   /* 1 if the deck is playing or fading */
+        gint32 state;                       /* ARAS_PLAYER_STATE_* value */
+        gint64 position;                    /* Position in miliseconds */
+        gint64 duration;                    /* Duration in miliseconds, 0 if unknown */
+        float volume;
+        gint32 buffer_percent;
+};
+
+struct aras_status_player {
+        gint32 engine_state;                /* ARAS_ENGINE_STATE_* value */
+        gint32 current_deck;                /* -1 if none */
+        gint32 decks;
+        char uri_current[ARAS_STATUS_MAX_URI];
+        char uri_next[ARAS_STATUS_MAX_URI];
+        struct aras_status_deck deck[ARAS_STATUS_MAX_DECKS];
+};
+
+struct aras_status_segment {
+        guint32 version;                    /* ARAS_STATUS_VERSION */
+        gint sequence;                      /* Odd while the segment is written */
+        gint64 time;                        /* Real time of the update in microseconds */
+        char block_current[ARAS_STATUS_MAX_NAME];
+        char block_next[ARAS_STATUS_MAX_NAME];
+        struct aras_status_player block_player;
+        struct aras_status_player time_signal_player;
+};
+
+struct aras_status {
+        char name[ARAS_STATUS_MAX_NAME];
+        int owner;                          /* 1 if the segment is published by this process */
+        int fd;                             /* Locked descriptor of a published segment, -1 otherwise */
+        struct aras_status_segment *segment;
+};
+
+int aras_status_open(struct aras_status *status, char *name);
+int aras_status_attach(struct aras_status *status, char *name);
+void aras_status_close(struct aras_status *status);
+void aras_status_set_blocks(struct aras_status_segment *segment, struct aras_schedule *schedule);
+void aras_status_publish(struct aras_status *status, struct aras_status_segment *segment);
+int aras_status_read(struct aras_status *status, struct aras_status_segment *segment);
+
+#endif  /* _ARAS_STATUS_H */
@@ -44,6 +44,12 @@
 #define ARAS_TIME_FRIDAY    5
 #define ARAS_TIME_SATURDAY  6
 
+#define ARAS_TIME_VIRTUAL_MONOTONIC_START   1000000LL   /* Microseconds, 0 means unset */
+
+void aras_time_virtual_init(long long int start);
+void aras_time_virtual_advance(long int time);
+long long int aras_time_real(void);
+long long int aras_time_monotonic(void);
 long int aras_time_current(void);
 long int aras_time_addition(long int time1, long int time0);
 long int aras_time_difference(long int time1, long int time0);
@@ -33,6 +33,7 @@
 #include <strings.h>
 #include <glib.h>
 #include <aras/parse.h>
+#include <aras/configuration.h>
 #include <aras/block.h>
 
 /**
@@ -59,14 +60,72 @@ int aras_block_convert_type(char *type)
 }
 
 /**
- * This function sets the name field in a block structure.
+ * This function receives a fade curve string and returns its numerical value
+ *
+ * @param   curve   Pointer to the fade curve string
+ *
+ * @return  The numerical value for the fade curve, -1 for the global one
+ */
+int aras_block_convert_fade_curve(char *curve)
+{
+        if (!strcasecmp(curve, "exponential"))
+                return ARAS_CONFIGURATION_MODE_FADE_CURVE_EXPONENTIAL;
+        else if (!strcasecmp(curve, "linear"))
+                return ARAS_CONFIGURATION_MODE_FADE_CURVE_LINEAR;
+        else if (!strcasecmp(curve, "equalpower"))
+                return ARAS_CONFIGURATION_MODE_FADE_CURVE_EQUAL_POWER;
+        else if (!strcasecmp(curve, "logarithmic"))
+                return ARAS_CONFIGURATION_MODE_FADE_CURVE_LOGARITHMIC;
+        else if (!strcasecmp(curve, "scurve"))
+                return ARAS_CONFIGURATION_MODE_FADE_CURVE_S_CURVE;
+        else
+                return -1;
+}
+
+/**
+ * This function receives a fade time string and returns its numerical value
+ *
+ * @param   time    Pointer to the fade time string
+ *
+ * @return  The fade time in miliseconds, -1 for the global one
+ */
+int aras_block_convert_fade_time(char *time)
+{
+        char *end;
+        long int value;
+
+        value = strtol(time, &end, 10);
+        if (end == time || *end != '\0' || value < 0)
+                return -1;
+
+        return (int)value;
+}
+
+/**
+ * This function receives a transition string and returns its numerical value
+ *
+ * @param   transition  Pointer to the transition string
+ *
+ * @return  The numerical value for the transition, crossfade by default
+ */
+int aras_block_convert_transition(char *transition)
+{
+        if (!strcasecmp(transition, "gapless"))
+                return ARAS_BLOCK_TRANSITION_GAPLESS;
+        else
+                return ARAS_BLOCK_TRANSITION_CROSSFADE;
+}
+
+/**
+ * This function sets the name field in a block structure. Block names are
+ * interned, so they can be compared and hashed as pointers.
  *
  * @param   block   Pointer to the block structure
  * @param   name    Pointer to the block name string
  */
 void aras_block_node_set_name(struct aras_block_node *node, char *name)
 {
-        snprintf(node->name, sizeof(node->name), "%s", name);
+        node->name = g_intern_string(name);
 }
 
 /**
@@ -88,24 +147,64 @@ void aras_block_node_set_type(struct aras_block_node *node, int type)
  */
 void aras_block_node_set_data(struct aras_block_node *node, char *data)
 {
-        snprintf(node->data, sizeof(node->data), "%s", data);
+        node->data = g_strdup(data);
+}
+
+/**
+ * This function sets the fade fields in a block structure.
+ *
+ * @param   block       Pointer to the block structure
+ * @param   fade_curve  The fade curve, -1 for the global one
+ * @param   fade_time   The fade time in miliseconds, -1 for the global one
+ */
+void aras_block_node_set_fade(struct aras_block_node *node, int fade_curve, int fade_time)
+{
+        node->fade_curve = fade_curve;
+        node->fade_time = fade_time;
+}
+
+/**
+ * This function sets the transition field in a block structure.
+ *
+ * @param   block       Pointer to the block structure
+ * @param   transition  The transition between consecutive files
+ */
+void aras_block_node_set_transition(struct aras_block_node *node, int transition)
+{
+        node->transition = transition;
+}
+
+/**
+ * This function frees a block node.
+ *
+ * @param   node    Pointer to the block node
+ */
+void aras_block_node_free(struct aras_block_node *node)
+{
+        g_free(node->data);
+        g_free(node);
 }
 
 /**
  * This function loads in a block structure the data contained in a set of
  * strings.
  *
- * @param   block   Pointer to the block structure
- * @param   name    Pointer to the block name string
- * @param   type    Pointer to the block type string
- * @param   data    Pointer to the block data string
+ * @param   block       Pointer to the block structure
+ * @param   name        Pointer to the block name string
+ * @param   type        Pointer to the block type string
+ * @param   data        Pointer to the block data string
+ * @param   curve       Pointer to the block fade curve string, empty for global
+ * @param   time        Pointer to the block fade time string, empty for global
+ * @param   transition  Pointer to the block transition string, empty for
+ *                      crossfade
  *
  * @return  0 if success, -1 if error
  */
-int aras_block_load_data(struct aras_block *block, char *name, char *type, char *data)
+int aras_block_load_data(struct aras_block *block, char *name, char *type, char *data, char *curve, char *time, char *transition)
 {
         int node_type;
         struct aras_block_node *node;
+        GQuark quark;
 
         /* Convert type */
         if ((node_type = aras_block_convert_type(type)) == -1)
@@ -119,10 +218,17 @@ int aras_block_load_data(struct aras_block *block, char *name, char *type, char
         aras_block_node_set_name(node, name);
         aras_block_node_set_type(node, node_type);
         aras_block_node_set_data(node, data);
+        aras_block_node_set_fade(node, aras_block_convert_fade_curve(curve), aras_block_convert_fade_time(time));
+        aras_block_node_set_transition(node, aras_block_convert_transition(transition));
 
-        /* Add the node to the schedule list */
+        /* Add the node to the block list */
         block->list = g_list_prepend(block->list, node);
 
+        /* Index the node by name, the first node loaded with a name is used */
+        quark = g_quark_from_static_string(node->name);
+        if (!g_hash_table_contains(block->table, GUINT_TO_POINTER(quark)))
+                g_hash_table_insert(block->table, GUINT_TO_POINTER(quark), node);
+
         return 0;
 }
 
@@ -139,6 +245,9 @@ int aras_block_load_line(struct aras_block *block, char *line)
         char name[ARAS_BLOCK_MAX_NAME];
         char type[ARAS_BLOCK_MAX_TYPE];
         char data[ARAS_BLOCK_MAX_DATA];
+        char curve[ARAS_BLOCK_MAX_FADE];
+        char time[ARAS_BLOCK_MAX_FADE];
+        char transition[ARAS_BLOCK_MAX_FADE];
 
         /* Get name, type and data */
         if ((line = aras_parse_line_configuration(line, name, sizeof(name))) == NULL)
@@ -150,7 +259,15 @@ int aras_block_load_line(struct aras_block *block, char *line)
         if ((line = aras_parse_line_configuration(line, data, sizeof(data))) == NULL)
                 return -1;
 
-        aras_block_load_data(block, name, type, data);
+        /* Get the optional fade curve, fade time and transition */
+        curve[0] = '\0';
+        time[0] = '\0';
+        transition[0] = '\0';
+        line = aras_parse_line_configuration(line, curve, sizeof(curve));
+        line = aras_parse_line_configuration(line, time, sizeof(time));
+        aras_parse_line_configuration(line, transition, sizeof(transition));
+
+        aras_block_load_data(block, name, type, data, curve, time, transition);
 
         return 0;
 }
@@ -194,13 +311,15 @@ int aras_block_init(struct aras_block *block)
 {
         /* Clean structure */
         memset(block, 0, sizeof(*block));
-        /* Block list initialization */
+        /* Block list and block table initialization */
         block->list = NULL;
+        block->table = g_hash_table_new(g_direct_hash, g_direct_equal);
         return 0;
 }
 
 /**
- * This function receives a block structure and frees the block list.
+ * This function receives a block structure and frees the block list and the
+ * block table.
  *
  * @param   block   Pointer to the block structure
  *
@@ -208,8 +327,11 @@ int aras_block_init(struct aras_block *block)
  */
 int aras_block_list_free(struct aras_block *block)
 {
-        g_list_free_full(block->list, g_free);
+        g_list_free_full(block->list, (GDestroyNotify)aras_block_node_free);
         block->list = NULL;
+        if (block->table != NULL)
+                g_hash_table_destroy(block->table);
+        block->table = NULL;
 
         return 0;
 }
@@ -226,20 +348,16 @@ int aras_block_list_free(struct aras_block *block)
  */
 struct aras_block_node *aras_block_seek_node_name(struct aras_block *block, char *name)
 {
-        GList *pointer;
-        struct aras_block_node *node;
+        GQuark quark;
 
-        if (block == NULL)
+        if (block == NULL || block->table == NULL)
                 return NULL;
 
-        pointer = block->list;
-        while (pointer != NULL) {
-                node = pointer->data;
-                if (!strcmp(node->name, name))
-                        return node;
-                pointer = pointer->next;
-        }
-        return NULL;
+        /* Names never interned cannot belong to any block */
+        if ((quark = g_quark_try_string(name)) == 0)
+                return NULL;
+
+        return g_hash_table_lookup(block->table, GUINT_TO_POINTER(quark));
 }
 
 /**
@@ -258,7 +376,7 @@ void aras_block_print(struct aras_block *block)
         pointer = block->list;
         while (pointer != NULL) {
                 node = pointer->data;
-                printf("%s %d %s\n", node->name, node->type, node->data);
+                printf("%s %d %s %d %d %d\n", node->name, node->type, node->data, node->fade_curve, node->fade_time, node->transition);
                 pointer = pointer->next;
         }
         printf("\n");
@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Source file for the ARAS Radio Automation System. Functions for the command
+ * module.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <glib.h>
+#include <aras/time.h>
+#include <aras/command.h>
+
+/**
+ * This function initializes an empty command queue.
+ *
+ * @param   queue   Pointer to the command queue
+ *
+ * @return  This function always returns 0
+ */
+int aras_command_queue_init(struct aras_command_queue *queue)
+{
+        queue->head = 0;
+        queue->tail = 0;
+        queue->callback_wake = NULL;
+        queue->callback_wake_data = NULL;
+        return 0;
+}
+
+/**
+ * This function appends a command to a command queue, timestamped with the
+ * monotonic time. It must only be called by the producer thread. The command
+ * is written before the tail is published, so the consumer never reads a
+ * partial command.
+ *
+ * @param   queue       Pointer to the command queue
+ * @param   type        The type of command, an ARAS_COMMAND_* value
+ * @param   argument    The name of the block for ARAS_COMMAND_PLAY_BLOCK, the
+ *                      URI or file name for ARAS_COMMAND_INSERT_URI, NULL
+ *                      otherwise
+ *
+ * @return  0 if success, -1 if the queue is full
+ */
+int aras_command_queue_push(struct aras_command_queue *queue, int type, char *argument)
+{
+        struct aras_command *command;
+        gint tail;
+        gint next;
+
+        tail = queue->tail;
+        next = (tail + 1) % ARAS_COMMAND_QUEUE_SIZE;
+
+        /* A slot is always kept free to tell a full queue from an empty one */
+        if (next == g_atomic_int_get(&queue->head))
+                return -1;
+
+        command = &queue->commands[tail];
+        command->type = type;
+        command->time = aras_time_monotonic();
+        g_strlcpy(command->argument, argument != NULL ? argument : "", sizeof(command->argument));
+        g_atomic_int_set(&queue->tail, next);
+
+        /* Notify the command to the loop running the consumer */
+        if (queue->callback_wake != NULL)
+                queue->callback_wake(queue->callback_wake_data);
+
+        return 0;
+}
+
+/**
+ * This function removes the first command from a command queue. It must only
+ * be called by the consumer thread.
+ *
+ * @param   queue   Pointer to the command queue
+ * @param   command Pointer to the structure receiving a copy of the command
+ *
+ * @return  0 if success, -1 if the queue is empty
+ */
+int aras_command_queue_pop(struct aras_command_queue *queue, struct aras_command *command)
+{
+        gint head;
+
+        head = queue->head;
+        if (head == g_atomic_int_get(&queue->tail))
+                return -1;
+
+        *command = queue->commands[head];
+        g_atomic_int_set(&queue->head, (head + 1) % ARAS_COMMAND_QUEUE_SIZE);
+
+        return 0;
+}
+
+/**
+ * This function sets the function called by the producer whenever a command
+ * is pushed, so that an event driven consumer runs without waiting for the
+ * next timeout. The function is called in the producer thread.
+ *
+ * @param   queue           Pointer to the command queue
+ * @param   callback_wake   Pointer to the wake up function, NULL to disable it
+ * @param   data            Pointer to the data passed to the wake up function
+ */
+void aras_command_queue_set_callback_wake(struct aras_command_queue *queue, void (*callback_wake)(void *data), void *data)
+{
+        queue->callback_wake = callback_wake;
+        queue->callback_wake_data = data;
+}
@@ -46,6 +46,23 @@ void aras_configuration_set_configuration_period(struct aras_configuration *conf
         configuration->configuration_period = abs(atoi(argument));
 }
 
+/**
+ * This function sets the configuration_mode field in a configuration
+ * structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_configuration_mode(struct aras_configuration *configuration, char *argument)
+{
+        if (!strcasecmp(argument, "poll"))
+                configuration->configuration_mode = ARAS_CONFIGURATION_MODE_CONFIGURATION_POLL;
+        else if (!strcasecmp(argument, "watch"))
+                configuration->configuration_mode = ARAS_CONFIGURATION_MODE_CONFIGURATION_WATCH;
+        else
+                configuration->configuration_mode = ARAS_CONFIGURATION_MODE_CONFIGURATION_POLL;
+}
+
 /**
  * This function sets the schedule_file field in a configuration structure.
  *
@@ -79,6 +96,53 @@ void aras_configuration_set_log_file(struct aras_configuration *configuration, c
         snprintf(configuration->log_file, sizeof(configuration->log_file), "%s", argument);
 }
 
+/**
+ * This function sets the media_index_file field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_media_index_file(struct aras_configuration *configuration, char *argument)
+{
+        snprintf(configuration->media_index_file, sizeof(configuration->media_index_file), "%s", argument);
+}
+
+/**
+ * This function sets the status_segment field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_status_segment(struct aras_configuration *configuration, char *argument)
+{
+        snprintf(configuration->status_segment, sizeof(configuration->status_segment), "%s", argument);
+}
+
+/**
+ * This function sets the status_period field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_status_period(struct aras_configuration *configuration, char *argument)
+{
+        if (atoi(argument) < 1)
+                configuration->status_period = 1;
+        else
+                configuration->status_period = atoi(argument);
+}
+
+/**
+ * This function sets the control_socket field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_control_socket(struct aras_configuration *configuration, char *argument)
+{
+        snprintf(configuration->control_socket, sizeof(configuration->control_socket), "%s", argument);
+}
+
 /**
  * This function sets the schedule_mode field in a configuration structure.
  *
@@ -95,6 +159,20 @@ void aras_configuration_set_schedule_mode(struct aras_configuration *configurati
                 configuration->schedule_mode = ARAS_CONFIGURATION_MODE_SCHEDULE_HARD;
 }
 
+/**
+ * This function sets the prefetch_time field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_prefetch_time(struct aras_configuration *configuration, char *argument)
+{
+        if (atoi(argument) < 0)
+                configuration->prefetch_time = 0;
+        else
+                configuration->prefetch_time = atoi(argument);
+}
+
 /**
  * This function sets the default_block_mode field in a configuration structure.
  *
@@ -152,6 +230,20 @@ void aras_configuration_set_fade_out_slope(struct aras_configuration *configurat
                 configuration->fade_out_slope = atof(argument);
 }
 
+/**
+ * This function sets the preroll_time field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_preroll_time(struct aras_configuration *configuration, char *argument)
+{
+        if (atoi(argument) < 0)
+                configuration->preroll_time = 0;
+        else
+                configuration->preroll_time = atoi(argument);
+}
+
 /**
  * This function sets the engine_period field in a configuration structure.
  *
@@ -166,6 +258,44 @@ void aras_configuration_set_engine_period(struct aras_configuration *configurati
                 configuration->engine_period = atoi(argument);
 }
 
+/**
+ * This function sets the engine_mode field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_engine_mode(struct aras_configuration *configuration, char *argument)
+{
+        if (!strcasecmp(argument, "periodic"))
+                configuration->engine_mode = ARAS_CONFIGURATION_MODE_ENGINE_PERIODIC;
+        else if (!strcasecmp(argument, "event"))
+                configuration->engine_mode = ARAS_CONFIGURATION_MODE_ENGINE_EVENT;
+        else
+                configuration->engine_mode = ARAS_CONFIGURATION_MODE_ENGINE_PERIODIC;
+}
+
+/**
+ * This function sets the fade_curve field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_fade_curve(struct aras_configuration *configuration, char *argument)
+{
+        if (!strcasecmp(argument, "exponential"))
+                configuration->fade_curve = ARAS_CONFIGURATION_MODE_FADE_CURVE_EXPONENTIAL;
+        else if (!strcasecmp(argument, "linear"))
+                configuration->fade_curve = ARAS_CONFIGURATION_MODE_FADE_CURVE_LINEAR;
+        else if (!strcasecmp(argument, "equalpower"))
+                configuration->fade_curve = ARAS_CONFIGURATION_MODE_FADE_CURVE_EQUAL_POWER;
+        else if (!strcasecmp(argument, "logarithmic"))
+                configuration->fade_curve = ARAS_CONFIGURATION_MODE_FADE_CURVE_LOGARITHMIC;
+        else if (!strcasecmp(argument, "scurve"))
+                configuration->fade_curve = ARAS_CONFIGURATION_MODE_FADE_CURVE_S_CURVE;
+        else
+                configuration->fade_curve = ARAS_CONFIGURATION_MODE_FADE_CURVE_EXPONENTIAL;
+}
+
 /**
  * This function sets the time_signal_mode field in a configuration structure.
  *
@@ -210,6 +340,18 @@ void aras_configuration_set_time_signal_block(struct aras_configuration *configu
         snprintf(configuration->time_signal_block, sizeof(configuration->time_signal_block), "%s", argument);
 }
 
+/**
+ * This function sets the random_seed field in a configuration structure. A
+ * seed equal to 0 means a different seed for each run.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_random_seed(struct aras_configuration *configuration, char *argument)
+{
+        configuration->random_seed = (unsigned int)strtoul(argument, NULL, 10);
+}
+
 /**
  * This function sets the block_player_name field in a configuration structure.
  *
@@ -285,6 +427,8 @@ void aras_configuration_set_block_player_video_output(struct aras_configuration
                 configuration->block_player_video_output = ARAS_CONFIGURATION_MODE_VIDEO_GL;
         else if (!strcasecmp(argument, "file"))
                 configuration->block_player_video_output = ARAS_CONFIGURATION_MODE_VIDEO_FILE;
+        else if (!strcasecmp(argument, "none"))
+                configuration->block_player_video_output = ARAS_CONFIGURATION_MODE_VIDEO_NONE;
         else
                 configuration->block_player_video_output = ARAS_CONFIGURATION_MODE_VIDEO_AUTO;
 }
@@ -360,6 +504,39 @@ void aras_configuration_set_block_player_channels(struct aras_configuration *con
                 configuration->block_player_channels = atoi(argument);
 }
 
+/**
+ * This function sets the block_player_decks field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_block_player_decks(struct aras_configuration *configuration, char *argument)
+{
+        if (atoi(argument) < ARAS_CONFIGURATION_MIN_DECKS)
+                configuration->block_player_decks = ARAS_CONFIGURATION_MIN_DECKS;
+        else if (atoi(argument) > ARAS_CONFIGURATION_MAX_DECKS)
+                configuration->block_player_decks = ARAS_CONFIGURATION_MAX_DECKS;
+        else
+                configuration->block_player_decks = atoi(argument);
+}
+
+/**
+ * This function sets the block_player_resample_quality field in a configuration
+ * structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_block_player_resample_quality(struct aras_configuration *configuration, char *argument)
+{
+        if (atoi(argument) < 0)
+                configuration->block_player_resample_quality = 0;
+        else if (atoi(argument) > 10)
+                configuration->block_player_resample_quality = 10;
+        else
+                configuration->block_player_resample_quality = atoi(argument);
+}
+
 /**
  * This function sets the block_player_display_resolution field in a
  * configuration structure.
@@ -453,6 +630,8 @@ void aras_configuration_set_time_signal_player_video_output(struct aras_configur
                 configuration->time_signal_player_video_output = ARAS_CONFIGURATION_MODE_VIDEO_GL;
         else if (!strcasecmp(argument, "file"))
                 configuration->time_signal_player_video_output = ARAS_CONFIGURATION_MODE_VIDEO_FILE;
+        else if (!strcasecmp(argument, "none"))
+                configuration->time_signal_player_video_output = ARAS_CONFIGURATION_MODE_VIDEO_NONE;
         else
                 configuration->time_signal_player_video_output = ARAS_CONFIGURATION_MODE_AUDIO_AUTO;
 }
@@ -528,6 +707,39 @@ void aras_configuration_set_time_signal_player_channels(struct aras_configuratio
                 configuration->time_signal_player_channels = atoi(argument);
 }
 
+/**
+ * This function sets the time_signal_player_decks field in a configuration structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_time_signal_player_decks(struct aras_configuration *configuration, char *argument)
+{
+        if (atoi(argument) < ARAS_CONFIGURATION_MIN_DECKS)
+                configuration->time_signal_player_decks = ARAS_CONFIGURATION_MIN_DECKS;
+        else if (atoi(argument) > ARAS_CONFIGURATION_MAX_DECKS)
+                configuration->time_signal_player_decks = ARAS_CONFIGURATION_MAX_DECKS;
+        else
+                configuration->time_signal_player_decks = atoi(argument);
+}
+
+/**
+ * This function sets the time_signal_player_resample_quality field in a configuration
+ * structure.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ * @param   argument        Pointer to the configuration argument string
+ */
+void aras_configuration_set_time_signal_player_resample_quality(struct aras_configuration *configuration, char *argument)
+{
+        if (atoi(argument) < 0)
+                configuration->time_signal_player_resample_quality = 0;
+        else if (atoi(argument) > 10)
+                configuration->time_signal_player_resample_quality = 10;
+        else
+                configuration->time_signal_player_resample_quality = atoi(argument);
+}
+
 /**
  * This function sets the time_signal_player_display_resolution field in a
  * configuration structure.
@@ -666,16 +878,30 @@ int aras_configuration_load_data(struct aras_configuration *configuration, char
 {
         if (!strcasecmp(directive, "ConfigurationPeriod"))
                 aras_configuration_set_configuration_period(configuration, argument);
+        else if (!strcasecmp(directive, "ConfigurationMode"))
+                aras_configuration_set_configuration_mode(configuration, argument);
         else if (!strcasecmp(directive, "ScheduleFile"))
                 aras_configuration_set_schedule_file(configuration, argument);
         else if (!strcasecmp(directive, "BlockFile"))
                 aras_configuration_set_block_file(configuration, argument);
         else if (!strcasecmp(directive, "LogFile"))
                 aras_configuration_set_log_file(configuration, argument);
+        else if (!strcasecmp(directive, "MediaIndexFile"))
+                aras_configuration_set_media_index_file(configuration, argument);
+        else if (!strcasecmp(directive, "StatusSegment"))
+                aras_configuration_set_status_segment(configuration, argument);
+        else if (!strcasecmp(directive, "StatusPeriod"))
+                aras_configuration_set_status_period(configuration, argument);
+        else if (!strcasecmp(directive, "ControlSocket"))
+                aras_configuration_set_control_socket(configuration, argument);
         else if (!strcasecmp(directive, "EnginePeriod"))
                 aras_configuration_set_engine_period(configuration, argument);
+        else if (!strcasecmp(directive, "EngineMode"))
+                aras_configuration_set_engine_mode(configuration, argument);
         else if (!strcasecmp(directive, "ScheduleMode"))
                 aras_configuration_set_schedule_mode(configuration, argument);
+        else if (!strcasecmp(directive, "PrefetchTime"))
+                aras_configuration_set_prefetch_time(configuration, argument);
         else if (!strcasecmp(directive, "DefaultBlockMode"))
                 aras_configuration_set_default_block_mode(configuration, argument);
         else if (!strcasecmp(directive, "DefaultBlock"))
@@ -684,14 +910,22 @@ int aras_configuration_load_data(struct aras_configuration *configuration, char
                 aras_configuration_set_fade_out_time(configuration, argument);
         else if (!strcasecmp(directive, "FadeOutSlope"))
                 aras_configuration_set_fade_out_slope(configuration, argument);
+        else if (!strcasecmp(directive, "FadeCurve"))
+                aras_configuration_set_fade_curve(configuration, argument);
+        else if (!strcasecmp(directive, "PrerollTime"))
+                aras_configuration_set_preroll_time(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalMode"))
                 aras_configuration_set_time_signal_mode(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalAdvance"))
                 aras_configuration_set_time_signal_advance(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalBlock"))
                 aras_configuration_set_time_signal_block(configuration, argument);
+        else if (!strcasecmp(directive, "RandomSeed"))
+                aras_configuration_set_random_seed(configuration, argument);
         else if (!strcasecmp(directive, "BlockPlayerName"))
                 aras_configuration_set_block_player_name(configuration, argument);
+        else if (!strcasecmp(directive, "BlockPlayerDecks"))
+                aras_configuration_set_block_player_decks(configuration, argument);
         else if (!strcasecmp(directive, "BlockPlayerAudioOutput"))
                 aras_configuration_set_block_player_audio_output(configuration, argument);
         else if (!strcasecmp(directive, "BlockPlayerAudioDevice"))
@@ -702,6 +936,8 @@ int aras_configuration_load_data(struct aras_configuration *configuration, char
                 aras_configuration_set_block_player_sample_rate(configuration, argument);
         else if (!strcasecmp(directive, "BlockPlayerChannels"))
                 aras_configuration_set_block_player_channels(configuration, argument);
+        else if (!strcasecmp(directive, "BlockPlayerResampleQuality"))
+                aras_configuration_set_block_player_resample_quality(configuration, argument);
         else if (!strcasecmp(directive, "BlockPlayerVideoOutput"))
                 aras_configuration_set_block_player_video_output(configuration, argument);
         else if (!strcasecmp(directive, "BlockPlayerVideoDevice"))
@@ -712,6 +948,8 @@ int aras_configuration_load_data(struct aras_configuration *configuration, char
                 aras_configuration_set_block_player_display_resolution(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalPlayerName"))
                 aras_configuration_set_time_signal_player_name(configuration, argument);
+        else if (!strcasecmp(directive, "TimeSignalPlayerDecks"))
+                aras_configuration_set_time_signal_player_decks(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalPlayerAudioOutput"))
                 aras_configuration_set_time_signal_player_audio_output(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalPlayerAudioDevice"))
@@ -722,6 +960,8 @@ int aras_configuration_load_data(struct aras_configuration *configuration, char
                 aras_configuration_set_time_signal_player_sample_rate(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalPlayerChannels"))
                 aras_configuration_set_time_signal_player_channels(configuration, argument);
+        else if (!strcasecmp(directive, "TimeSignalPlayerResampleQuality"))
+                aras_configuration_set_time_signal_player_resample_quality(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalPlayerVideoOutput"))
                 aras_configuration_set_time_signal_player_video_output(configuration, argument);
         else if (!strcasecmp(directive, "TimeSignalPlayerVideoDevice"))
@@ -819,30 +1059,42 @@ int aras_configuration_init(struct aras_configuration *configuration)
 
         /* Configuration period */
         aras_configuration_set_configuration_period(configuration, "10000");
+        aras_configuration_set_configuration_mode(configuration, "poll");
 
         /* Files */
         aras_configuration_set_schedule_file(configuration, "/etc/aras/aras.schedule");
         aras_configuration_set_block_file(configuration, "/etc/aras/aras.block");
         aras_configuration_set_log_file(configuration, "/var/log/aras/aras.log");
+        aras_configuration_set_media_index_file(configuration, "");
+        aras_configuration_set_status_segment(configuration, "");
+        aras_configuration_set_status_period(configuration, "100");
+        aras_configuration_set_control_socket(configuration, "");
 
         /* Engine configuration */
         aras_configuration_set_engine_period(configuration, "100");
+        aras_configuration_set_engine_mode(configuration, "periodic");
         aras_configuration_set_schedule_mode(configuration, "hard");
+        aras_configuration_set_prefetch_time(configuration, "10000");
         aras_configuration_set_default_block_mode(configuration, "on");
         aras_configuration_set_default_block(configuration, "default");
         aras_configuration_set_fade_out_time(configuration, "2000");
         aras_configuration_set_fade_out_slope(configuration, "0.1");
+        aras_configuration_set_fade_curve(configuration, "exponential");
+        aras_configuration_set_preroll_time(configuration, "5000");
         aras_configuration_set_time_signal_mode(configuration, "off");
         aras_configuration_set_time_signal_advance(configuration, "4000");
         aras_configuration_set_time_signal_block(configuration, "time_signal");
+        aras_configuration_set_random_seed(configuration, "0");
 
         /* Block player configuration */
         aras_configuration_set_block_player_name(configuration, "block_player");
+        aras_configuration_set_block_player_decks(configuration, "3");
         aras_configuration_set_block_player_audio_output(configuration, "auto");
         aras_configuration_set_block_player_audio_device(configuration, "default");
         aras_configuration_set_block_player_volume(configuration, "1.0");
         aras_configuration_set_block_player_sample_rate(configuration, "48000");
         aras_configuration_set_block_player_channels(configuration, "2");
+        aras_configuration_set_block_player_resample_quality(configuration, "4");
         aras_configuration_set_block_player_video_output(configuration, "auto");
         aras_configuration_set_block_player_video_device(configuration, "default");
         aras_configuration_set_block_player_video_display(configuration, ":0");
@@ -850,11 +1102,13 @@ int aras_configuration_init(struct aras_configuration *configuration)
 
         /* Time signal player configuration */
         aras_configuration_set_time_signal_player_name(configuration, "time_signal_player");
+        aras_configuration_set_time_signal_player_decks(configuration, "2");
         aras_configuration_set_time_signal_player_audio_output(configuration, "auto");
         aras_configuration_set_time_signal_player_audio_device(configuration, "default");
         aras_configuration_set_time_signal_player_volume(configuration, "1.0");
         aras_configuration_set_time_signal_player_sample_rate(configuration, "48000");
         aras_configuration_set_time_signal_player_channels(configuration, "2");
+        aras_configuration_set_time_signal_player_resample_quality(configuration, "4");
         aras_configuration_set_time_signal_player_video_output(configuration, "auto");
         aras_configuration_set_time_signal_player_video_device(configuration, "default");
         aras_configuration_set_time_signal_player_video_display(configuration, ":0");
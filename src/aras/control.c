@@ -0,0 +1,495 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Source file for the ARAS Radio Automation System. Functions for the control
+ * module.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <glib.h>
+#include <aras/time.h>
+#include <aras/command.h>
+#include <aras/control.h>
+
+/**
+ * This function adds a watch on a socket to the main context of the server.
+ *
+ * @param   control     Pointer to the control structure
+ * @param   channel     Pointer to the channel of the socket
+ * @param   condition   The condition to watch
+ * @param   function    The function to call
+ * @param   data        Pointer to the data passed to the function
+ *
+ * @return  The identifier of the watch
+ */
+guint aras_control_watch(struct aras_control *control, GIOChannel *channel, GIOCondition condition, GIOFunc function, gpointer data)
+{
+        GSource *source;
+        guint id;
+
+        source = g_io_create_watch(channel, condition);
+        g_source_set_callback(source, (GSourceFunc)function, data, NULL);
+        id = g_source_attach(source, control->context);
+        g_source_unref(source);
+
+        return id;
+}
+
+/**
+ * This function removes a source from the main context of the server.
+ *
+ * @param   control Pointer to the control structure
+ * @param   id      The identifier of the source, 0 if none
+ */
+void aras_control_source_remove(struct aras_control *control, guint id)
+{
+        GSource *source;
+
+        if (id != 0 && (source = g_main_context_find_source_by_id(control->context, id)) != NULL)
+                g_source_destroy(source);
+}
+
+/**
+ * This function closes the connection with a client and frees it.
+ *
+ * @param   client  Pointer to the client structure
+ */
+void aras_control_client_free(struct aras_control_client *client)
+{
+        struct aras_control *control;
+
+        control = client->control;
+        aras_control_source_remove(control, client->source_in);
+        aras_control_source_remove(control, client->source_out);
+        g_io_channel_unref(client->channel);
+        close(client->fd);
+        g_string_free(client->input, TRUE);
+        g_string_free(client->output, TRUE);
+        control->clients = g_list_remove(control->clients, client);
+        g_free(client);
+}
+
+/**
+ * This function appends a line to the output of a client. A client whose
+ * pending output exceeds ARAS_CONTROL_MAX_BUFFER is too slow and it is dropped
+ * at the next flush, instead of making the server wait for it.
+ *
+ * @param   client  Pointer to the client structure
+ * @param   line    The line, ending with a new line character
+ */
+void aras_control_client_write(struct aras_control_client *client, char *line)
+{
+        if (client->closed)
+                return;
+
+        if (client->output->len + strlen(line) > ARAS_CONTROL_MAX_BUFFER) {
+                client->closed = 1;
+                return;
+        }
+
+        g_string_append(client->output, line);
+}
+
+gboolean aras_control_callback_writable(GIOChannel *channel, GIOCondition condition, gpointer data);
+
+/**
+ * This function writes the pending output of a client without blocking. What
+ * the socket does not take is written when it becomes writable.
+ *
+ * @param   client  Pointer to the client structure
+ *
+ * @return  0 if success, -1 if the client has been dropped and freed
+ */
+int aras_control_client_flush(struct aras_control_client *client)
+{
+        ssize_t written;
+
+        while (!client->closed && client->output->len > 0) {
+                written = send(client->fd, client->output->str, client->output->len, MSG_DONTWAIT | MSG_NOSIGNAL);
+                if (written > 0) {
+                        g_string_erase(client->output, 0, written);
+                } else if (written == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                        if (client->source_out == 0)
+                                client->source_out = aras_control_watch(client->control, client->channel, G_IO_OUT, aras_control_callback_writable, client);
+                        return 0;
+                } else if (written == -1 && errno == EINTR) {
+                        continue;
+                } else {
+                        client->closed = 1;
+                }
+        }
+
+        if (client->closed) {
+                aras_control_client_free(client);
+                return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * This function is the callback function for a client socket becoming
+ * writable. It writes the pending output of the client.
+ *
+ * @param   channel     Pointer to the channel of the socket
+ * @param   condition   The condition of the socket
+ * @param   data        Pointer to the client structure
+ *
+ * @return  This function always returns FALSE, the flush watches the socket
+ *          again if needed
+ */
+gboolean aras_control_callback_writable(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+        struct aras_control_client *client;
+
+        client = (struct aras_control_client*)data;
+        client->source_out = 0;
+        aras_control_client_flush(client);
+
+        return FALSE;
+}
+
+/**
+ * This function is the callback function for the flush of a batch. It writes
+ * the events reported since the last flush to every client, once the engines
+ * have finished their cycle.
+ *
+ * @param   data    Pointer to the control structure
+ *
+ * @return  This function always returns FALSE
+ */
+gboolean aras_control_callback_flush(gpointer data)
+{
+        struct aras_control *control;
+        struct aras_control_client *client;
+        GList *node;
+        GList *next;
+
+        control = (struct aras_control*)data;
+        control->source_flush = 0;
+
+        for (node = control->clients; node != NULL; node = next) {
+                next = node->next;
+                client = (struct aras_control_client*)node->data;
+                /* Clients waiting for the socket are written when it is writable */
+                if (client->source_out == 0 || client->closed)
+                        aras_control_client_flush(client);
+        }
+
+        return FALSE;
+}
+
+/**
+ * This function reports an event to the subscribed clients. Events are
+ * batched and written when the main context is idle.
+ *
+ * @param   control     Pointer to the control structure
+ * @param   source      The name of the engine reporting the event
+ * @param   type        The type of event
+ * @param   argument    The argument of the event
+ */
+void aras_control_event(struct aras_control *control, char *source, char *type, char *argument)
+{
+        char line[ARAS_CONTROL_MAX_LINE];
+        struct aras_control_client *client;
+        GList *node;
+        GSource *idle;
+        int subscribers;
+
+        if (control->fd == -1)
+                return;
+
+        snprintf(line, sizeof(line), "event %lld %s %s %s\n", aras_time_real() / 1000, source, type, argument);
+
+        subscribers = 0;
+        for (node = control->clients; node != NULL; node = node->next) {
+                client = (struct aras_control_client*)node->data;
+                if (client->subscribed) {
+                        aras_control_client_write(client, line);
+                        subscribers++;
+                }
+        }
+
+        /* Flush the batch once the engines are done */
+        if (subscribers > 0 && control->source_flush == 0) {
+                idle = g_idle_source_new();
+                g_source_set_priority(idle, G_PRIORITY_DEFAULT_IDLE);
+                g_source_set_callback(idle, aras_control_callback_flush, control, NULL);
+                control->source_flush = g_source_attach(idle, control->context);
+                g_source_unref(idle);
+        }
+}
+
+/**
+ * This function runs a command line received from a client and writes the
+ * reply, "ok" or "error" followed by a message.
+ *
+ * @param   client  Pointer to the client structure
+ * @param   line    The command line, without the new line character
+ */
+void aras_control_client_command(struct aras_control_client *client, char *line)
+{
+        struct aras_control *control;
+        char *command;
+        char *argument;
+        int type;
+
+        control = client->control;
+
+        /* Split the command and its argument */
+        command = g_strstrip(line);
+        if (command[0] == '\0')
+                return;
+        if ((argument = strchr(command, ' ')) != NULL) {
+                *argument = '\0';
+                argument = g_strchug(argument + 1);
+        } else {
+                argument = "";
+        }
+
+        /* Commands for the server */
+        if (!strcasecmp(command, "subscribe")) {
+                client->subscribed = 1;
+                aras_control_client_write(client, "ok\n");
+                return;
+        } else if (!strcasecmp(command, "unsubscribe")) {
+                client->subscribed = 0;
+                aras_control_client_write(client, "ok\n");
+                return;
+        } else if (!strcasecmp(command, "reload")) {
+                if (control->callback_reload != NULL)
+                        control->callback_reload(control->callback_reload_data);
+                aras_control_client_write(client, "ok\n");
+                return;
+        }
+
+        /* Commands for the engine */
+        if (!strcasecmp(command, "skip"))
+                type = ARAS_COMMAND_PLAY_NEXT;
+        else if (!strcasecmp(command, "previous"))
+                type = ARAS_COMMAND_PLAY_PREVIOUS;
+        else if (!strcasecmp(command, "repeat"))
+                type = ARAS_COMMAND_PLAY_CURRENT;
+        else if (!strcasecmp(command, "eject"))
+                type = ARAS_COMMAND_PLAY_DEFAULT;
+        else if (!strcasecmp(command, "block"))
+                type = ARAS_COMMAND_PLAY_BLOCK;
+        else if (!strcasecmp(command, "insert"))
+                type = ARAS_COMMAND_INSERT_URI;
+        else if (!strcasecmp(command, "fadeout"))
+                type = ARAS_COMMAND_FADE_OUT;
+        else {
+                aras_control_client_write(client, "error unknown command\n");
+                return;
+        }
+
+        if ((type == ARAS_COMMAND_PLAY_BLOCK || type == ARAS_COMMAND_INSERT_URI) && argument[0] == '\0') {
+                aras_control_client_write(client, "error missing argument\n");
+                return;
+        }
+
+        if (aras_command_queue_push(control->command_queue, type, argument) == -1)
+                aras_control_client_write(client, "error command queue full\n");
+        else
+                aras_control_client_write(client, "ok\n");
+}
+
+/**
+ * This function is the callback function for a client socket. It reads the
+ * available data without blocking and runs the complete command lines.
+ *
+ * @param   channel     Pointer to the channel of the socket
+ * @param   condition   The condition of the socket
+ * @param   data        Pointer to the client structure
+ *
+ * @return  TRUE to keep watching the socket, FALSE if the client is dropped
+ */
+gboolean aras_control_callback_client(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+        struct aras_control_client *client;
+        char buffer[ARAS_CONTROL_MAX_LINE];
+        char *end;
+        ssize_t length;
+
+        client = (struct aras_control_client*)data;
+
+        length = recv(client->fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (length == -1 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                return TRUE;
+
+        /* Connection closed by the client */
+        if (length <= 0) {
+                aras_control_client_free(client);
+                return FALSE;
+        }
+
+        /* Run the complete lines */
+        g_string_append_len(client->input, buffer, length);
+        while ((end = memchr(client->input->str, '\n', client->input->len)) != NULL) {
+                *end = '\0';
+                aras_control_client_command(client, client->input->str);
+                g_string_erase(client->input, 0, end - client->input->str + 1);
+        }
+
+        /* A line longer than a command is not a client of ours */
+        if (client->input->len >= ARAS_CONTROL_MAX_LINE)
+                client->closed = 1;
+
+        /* Reply now, the flush frees a dropped client */
+        if (aras_control_client_flush(client) == -1)
+                return FALSE;
+
+        return TRUE;
+}
+
+/**
+ * This function is the callback function for the listening socket. It accepts
+ * the pending connections.
+ *
+ * @param   channel     Pointer to the channel of the socket
+ * @param   condition   The condition of the socket
+ * @param   data        Pointer to the control structure
+ *
+ * @return  This function always returns TRUE
+ */
+gboolean aras_control_callback_accept(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+        struct aras_control *control;
+        struct aras_control_client *client;
+        int fd;
+
+        control = (struct aras_control*)data;
+
+        while ((fd = accept(control->fd, NULL, NULL)) != -1) {
+                if (g_list_length(control->clients) >= ARAS_CONTROL_MAX_CLIENTS) {
+                        close(fd);
+                        continue;
+                }
+
+                client = g_new0(struct aras_control_client, 1);
+                client->control = control;
+                client->fd = fd;
+                client->channel = g_io_channel_unix_new(fd);
+                client->input = g_string_new(NULL);
+                client->output = g_string_new(NULL);
+                client->source_in = aras_control_watch(control, client->channel, G_IO_IN | G_IO_HUP | G_IO_ERR, aras_control_callback_client, client);
+                control->clients = g_list_append(control->clients, client);
+        }
+
+        return TRUE;
+}
+
+/**
+ * This function initializes a control structure and starts listening on a
+ * Unix domain socket. The server runs in the thread default main context,
+ * which must be the one of the engines it controls.
+ *
+ * @param   control         Pointer to the control structure
+ * @param   path            The path of the socket
+ * @param   command_queue   Pointer to the command queue of the engine, the
+ *                          server is its only producer
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_control_init(struct aras_control *control, char *path, struct aras_command_queue *command_queue)
+{
+        struct sockaddr_un address;
+        struct stat st;
+        int fd;
+        int result;
+
+        control->fd = -1;
+        control->channel = NULL;
+        control->source = 0;
+        control->source_flush = 0;
+        control->clients = NULL;
+        control->command_queue = command_queue;
+        control->callback_reload = NULL;
+        control->callback_reload_data = NULL;
+        control->context = g_main_context_ref_thread_default();
+
+        if (strlen(path) >= sizeof(address.sun_path))
+                return -1;
+        g_strlcpy(control->path, path, sizeof(control->path));
+
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        g_strlcpy(address.sun_path, path, sizeof(address.sun_path));
+
+        /* A socket left over by a previous run is replaced, a live one is not */
+        if (lstat(path, &st) == 0 && S_ISSOCK(st.st_mode)) {
+                if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+                        return -1;
+                result = connect(fd, (struct sockaddr*)&address, sizeof(address));
+                if (result == -1 && errno == ECONNREFUSED) {
+                        unlink(path);
+                } else {
+                        if (result == 0)
+                                fprintf(stderr, "aras: control socket ""%s"" already in use\n", path);
+                        close(fd);
+                        return -1;
+                }
+                close(fd);
+        }
+
+        if ((control->fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1)
+                return -1;
+
+        if (bind(control->fd, (struct sockaddr*)&address, sizeof(address)) == -1 ||
+            listen(control->fd, ARAS_CONTROL_BACKLOG) == -1 ||
+            fcntl(control->fd, F_SETFL, O_NONBLOCK) == -1) {
+                close(control->fd);
+                control->fd = -1;
+                return -1;
+        }
+
+        control->channel = g_io_channel_unix_new(control->fd);
+        control->source = aras_control_watch(control, control->channel, G_IO_IN, aras_control_callback_accept, control);
+
+        return 0;
+}
+
+/**
+ * This function sets the function called by the reload command.
+ *
+ * @param   control         Pointer to the control structure
+ * @param   callback_reload Pointer to the reload function, NULL to disable it
+ * @param   data            Pointer to the data passed to the reload function
+ */
+void aras_control_set_callback_reload(struct aras_control *control, void (*callback_reload)(void *data), void *data)
+{
+        control->callback_reload = callback_reload;
+        control->callback_reload_data = data;
+}
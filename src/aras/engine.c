@@ -39,10 +39,15 @@
 #include <aras/configuration.h>
 #include <aras/schedule.h>
 #include <aras/block.h>
+#include <aras/fade.h>
 #if (ARAS_CONFIG_MEDIA_LIBRARY == ARAS_CONFIG_MEDIA_LIBRARY_GST)
 #include <aras/player.h>
 #elif (ARAS_CONFIG_MEDIA_LIBRARY == ARAS_CONFIG_MEDIA_LIBRARY_VLC)
 #include <aras/player_vlc.h>
+#elif (ARAS_CONFIG_MEDIA_LIBRARY == ARAS_CONFIG_MEDIA_LIBRARY_GST_MIXER)
+#include <aras/player_mixer.h>
+#elif (ARAS_CONFIG_MEDIA_LIBRARY == ARAS_CONFIG_MEDIA_LIBRARY_SIM)
+#include <aras/player_sim.h>
 #endif
 #include <aras/engine.h>
 
@@ -56,14 +61,115 @@
 int aras_engine_init(struct aras_engine *engine)
 {
         engine->state = ARAS_ENGINE_STATE_NULL;
-        engine->state_time_elapsed = 0;
+        engine->state_time_start = 0;
         engine->state_time_maximum = 0;
         engine->playlist = NULL;
         engine->playlist_current_node = NULL;
         engine->pending_playlist = 0;
+        engine->trigger_time = -1;
+        engine->hold_default_block = 0;
+        engine->rand = g_rand_new();
+        engine->prefetch = NULL;
+        engine->preroll_uri = NULL;
+        engine->preroll_unit = ARAS_PLAYER_UNIT_NONE;
+        engine->preroll_ready_time = 0;
+        engine->block_fade_curve = -1;
+        engine->block_fade_time = -1;
+        engine->block_transition = ARAS_BLOCK_TRANSITION_CROSSFADE;
+        engine->gapless_uri = NULL;
+        engine->command_queue = NULL;
+        engine->command_time = 0;
+        engine->event_uri = NULL;
+        engine->callback_wake = NULL;
+        engine->callback_wake_data = NULL;
+        engine->callback_event = NULL;
+        engine->callback_event_data = NULL;
         return 0;
 }
 
+/**
+ * This function sets the seed of the pseudorandom number generator used by an
+ * engine to shuffle random blocks.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   seed    The seed, 0 keeps the seed taken from the system at init
+ */
+void aras_engine_set_random_seed(struct aras_engine *engine, unsigned int seed)
+{
+        if (engine == NULL || seed == 0)
+                return;
+
+        g_rand_set_seed(engine->rand, seed);
+}
+
+/**
+ * This function returns the name of an engine state, as reported in events.
+ *
+ * @param   state   The state
+ *
+ * @return  The name of the state
+ */
+char *aras_engine_state_name(int state)
+{
+        switch (state) {
+        case ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD:
+                return "monitor_schedule_hard";
+        case ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT:
+                return "monitor_schedule_soft";
+        case ARAS_ENGINE_STATE_MONITOR_TIME_SIGNAL:
+                return "monitor_time_signal";
+        case ARAS_ENGINE_STATE_PLAY_DEFAULT:
+                return "play_default";
+        case ARAS_ENGINE_STATE_PLAY_PREVIOUS:
+                return "play_previous";
+        case ARAS_ENGINE_STATE_PLAY_NEXT:
+                return "play_next";
+        case ARAS_ENGINE_STATE_PLAY_CURRENT:
+                return "play_current";
+        case ARAS_ENGINE_STATE_CROSSFADE:
+                return "crossfade";
+        case ARAS_ENGINE_STATE_FADE_OUT:
+                return "fade_out";
+        default:
+                return "null";
+        }
+}
+
+/**
+ * This function reports an event to the function set with
+ * aras_engine_set_callback_event, if any.
+ *
+ * @param   engine      Pointer to the engine structure
+ * @param   type        The type of event: state, start, stop or error
+ * @param   argument    The state name, the URI or the error message
+ */
+void aras_engine_event(struct aras_engine *engine, char *type, char *argument)
+{
+        if (engine->callback_event != NULL)
+                engine->callback_event(engine->callback_event_data, type, argument);
+}
+
+/**
+ * This function reports the start of a URI, and the stop of the URI on air
+ * before it.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   uri     The URI started, NULL if none
+ */
+void aras_engine_event_uri(struct aras_engine *engine, char *uri)
+{
+        if (engine->event_uri != NULL) {
+                aras_engine_event(engine, "stop", engine->event_uri);
+                g_free(engine->event_uri);
+                engine->event_uri = NULL;
+        }
+
+        if (uri != NULL) {
+                engine->event_uri = g_strdup(uri);
+                aras_engine_event(engine, "start", uri);
+        }
+}
+
 /**
  * This function sets the state and its attribute state_time_maximum.
  *
@@ -78,11 +184,59 @@ void aras_engine_set_state(struct aras_engine *engine, int state, long int state
                 return;
 
         /* Set the required state */
+        if (engine->state != state)
+                aras_engine_event(engine, "state", aras_engine_state_name(state));
         engine->state = state;
 
         /* Set the required time limit when applicable to the state */
-        engine->state_time_elapsed = 0;
+        engine->state_time_start = 0;
         engine->state_time_maximum = state_time_maximum;
+
+        /* Notify the state change to the loop running the engine */
+        if (engine->callback_wake != NULL)
+                engine->callback_wake(engine->callback_wake_data);
+}
+
+/**
+ * This function sets the function called whenever the engine state is changed,
+ * so that an event driven main loop runs the engine without waiting for the
+ * next timeout.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   callback_wake   Pointer to the wake up function, NULL to disable it
+ * @param   data            Pointer to the data passed to the wake up function
+ */
+void aras_engine_set_callback_wake(struct aras_engine *engine, void (*callback_wake)(void *data), void *data)
+{
+        engine->callback_wake = callback_wake;
+        engine->callback_wake_data = data;
+}
+
+/**
+ * This function sets the function called on engine events: state transitions,
+ * start and stop of URIs and errors. It is called in the thread running the
+ * engine.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   callback_event  Pointer to the event function, NULL to disable it
+ * @param   data            Pointer to the data passed to the event function
+ */
+void aras_engine_set_callback_event(struct aras_engine *engine, void (*callback_event)(void *data, char *type, char *argument), void *data)
+{
+        engine->callback_event = callback_event;
+        engine->callback_event_data = data;
+}
+
+/**
+ * This function sets the command queue drained by the engine at the start of
+ * every cycle. The engine is the only consumer of the queue.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   queue   Pointer to the command queue, NULL to disable commands
+ */
+void aras_engine_set_command_queue(struct aras_engine *engine, struct aras_command_queue *queue)
+{
+        engine->command_queue = queue;
 }
 
 /**
@@ -115,71 +269,419 @@ void aras_engine_playlist_print(struct aras_engine *engine)
 }
 
 /**
- * This function manages the state ARAS_ENGINE_STATE_FADE_OUT. It decreases the
- * volumes of both the current player unit and the idle player unit. Then, it
- * stops both player units. Finally, it sets the next state
- * ARAS_ENGINE_STATE_NULL.
+ * This function forgets the playlist node prerolled in an idle player unit and
+ * releases the unit, unless it has become the current one.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   player  Pointer to the player structure with which the
+ *                  engine works
+ */
+void aras_engine_preroll_clear(struct aras_engine *engine, struct aras_player *player)
+{
+        if (engine->preroll_unit != ARAS_PLAYER_UNIT_NONE && engine->preroll_unit != player->current_unit)
+                aras_player_release_unit(player, engine->preroll_unit);
+
+        g_free(engine->preroll_uri);
+        engine->preroll_uri = NULL;
+        engine->preroll_unit = ARAS_PLAYER_UNIT_NONE;
+        engine->preroll_ready_time = 0;
+}
+
+/**
+ * This function checks whether a player unit is left over from previous
+ * playlist nodes, that is, allocated but neither the current unit nor the
+ * prerolled one. Left over units are fading out or stopped.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   player  Pointer to the player structure with which the
+ *                  engine works
+ * @param   unit    The identifier of the player unit
+ *
+ * @return  1 if the unit is left over, 0 otherwise
+ */
+int aras_engine_unit_left_over(struct aras_engine *engine, struct aras_player *player, int unit)
+{
+        return unit != player->current_unit && unit != engine->preroll_unit && aras_player_get_allocated(player, unit);
+}
+
+/**
+ * This function releases the left over player units, so that they are reused
+ * for the next playlist nodes.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   player  Pointer to the player structure with which the
+ *                  engine works
+ */
+void aras_engine_release_units(struct aras_engine *engine, struct aras_player *player)
+{
+        int unit;
+
+        for (unit = 0; unit < aras_player_get_units(player); unit++)
+                if (aras_engine_unit_left_over(engine, player, unit))
+                        aras_player_release_unit(player, unit);
+}
+
+/**
+ * This function checks whether the player has a free unit.
+ *
+ * @param   player  Pointer to the player structure with which the
+ *                  engine works
+ *
+ * @return  1 if a unit can be allocated, 0 otherwise
+ */
+int aras_engine_unit_free(struct aras_player *player)
+{
+        int unit;
+
+        for (unit = 0; unit < aras_player_get_units(player); unit++)
+                if (!aras_player_get_allocated(player, unit))
+                        return 1;
+
+        return 0;
+}
+
+/**
+ * This function returns the time in miliseconds elapsed since the timed part
+ * of the current state started.
+ *
+ * @param   engine  Pointer to the engine structure
+ *
+ * @return  The elapsed time, 0 if the timed part has not started
+ */
+long int aras_engine_state_time_elapsed(struct aras_engine *engine)
+{
+        if (engine->state_time_start == 0)
+                return 0;
+
+        return (long int)((aras_time_monotonic() - engine->state_time_start) / 1000);
+}
+
+/**
+ * This function records the fade and transition settings of the block whose
+ * playlist is loaded in an engine.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   node    Pointer to the block node, NULL for the global settings
+ */
+void aras_engine_set_block_settings(struct aras_engine *engine, struct aras_block_node *node)
+{
+        engine->block_fade_curve = (node != NULL) ? node->fade_curve : -1;
+        engine->block_fade_time = (node != NULL) ? node->fade_time : -1;
+        engine->block_transition = (node != NULL) ? node->transition : ARAS_BLOCK_TRANSITION_CROSSFADE;
+}
+
+/**
+ * This function empties the gapless queue of the current player unit.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   player  Pointer to the player structure with which the
+ *                  engine works
+ */
+void aras_engine_gapless_clear(struct aras_engine *engine, struct aras_player *player)
+{
+        if (engine->gapless_uri == NULL)
+                return;
+
+        aras_player_set_next_uri(player, player->current_unit, NULL);
+        g_free(engine->gapless_uri);
+        engine->gapless_uri = NULL;
+}
+
+/**
+ * This function queues the next playlist node in the current player unit when
+ * the current block plays its files gapless, so that the unit plays it after
+ * the current one without a crossfade. Pending playlists and the end of the
+ * playlist empty the queue, they are reached with a crossfade.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   player  Pointer to the player structure with which the
+ *                  engine works
+ *
+ * @return  0 if the next playlist node is queued, -1 otherwise
+ */
+int aras_engine_gapless(struct aras_engine *engine, struct aras_player *player)
+{
+        GList *next;
+
+        if (engine->block_transition != ARAS_BLOCK_TRANSITION_GAPLESS || engine->pending_playlist ||
+            engine->playlist_current_node == NULL || (next = engine->playlist_current_node->next) == NULL) {
+                aras_engine_gapless_clear(engine, player);
+                return -1;
+        }
+
+        /* Already queued */
+        if (engine->gapless_uri != NULL && !strcmp(engine->gapless_uri, next->data))
+                return 0;
+
+        aras_engine_gapless_clear(engine, player);
+        if (aras_player_set_next_uri(player, player->current_unit, next->data) == -1)
+                return -1;
+        engine->gapless_uri = g_strdup(next->data);
+
+        return 0;
+}
+
+/**
+ * This function keeps the current playlist node in sync with the current
+ * player unit when the queued playlist node starts playing in it.
+ *
+ * @param   engine      Pointer to the engine structure
+ * @param   player      Pointer to the player structure with which the
+ *                      engine works
+ * @param   log_file    The name of the log file
+ */
+void aras_engine_gapless_advance(struct aras_engine *engine, struct aras_player *player, char *log_file)
+{
+        char msg[ARAS_LOG_MESSAGE_MAX];
+        GList *next;
+
+        if (aras_player_take_next_started(player, player->current_unit) == 0 || engine->gapless_uri == NULL)
+                return;
+
+        next = (engine->playlist_current_node != NULL) ? engine->playlist_current_node->next : NULL;
+        if (next != NULL && !strcmp(engine->gapless_uri, next->data)) {
+                engine->playlist_current_node = next;
+                snprintf(msg, sizeof(msg),"URI: %s\n", (char*)next->data);
+                aras_log_write(log_file, msg);
+                aras_engine_event_uri(engine, next->data);
+        }
+        g_free(engine->gapless_uri);
+        engine->gapless_uri = NULL;
+}
+
+/**
+ * This function returns the fade time of the current block of an engine.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   configuration   Pointer to the configuration structure
+ *
+ * @return  The fade time in miliseconds
+ */
+int aras_engine_fade_time(struct aras_engine *engine, struct aras_configuration *configuration)
+{
+        if (engine->block_fade_time >= 0)
+                return engine->block_fade_time;
+
+        return configuration->fade_out_time;
+}
+
+/**
+ * This function returns the fade curve of the current block of an engine.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   configuration   Pointer to the configuration structure
+ *
+ * @return  The fade curve
+ */
+int aras_engine_fade_curve(struct aras_engine *engine, struct aras_configuration *configuration)
+{
+        if (engine->block_fade_curve >= 0)
+                return engine->block_fade_curve;
+
+        return configuration->fade_curve;
+}
+
+/**
+ * This function manages the state ARAS_ENGINE_STATE_FADE_OUT. It schedules
+ * volume ramps down to zero in the current player unit and in the units still
+ * fading out, following the gain table of the fade curve computed once for
+ * the whole fade. Once the ramps end, it releases every player unit. Finally,
+ * it sets the next state ARAS_ENGINE_STATE_NULL.
  *
  * @param   engine  Pointer to the engine structure
  * @param   player  Pointer to the player structure with which the
  *                  engine works
+ * @param   curve   The fade curve
  * @param   slope   The fade out slope
- * @param   period  The fade out execution period
+ * @param   period  The period of the fade out slope
  */
-void aras_engine_fade_out(struct aras_engine *engine, struct aras_player *player, float slope, int period)
+void aras_engine_fade_out(struct aras_engine *engine, struct aras_player *player, int curve, float slope, int period)
 {
-        /* Set volume */
-        aras_player_set_volume_increment(player, player->current_unit, slope, 0);
-        aras_player_set_volume_increment(player, (player->current_unit + 1) % 2, slope, 0);
+        int unit;
+
+        /* Schedule the volume ramps */
+        if (engine->state_time_start == 0) {
+                engine->state_time_start = aras_time_monotonic();
+                aras_fade_init(&engine->fade, curve, engine->state_time_maximum, slope, period);
+                aras_player_set_volume_ramp(player, player->current_unit, 0, engine->fade.time, engine->fade.out, ARAS_FADE_POINTS);
+                for (unit = 0; unit < aras_player_get_units(player); unit++)
+                        if (aras_engine_unit_left_over(engine, player, unit))
+                                aras_player_set_volume_ramp(player, unit, 0, engine->fade.time, engine->fade.out, ARAS_FADE_POINTS);
+        }
 
         /* Check the end of the current state */
-        if ((engine->state_time_elapsed += period) >= engine->state_time_maximum) {
-                /* Stop player and update the current playlist node */
-                aras_player_set_volume(player, player->current_unit, 0);
-                aras_player_set_volume(player, (player->current_unit + 1) % 2, 0);
-                /* Stop playback in current unit and idle unit */
-                aras_player_set_state_ready(player, player->current_unit);
-                aras_player_set_state_ready(player, (player->current_unit + 1) % 2);
+        if (aras_engine_state_time_elapsed(engine) >= engine->state_time_maximum) {
+                /* Stop playback in every unit */
+                aras_engine_gapless_clear(engine, player);
+                aras_engine_release_units(engine, player);
+                aras_engine_preroll_clear(engine, player);
+                aras_player_release_unit(player, player->current_unit);
+                aras_engine_event_uri(engine, NULL);
                 /* Next state */
                 aras_engine_set_state(engine, ARAS_ENGINE_STATE_NULL, 0);
         }
 }
 
 /**
- * This function manages the state ARAS_ENGINE_STATE_CROSSFADE. It increases the
- * volume of the current player unit and decreases the volume of the idle player
- * unit. Then, it stops the idle unit. Finally, it sets the next state
- * ARAS_ENGINE_STATE_NULL.
+ * This function manages the state ARAS_ENGINE_STATE_CROSSFADE. Once the current
+ * player unit completes its state transition, it schedules a volume ramp up in
+ * the current player unit and volume ramps down in the units left over from
+ * the previous playlist nodes, following the gain tables of the fade curve
+ * computed once for the whole crossfade. Once the ramps end, it releases the
+ * left over units. Finally, it sets the next state ARAS_ENGINE_STATE_NULL.
  *
  * @param   engine  Pointer to the engine structure
  * @param   player  Pointer to the player structure with which the
  *                  engine works
  * @param   volume  The final volume for the current unit
+ * @param   curve   The fade curve
  * @param   slope   The fade out slope
- * @param   period  The fade out execution period
+ * @param   period  The period of the fade out slope
  */
-void aras_engine_crossfade(struct aras_engine *engine, struct aras_player *player, float volume, float slope, int period)
+void aras_engine_crossfade(struct aras_engine *engine, struct aras_player *player, float volume, int curve, float slope, int period)
 {
-        /* Set volume */
-        aras_player_set_volume_increment(player, player->current_unit, slope, volume);
-        aras_player_set_volume_increment(player, (player->current_unit + 1) % 2, slope, 0);
+        int state;
+        int unit;
+
+        /* Wait for the current unit to complete its transition, player events wake the engine */
+        if (engine->state_time_start == 0) {
+                aras_player_get_state(player, player->current_unit, &state);
+                if (state == ARAS_PLAYER_STATE_OTHER)
+                        return;
+
+                /* Schedule the volume ramps */
+                engine->state_time_start = aras_time_monotonic();
+                aras_fade_init(&engine->fade, curve, engine->state_time_maximum, slope, period);
+                aras_player_set_volume_ramp(player, player->current_unit, volume, engine->fade.time, engine->fade.in, ARAS_FADE_POINTS);
+                for (unit = 0; unit < aras_player_get_units(player); unit++)
+                        if (aras_engine_unit_left_over(engine, player, unit))
+                                aras_player_set_volume_ramp(player, unit, 0, engine->fade.time, engine->fade.out, ARAS_FADE_POINTS);
+        }
 
         /* Check the end of the current state */
-        if ((engine->state_time_elapsed += period) >= engine->state_time_maximum) {
-                /* Stop player and update the current playlist node */
+        if (aras_engine_state_time_elapsed(engine) >= engine->state_time_maximum) {
                 aras_player_set_volume(player, player->current_unit, volume);
-                aras_player_set_volume(player, (player->current_unit + 1) % 2, 0);
-                /* Stop playback in idle unit */
-                aras_player_set_state_ready(player, (player->current_unit + 1) % 2);
+                /* Stop playback in the left over units */
+                aras_engine_release_units(engine, player);
                 /* Next state */
                 aras_engine_set_state(engine, ARAS_ENGINE_STATE_NULL, 0);
         }
 }
 
 /**
- * This function manages the state ARAS_ENGINE_STATE_PLAY_CURRENT. It swaps the
- * current player unit and plays the current playlist node in it. Finally, it
- * sets the next state ARAS_ENGINE_STATE_CROSSFADE.
+ * This function returns the URI of the playlist node to be played after the
+ * current one while monitoring the schedule: the current playlist node of a
+ * pending playlist or the next playlist node otherwise.
+ *
+ * @param   engine  Pointer to the engine structure
+ *
+ * @return  The URI, NULL if the playlist ends
+ */
+char *aras_engine_preroll_next(struct aras_engine *engine)
+{
+        if (engine->playlist_current_node == NULL)
+                return NULL;
+
+        if (engine->pending_playlist == 1)
+                return engine->playlist_current_node->data;
+
+        if (engine->playlist_current_node->next == NULL)
+                return NULL;
+
+        return engine->playlist_current_node->next->data;
+}
+
+/**
+ * This function computes the time until the next playlist node has to be
+ * prerolled.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   player          Pointer to the player structure with which the
+ *                          engine works
+ * @param   configuration   Pointer to the configuration structure
+ *
+ * @return  The time in miliseconds, ARAS_ENGINE_TIMEOUT_MAXIMUM if there is
+ *          nothing to preroll
+ */
+long int aras_engine_preroll_timeout(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration)
+{
+        char *uri;
+        int state;
+        long duration;
+        long position;
+
+        if (configuration->preroll_time <= 0 || (uri = aras_engine_preroll_next(engine)) == NULL)
+                return ARAS_ENGINE_TIMEOUT_MAXIMUM;
+
+        /* Queued for gapless playback in the current unit */
+        if (engine->gapless_uri != NULL)
+                return ARAS_ENGINE_TIMEOUT_MAXIMUM;
+
+        /* Already prerolled */
+        if (engine->preroll_uri != NULL && !strcmp(engine->preroll_uri, uri))
+                return ARAS_ENGINE_TIMEOUT_MAXIMUM;
+
+        /* Every unit is busy, releasing one wakes the engine */
+        if (engine->preroll_unit == ARAS_PLAYER_UNIT_NONE && !aras_engine_unit_free(player))
+                return ARAS_ENGINE_TIMEOUT_MAXIMUM;
+
+        aras_player_get_state(player, player->current_unit, &state);
+        if (state != ARAS_PLAYER_STATE_PLAYING || (duration = aras_player_get_duration(player, player->current_unit)) == 0)
+                return ARAS_ENGINE_TIMEOUT_MAXIMUM;
+        position = aras_player_get_position(player, player->current_unit);
+
+        return MAX(duration - position - aras_engine_fade_time(engine, configuration) - configuration->preroll_time, 0);
+}
+
+/**
+ * This function prerolls the next playlist node in a free player unit
+ * PrerollTime miliseconds before the fade out point, so that it starts
+ * playing without delay. The unit is allocated from the pool of the player,
+ * so a player with spare units prerolls while a crossfade is in progress. It
+ * also records when the unit is ready.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   player          Pointer to the player structure with which the
+ *                          engine works
+ * @param   configuration   Pointer to the configuration structure
+ */
+void aras_engine_preroll(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration)
+{
+        char *uri;
+        int unit;
+
+        /* Preroll only while monitoring or crossfading */
+        if (engine->state != ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD && engine->state != ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT &&
+            engine->state != ARAS_ENGINE_STATE_CROSSFADE)
+                return;
+
+        /* Preroll the next playlist node in a free unit, reusing the unit of an outdated preroll */
+        if (aras_engine_preroll_timeout(engine, player, configuration) == 0) {
+                uri = aras_engine_preroll_next(engine);
+                aras_engine_preroll_clear(engine, player);
+                if ((unit = aras_player_alloc_unit(player)) == ARAS_PLAYER_UNIT_NONE)
+                        return;
+                aras_player_set_state_ready(player, unit);
+                aras_player_set_volume(player, unit, 0);
+                aras_player_set_uri(player, unit, uri);
+                aras_player_set_state_paused(player, unit);
+                engine->preroll_uri = g_strdup(uri);
+                engine->preroll_unit = unit;
+        }
+
+        /* Record when the unit is ready */
+        if (engine->preroll_unit != ARAS_PLAYER_UNIT_NONE && engine->preroll_ready_time == 0 && aras_player_get_prerolled(player, engine->preroll_unit))
+                engine->preroll_ready_time = aras_time_monotonic();
+}
+
+/**
+ * This function manages the state ARAS_ENGINE_STATE_PLAY_CURRENT. It makes the
+ * unit where the current playlist node was prerolled the current player unit
+ * and only starts playing, writing in the log file the preroll margin, the
+ * time the unit was ready before starting. Otherwise, it plays the node in a
+ * free unit allocated from the pool of the player. The previous current unit
+ * is left over for the crossfade. Finally, it sets the next state
+ * ARAS_ENGINE_STATE_CROSSFADE.
  *
  * @param   engine          Pointer to the engine structure
  * @param   player          Pointer to the player structure with which the
@@ -190,23 +692,51 @@ void aras_engine_crossfade(struct aras_engine *engine, struct aras_player *playe
 void aras_engine_play_current(struct aras_engine *engine, struct aras_player *player, int fade_out_time, char *log_file)
 {
         char msg[ARAS_LOG_MESSAGE_MAX];
+        int unit;
 
         if (engine->playlist_current_node == NULL) {
                 aras_engine_set_state(engine, ARAS_ENGINE_STATE_NULL, 0);
                 return;
         }
 
-        /* Swap unit and play current node */
-        aras_player_swap_current_unit(player);
-        aras_player_set_state_null(player, player->current_unit);
-        aras_player_set_state_ready(player, player->current_unit);
-        aras_player_set_volume(player, player->current_unit, 0);
-        aras_player_set_uri(player, player->current_unit, engine->playlist_current_node->data);
-        aras_player_set_state_playing(player, player->current_unit);
+        /* Play current node, prerolled in an idle unit if possible */
+        aras_engine_gapless_clear(engine, player);
+        if (engine->preroll_uri != NULL && !strcmp(engine->preroll_uri, engine->playlist_current_node->data)) {
+                aras_player_set_current_unit(player, engine->preroll_unit);
+                if (engine->preroll_ready_time == 0 && aras_player_get_prerolled(player, player->current_unit))
+                        engine->preroll_ready_time = aras_time_monotonic();
+                aras_player_set_state_playing(player, player->current_unit);
+                if (engine->preroll_ready_time != 0)
+                        snprintf(msg, sizeof(msg), "Preroll margin: %ld ms\n", (long int)((aras_time_monotonic() - engine->preroll_ready_time) / 1000));
+                else
+                        snprintf(msg, sizeof(msg), "Preroll margin: not ready\n");
+                aras_log_write(log_file, msg);
+        } else {
+                /* Every unit is busy, cut the left over units short */
+                aras_engine_preroll_clear(engine, player);
+                if ((unit = aras_player_alloc_unit(player)) == ARAS_PLAYER_UNIT_NONE) {
+                        aras_engine_release_units(engine, player);
+                        unit = aras_player_alloc_unit(player);
+                }
+                aras_player_set_current_unit(player, unit);
+                aras_player_set_state_ready(player, player->current_unit);
+                aras_player_set_volume(player, player->current_unit, 0);
+                aras_player_set_uri(player, player->current_unit, engine->playlist_current_node->data);
+                aras_player_set_state_playing(player, player->current_unit);
+        }
+        aras_engine_preroll_clear(engine, player);
 
         /* Append message to log file */
         snprintf(msg, sizeof(msg),"URI: %s\n", (char*)engine->playlist_current_node->data);
         aras_log_write(log_file, msg);
+        aras_engine_event_uri(engine, engine->playlist_current_node->data);
+
+        /* Measure the time from the command to the file on air */
+        if (engine->command_time != 0) {
+                snprintf(msg, sizeof(msg), "Command latency: %ld ms\n", (long int)((aras_time_monotonic() - engine->command_time) / 1000));
+                aras_log_write(log_file, msg);
+                engine->command_time = 0;
+        }
 
         /* Perform crossfade */
         aras_engine_set_state(engine, ARAS_ENGINE_STATE_CROSSFADE, fade_out_time);
@@ -247,7 +777,8 @@ void aras_engine_play_previous(struct aras_engine *engine, struct aras_player *p
                 /* Check is default block is enabled */
                 if (default_block_mode == ARAS_CONFIGURATION_MODE_DEFAULT_BLOCK_ON) {
                         /* Load default block and write log entry */
-                        engine->playlist = aras_playlist_load(engine->playlist, default_block, block, 0);
+                        engine->playlist = aras_playlist_load(engine->playlist, default_block, block, 0, engine->rand);
+                        aras_engine_set_block_settings(engine, aras_block_seek_node_name(block, default_block));
                         snprintf(msg, sizeof(msg),"Default block: \"%s\"\n", default_block);
                         aras_log_write(log_file, msg);
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, 0);
@@ -293,7 +824,8 @@ void aras_engine_play_next(struct aras_engine *engine, struct aras_player *playe
                 /* Check is default block is enabled */
                 if (default_block_mode == ARAS_CONFIGURATION_MODE_DEFAULT_BLOCK_ON) {
                         /* Load default block and write log entry */
-                        engine->playlist = aras_playlist_load(engine->playlist, default_block, block, 0);
+                        engine->playlist = aras_playlist_load(engine->playlist, default_block, block, 0, engine->rand);
+                        aras_engine_set_block_settings(engine, aras_block_seek_node_name(block, default_block));
                         snprintf(msg, sizeof(msg),"Default block: \"%s\"\n", default_block);
                         aras_log_write(log_file, msg);
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, 0);
@@ -332,7 +864,8 @@ void aras_engine_play_default(struct aras_engine *engine, struct aras_player *pl
         /* Check is default block is enabled */
         if (default_block_mode == ARAS_CONFIGURATION_MODE_DEFAULT_BLOCK_ON) {
                 /* Load default block and write log entry */
-                engine->playlist = aras_playlist_load(engine->playlist, default_block, block, 0);
+                engine->playlist = aras_playlist_load(engine->playlist, default_block, block, 0, engine->rand);
+                aras_engine_set_block_settings(engine, aras_block_seek_node_name(block, default_block));
                 snprintf(msg, sizeof(msg),"Default block: \"%s\"\n", default_block);
                 aras_log_write(log_file, msg);
                 aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, 0);
@@ -344,11 +877,142 @@ void aras_engine_play_default(struct aras_engine *engine, struct aras_player *pl
         engine->playlist_current_node = engine->playlist;
 }
 
+/**
+ * This function frees a prefetch structure once the engine and the prefetch
+ * thread released it.
+ *
+ * @param   prefetch    Pointer to the prefetch structure
+ */
+void aras_engine_prefetch_free(struct aras_engine_prefetch *prefetch)
+{
+        aras_playlist_free(prefetch->playlist);
+        g_atomic_rc_box_release_full(prefetch->block, (GDestroyNotify)aras_block_list_free);
+        g_rand_free(prefetch->rand);
+}
+
+/**
+ * This function releases the prefetch of an engine. It never waits for the
+ * prefetch thread: a thread still loading the playlist frees it when it
+ * finishes.
+ *
+ * @param   engine  Pointer to the engine structure
+ */
+void aras_engine_prefetch_clear(struct aras_engine *engine)
+{
+        if (engine->prefetch != NULL) {
+                g_atomic_rc_box_release_full(engine->prefetch, (GDestroyNotify)aras_engine_prefetch_free);
+                engine->prefetch = NULL;
+        }
+}
+
+/**
+ * This function is the prefetch thread. It loads the playlist for the block
+ * node of the next schedule node and flags it as done.
+ *
+ * @param   data    Pointer to the prefetch structure
+ *
+ * @return  This function always returns NULL
+ */
+gpointer aras_engine_prefetch_thread(gpointer data)
+{
+        struct aras_engine_prefetch *prefetch;
+
+        prefetch = (struct aras_engine_prefetch*)data;
+        prefetch->playlist = aras_playlist_load_block_node(NULL, prefetch->block_node, prefetch->block, 0, prefetch->rand);
+        g_atomic_int_set(&prefetch->done, 1);
+        g_atomic_rc_box_release_full(prefetch, (GDestroyNotify)aras_engine_prefetch_free);
+
+        return NULL;
+}
+
+/**
+ * This function starts loading in a new thread the playlist for a schedule
+ * node. The prefetch holds a reference to the block, which is shared between
+ * snapshots, so that the block outlives a reload. It uses its own
+ * pseudorandom number generator, seeded from the engine one. The thread is
+ * not joined, the engine and the thread hold a reference to the prefetch.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   schedule_node   Pointer to the schedule node
+ * @param   block           Pointer to the block structure
+ */
+void aras_engine_prefetch_start(struct aras_engine *engine, struct aras_schedule_node *schedule_node, struct aras_block *block)
+{
+        struct aras_engine_prefetch *prefetch;
+
+        aras_engine_prefetch_clear(engine);
+
+        prefetch = g_atomic_rc_box_new0(struct aras_engine_prefetch);
+        prefetch->time = schedule_node->time;
+        prefetch->block_name = schedule_node->block_name;
+        prefetch->block_node = schedule_node->block_node;
+        prefetch->block = g_atomic_rc_box_acquire(block);
+        prefetch->rand = g_rand_new_with_seed(g_rand_int(engine->rand));
+        engine->prefetch = prefetch;
+        g_thread_unref(g_thread_new("aras-prefetch", aras_engine_prefetch_thread, g_atomic_rc_box_acquire(prefetch)));
+}
+
+/**
+ * This function takes the prefetched playlist for a schedule node. The
+ * playlist is taken only if it was loaded for the same time and block name
+ * from the same block structure, and only if the prefetch thread finished,
+ * so that the switch never waits for the file system. Otherwise it is
+ * discarded.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   schedule_node   Pointer to the schedule node
+ * @param   block           Pointer to the block structure
+ * @param   playlist        Pointer to the playlist to be set
+ *
+ * @return  0 if the prefetched playlist is taken, -1 otherwise
+ */
+int aras_engine_prefetch_take(struct aras_engine *engine, struct aras_schedule_node *schedule_node, struct aras_block *block, GList **playlist)
+{
+        struct aras_engine_prefetch *prefetch;
+
+        if ((prefetch = engine->prefetch) == NULL)
+                return -1;
+
+        if (!g_atomic_int_get(&prefetch->done) ||
+            prefetch->time != schedule_node->time ||
+            prefetch->block_name != schedule_node->block_name ||
+            prefetch->block != block) {
+                aras_engine_prefetch_clear(engine);
+                return -1;
+        }
+
+        *playlist = prefetch->playlist;
+        prefetch->playlist = NULL;
+        aras_engine_prefetch_clear(engine);
+
+        return 0;
+}
+
+/**
+ * This function updates the playlist according to the schedule. When a new
+ * schedule node is reached, it loads the playlist for its block; each schedule
+ * node is loaded only once even if the engine runs several times within the
+ * engine period. The playlist for the next schedule node is loaded in the
+ * background PrefetchTime miliseconds in advance and taken when it is
+ * reached if it is ready, so that the switch does not wait for the file
+ * system; it is loaded synchronously otherwise.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   configuration   Pointer to the configuration structure
+ * @param   schedule        Pointer to the schedule structure
+ * @param   block           Pointer to the block structure
+ *
+ * @return  The time in miliseconds to the next schedule node, -1 if the
+ *          schedule is empty
+ */
 long aras_engine_playlist_watch(struct aras_engine *engine, struct aras_configuration *configuration, struct aras_schedule *schedule, struct aras_block *block)
 {
         char msg[ARAS_LOG_MESSAGE_MAX];
         struct aras_schedule_node *current_schedule_node;
         struct aras_schedule_node *next_schedule_node;
+        GList *playlist;
+        long int time;
+        int reached;
 
         /* If current schedule node not present, do nothing */
         if ((current_schedule_node = aras_schedule_seek_node_current(schedule, aras_time_current())) == NULL)
@@ -359,20 +1023,30 @@ long aras_engine_playlist_watch(struct aras_engine *engine, struct aras_configur
                 return -1;
 
         /* If a new schedule node is reached, load the appropriate playlist and notify pending playlist */
-        if (aras_time_reached(aras_time_current(), current_schedule_node->time, configuration->engine_period)) {
-                /* Load playlist for the new schedule node and write log entry */
+        reached = aras_time_reached(aras_time_current(), current_schedule_node->time, configuration->engine_period);
+        if (reached && engine->trigger_time != current_schedule_node->time) {
+                engine->trigger_time = current_schedule_node->time;
+                engine->hold_default_block = 0;
+                /* Take the prefetched playlist or load the playlist for the new schedule node and write log entry */
                 engine->playlist = aras_playlist_free(engine->playlist);
-                engine->playlist = aras_playlist_load(engine->playlist, current_schedule_node->block_name, block, 0);
+                if (aras_engine_prefetch_take(engine, current_schedule_node, block, &playlist) == 0)
+                        engine->playlist = playlist;
+                else
+                        engine->playlist = aras_playlist_load_block_node(engine->playlist, current_schedule_node->block_node, block, 0, engine->rand);
+                aras_engine_set_block_settings(engine, current_schedule_node->block_node);
                 engine->playlist_current_node = engine->playlist;
                 engine->pending_playlist = 1;
                 snprintf(msg, sizeof(msg),"Regular block: \"%s\"\n", current_schedule_node->block_name);
                 aras_log_write(configuration->log_file, msg);
         } else {
-                /* If playlist not present, load playlist for the default block and notify pending playlist */
-                if (engine->playlist == NULL) {
+                if (!reached)
+                        engine->trigger_time = -1;
+                /* If playlist not present, load playlist for the default block and notify pending playlist, unless faded out */
+                if (engine->playlist == NULL && !engine->hold_default_block) {
                         if (configuration->default_block_mode == ARAS_CONFIGURATION_MODE_DEFAULT_BLOCK_ON) {
                                 /* Load default block and write log entry */
-                                engine->playlist = aras_playlist_load(engine->playlist, configuration->default_block, block, 0);
+                                engine->playlist = aras_playlist_load(engine->playlist, configuration->default_block, block, 0, engine->rand);
+                                aras_engine_set_block_settings(engine, aras_block_seek_node_name(block, configuration->default_block));
                                 engine->playlist_current_node = engine->playlist;
                                 engine->pending_playlist = 1;
                                 snprintf(msg, sizeof(msg),"Default block: \"%s\"\n", configuration->default_block);
@@ -380,7 +1054,15 @@ long aras_engine_playlist_watch(struct aras_engine *engine, struct aras_configur
                         }
                 }
         }
-        return aras_time_difference(next_schedule_node->time, aras_time_current());
+
+        /* Prefetch the playlist for the next schedule node, again if a reload changed it */
+        time = aras_time_difference(next_schedule_node->time, aras_time_current());
+        if (configuration->prefetch_time > 0 && time <= configuration->prefetch_time && next_schedule_node != current_schedule_node &&
+            (engine->prefetch == NULL || engine->prefetch->time != next_schedule_node->time ||
+             engine->prefetch->block_name != next_schedule_node->block_name || engine->prefetch->block != block))
+                aras_engine_prefetch_start(engine, next_schedule_node, block);
+
+        return time;
 }
 
 /**
@@ -414,17 +1096,16 @@ void aras_engine_monitor_schedule_soft(struct aras_engine *engine, struct aras_p
         case ARAS_PLAYER_STATE_ERROR:
                 snprintf(msg, sizeof(msg),"ARAS engine: player error\n");
                 aras_log_write(configuration->log_file, msg);
+                aras_engine_event(engine, "error", "player error");
                 if (engine->pending_playlist == 1) {
                         snprintf(msg, sizeof(msg),"ARAS engine: pending playlist: recover procedure\n");
                         aras_log_write(configuration->log_file, msg);
-                        aras_player_set_state_null(player, player->current_unit);
                         aras_player_set_state_ready(player, player->current_unit);
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, 0);
                         engine->pending_playlist = 0;
                 } else {
                         snprintf(msg, sizeof(msg),"ARAS engine: no pending playlist: recover procedure\n");
                         aras_log_write(configuration->log_file, msg);
-                        aras_player_set_state_null(player, player->current_unit);
                         aras_player_set_state_ready(player, player->current_unit);
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_NEXT, 0);
                 }
@@ -444,10 +1125,11 @@ void aras_engine_monitor_schedule_soft(struct aras_engine *engine, struct aras_p
                 }
                 break;
         case ARAS_PLAYER_STATE_PLAYING:
-                /* If not streaming play the next playlist node */
-                if ((duration = aras_player_get_duration(player, player->current_unit)) != 0) {
+                /* If not streaming nor gapless play the next playlist node */
+                aras_engine_gapless_advance(engine, player, configuration->log_file);
+                if (aras_engine_gapless(engine, player) == -1 && (duration = aras_player_get_duration(player, player->current_unit)) != 0) {
                         position = aras_player_get_position(player, player->current_unit);
-                        if (duration - position <= configuration->fade_out_time) {
+                        if (duration - position <= aras_engine_fade_time(engine, configuration)) {
                                 if (engine->pending_playlist == 1) {
                                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, 0);
                                         engine->pending_playlist = 0;
@@ -456,6 +1138,7 @@ void aras_engine_monitor_schedule_soft(struct aras_engine *engine, struct aras_p
                                 }
                         }
                 }
+                aras_engine_preroll(engine, player, configuration);
                 break;
         default:
                 break;
@@ -492,17 +1175,16 @@ void aras_engine_monitor_schedule_hard(struct aras_engine *engine, struct aras_p
         case ARAS_PLAYER_STATE_ERROR:
                 snprintf(msg, sizeof(msg),"ARAS engine: player error\n");
                 aras_log_write(configuration->log_file, msg);
+                aras_engine_event(engine, "error", "player error");
                 if (engine->pending_playlist == 1) {
                         snprintf(msg, sizeof(msg),"ARAS engine: pending playlist: recover procedure\n");
                         aras_log_write(configuration->log_file, msg);
-                        aras_player_set_state_null(player, player->current_unit);
                         aras_player_set_state_ready(player, player->current_unit);
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, 0);
                         engine->pending_playlist = 0;
                 } else {
                         snprintf(msg, sizeof(msg),"ARAS engine: no pending playlist: recover procedure\n");
                         aras_log_write(configuration->log_file, msg);
-                        aras_player_set_state_null(player, player->current_unit);
                         aras_player_set_state_ready(player, player->current_unit);
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_NEXT, 0);
                 }
@@ -511,36 +1193,153 @@ void aras_engine_monitor_schedule_hard(struct aras_engine *engine, struct aras_p
                 if (engine->pending_playlist == 1) {
                         snprintf(msg, sizeof(msg),"ARAS engine: start pending playlist\n");
                         aras_log_write(configuration->log_file, msg);
-                        aras_player_set_state_null(player, player->current_unit);
                         aras_player_set_state_ready(player, player->current_unit);
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, 0);
                         engine->pending_playlist = 0;
                 } else {
                         snprintf(msg, sizeof(msg),"ARAS engine: continue current playlist\n");
-                        aras_player_set_state_null(player, player->current_unit);
                         aras_player_set_state_ready(player, player->current_unit);
                         aras_log_write(configuration->log_file, msg);
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_NEXT, 0);
                 }
                 break;
         case ARAS_PLAYER_STATE_PLAYING:
+                aras_engine_gapless_advance(engine, player, configuration->log_file);
                 if (engine->pending_playlist == 1) {
                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, 0);
                         engine->pending_playlist = 0;
                 } else {
-                        /* If not streaming play the next playlist node */
-                        if ((duration = aras_player_get_duration(player, player->current_unit)) != 0) {
+                        /* If not streaming nor gapless play the next playlist node */
+                        if (aras_engine_gapless(engine, player) == -1 && (duration = aras_player_get_duration(player, player->current_unit)) != 0) {
                                 position = aras_player_get_position(player, player->current_unit);
-                                if (duration - position <= configuration->fade_out_time)
+                                if (duration - position <= aras_engine_fade_time(engine, configuration))
                                         aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_NEXT, 0);
                         }
                 }
+                aras_engine_preroll(engine, player, configuration);
                 break;
         default:
                 break;
         }
 }
 
+/**
+ * This function runs a command taken from the command queue. Inserting a URI
+ * after the current file is always possible, the other commands are only run
+ * while the engine is monitoring the schedule, otherwise they are ignored.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   player          Pointer to the player structure with which the
+ *                          engine works
+ * @param   command         Pointer to the command
+ * @param   configuration   Pointer to the configuration structure
+ * @param   block           Pointer to the block structure
+ */
+void aras_engine_command(struct aras_engine *engine, struct aras_player *player, struct aras_command *command, struct aras_configuration *configuration, struct aras_block *block)
+{
+        char msg[ARAS_LOG_MESSAGE_MAX];
+        GList *playlist;
+
+        if (command->type != ARAS_COMMAND_INSERT_URI && engine->state != ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD && engine->state != ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT) {
+                snprintf(msg, sizeof(msg), "Command ignored: engine busy\n");
+                aras_log_write(configuration->log_file, msg);
+                aras_engine_event(engine, "error", "command ignored: engine busy");
+                return;
+        }
+
+        switch (command->type) {
+        case ARAS_COMMAND_PLAY_PREVIOUS:
+                aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_PREVIOUS, configuration->fade_out_time);
+                break;
+        case ARAS_COMMAND_PLAY_CURRENT:
+                aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, configuration->fade_out_time);
+                break;
+        case ARAS_COMMAND_PLAY_NEXT:
+                aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_NEXT, configuration->fade_out_time);
+                break;
+        case ARAS_COMMAND_PLAY_DEFAULT:
+                aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_DEFAULT, configuration->fade_out_time);
+                break;
+        case ARAS_COMMAND_PLAY_BLOCK:
+                /* Keep the current playlist if the block cannot be loaded */
+                if ((playlist = aras_playlist_load(NULL, command->argument, block, 0, engine->rand)) == NULL) {
+                        snprintf(msg, sizeof(msg), "Command ignored: block \"%s\" not loaded\n", command->argument);
+                        aras_log_write(configuration->log_file, msg);
+                        aras_engine_event(engine, "error", "command ignored: block not loaded");
+                        return;
+                }
+                engine->playlist = aras_playlist_free(engine->playlist);
+                engine->playlist = playlist;
+                engine->playlist_current_node = engine->playlist;
+                aras_engine_set_block_settings(engine, aras_block_seek_node_name(block, command->argument));
+                snprintf(msg, sizeof(msg), "Command block: \"%s\"\n", command->argument);
+                aras_log_write(configuration->log_file, msg);
+                aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, configuration->fade_out_time);
+                break;
+        case ARAS_COMMAND_INSERT_URI:
+                if ((playlist = aras_playlist_load_file(NULL, command->argument)) == NULL) {
+                        snprintf(msg, sizeof(msg), "Command ignored: URI \"%s\" not loaded\n", command->argument);
+                        aras_log_write(configuration->log_file, msg);
+                        aras_engine_event(engine, "error", "command ignored: URI not loaded");
+                        return;
+                }
+                snprintf(msg, sizeof(msg), "Command URI: %s\n", (char*)playlist->data);
+                aras_log_write(configuration->log_file, msg);
+                if (engine->playlist_current_node == NULL) {
+                        /* Nothing to follow, play it now */
+                        engine->playlist = aras_playlist_free(engine->playlist);
+                        engine->playlist = playlist;
+                        engine->playlist_current_node = engine->playlist;
+                        if (engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD || engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT)
+                                aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_CURRENT, configuration->fade_out_time);
+                } else {
+                        /* Play it after the current file, the file prepared for the next one is dropped */
+                        engine->playlist = g_list_insert_before(engine->playlist, engine->playlist_current_node->next, playlist->data);
+                        g_list_free(playlist);
+                        aras_engine_gapless_clear(engine, player);
+                        aras_engine_preroll_clear(engine, player);
+                        return;
+                }
+                break;
+        case ARAS_COMMAND_FADE_OUT:
+                /* Fade out and stay silent until the schedule loads the next block */
+                engine->playlist = aras_playlist_free(engine->playlist);
+                engine->playlist_current_node = engine->playlist;
+                aras_engine_set_state(engine, ARAS_ENGINE_STATE_FADE_OUT, aras_engine_fade_time(engine, configuration));
+                break;
+        default:
+                return;
+        }
+
+        /* Any other command run ends the silence of a fade out */
+        engine->hold_default_block = command->type == ARAS_COMMAND_FADE_OUT;
+        engine->command_time = command->time;
+}
+
+/**
+ * This function drains the command queue of an engine.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   player          Pointer to the player structure with which the
+ *                          engine works
+ * @param   configuration   Pointer to the configuration structure
+ * @param   block           Pointer to the block structure
+ */
+void aras_engine_commands(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration, struct aras_block *block)
+{
+        struct aras_command command;
+
+        if (engine->command_queue == NULL)
+                return;
+
+        /* A command back to monitoring without a file on air is not measured */
+        if (engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD || engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT)
+                engine->command_time = 0;
+
+        while (aras_command_queue_pop(engine->command_queue, &command) == 0)
+                aras_engine_command(engine, player, &command, configuration, block);
+}
+
 /**
  * This function manages a block player engine.
  *
@@ -555,6 +1354,9 @@ void aras_engine_schedule(struct aras_engine *engine, struct aras_player *player
 {
         char msg[ARAS_LOG_MESSAGE_MAX];
 
+        /* Run the commands sent since the last cycle */
+        aras_engine_commands(engine, player, configuration, block);
+
         switch (engine->state) {
         case ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD:
                 aras_engine_monitor_schedule_hard(engine, player, configuration, schedule, block);
@@ -563,22 +1365,23 @@ void aras_engine_schedule(struct aras_engine *engine, struct aras_player *player
                 aras_engine_monitor_schedule_soft(engine, player, configuration, schedule, block);
                 break;
         case ARAS_ENGINE_STATE_PLAY_PREVIOUS:
-                aras_engine_play_previous(engine, player, configuration->default_block_mode, configuration->default_block, block, configuration->fade_out_time, configuration->log_file);
+                aras_engine_play_previous(engine, player, configuration->default_block_mode, configuration->default_block, block, aras_engine_fade_time(engine, configuration), configuration->log_file);
                 break;
         case ARAS_ENGINE_STATE_PLAY_NEXT:
-                aras_engine_play_next(engine, player, configuration->default_block_mode, configuration->default_block, block, configuration->fade_out_time, configuration->log_file);
+                aras_engine_play_next(engine, player, configuration->default_block_mode, configuration->default_block, block, aras_engine_fade_time(engine, configuration), configuration->log_file);
                 break;
         case ARAS_ENGINE_STATE_PLAY_CURRENT:
-                aras_engine_play_current(engine, player, configuration->fade_out_time, configuration->log_file);
+                aras_engine_play_current(engine, player, aras_engine_fade_time(engine, configuration), configuration->log_file);
                 break;
         case ARAS_ENGINE_STATE_PLAY_DEFAULT:
-                aras_engine_play_default(engine, player, configuration->default_block_mode, configuration->default_block, block, configuration->fade_out_time, configuration->log_file);
+                aras_engine_play_default(engine, player, configuration->default_block_mode, configuration->default_block, block, aras_engine_fade_time(engine, configuration), configuration->log_file);
                 break;
         case ARAS_ENGINE_STATE_CROSSFADE:
-                aras_engine_crossfade(engine, player, configuration->block_player_volume, configuration->fade_out_slope, configuration->engine_period);
+                aras_engine_crossfade(engine, player, configuration->block_player_volume, aras_engine_fade_curve(engine, configuration), configuration->fade_out_slope, configuration->engine_period);
+                aras_engine_preroll(engine, player, configuration);
                 break;
         case ARAS_ENGINE_STATE_FADE_OUT:
-                aras_engine_fade_out(engine, player, configuration->fade_out_slope, configuration->engine_period);
+                aras_engine_fade_out(engine, player, aras_engine_fade_curve(engine, configuration), configuration->fade_out_slope, configuration->engine_period);
                 break;
         default:
                 if (configuration->schedule_mode == ARAS_CONFIGURATION_MODE_SCHEDULE_HARD)
@@ -589,6 +1392,26 @@ void aras_engine_schedule(struct aras_engine *engine, struct aras_player *player
         }
 }
 
+/**
+ * This function returns the interval between time signals according to the
+ * time signal mode.
+ *
+ * @param   configuration   Pointer to the configuration structure
+ *
+ * @return  The interval in miliseconds, 0 if the time signal is disabled
+ */
+long int aras_engine_time_signal_interval(struct aras_configuration *configuration)
+{
+        switch (configuration->time_signal_mode) {
+        case ARAS_CONFIGURATION_MODE_TIME_SIGNAL_HALF:
+                return ARAS_TIME_HOUR / 2;
+        case ARAS_CONFIGURATION_MODE_TIME_SIGNAL_HOUR:
+                return ARAS_TIME_HOUR;
+        default:
+                return 0;
+        }
+}
+
 /**
  * This function manages the state ARAS_ENGINE_STATE_MONITOR_TIME_SIGNAL.
  * It computes the time for the next time signal and sets the time limit
@@ -604,31 +1427,29 @@ void aras_engine_schedule(struct aras_engine *engine, struct aras_player *player
  */
 void aras_engine_monitor_time_signal(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration, struct aras_block *block)
 {
+        long int interval;
         long int next_time_signal;
+        long int start_time_signal;
         char msg[ARAS_LOG_MESSAGE_MAX];
         int state;
         long duration;
         long position;
 
         /* Get the time for the next time signal */
-        switch (configuration->time_signal_mode) {
-        case ARAS_CONFIGURATION_MODE_TIME_SIGNAL_HALF:
-                next_time_signal = (ldiv(aras_time_current(), ARAS_TIME_HOUR / 2).quot + 1) * ARAS_TIME_HOUR / 2;
-                break;
-        case ARAS_CONFIGURATION_MODE_TIME_SIGNAL_HOUR:
-                next_time_signal = (ldiv(aras_time_current(), ARAS_TIME_HOUR).quot + 1) * ARAS_TIME_HOUR;
-                break;
-        default:       
+        if ((interval = aras_engine_time_signal_interval(configuration)) == 0)
                 return;
-        }
+        next_time_signal = (ldiv(aras_time_current(), interval).quot + 1) * interval;
+        start_time_signal = aras_time_difference(next_time_signal, configuration->time_signal_advance);
 
         /* If a new time signal is reached, load the appropriate playlist and play the first playlist node */
-        if (aras_time_reached(aras_time_current(),
-                              aras_time_difference(next_time_signal, configuration->time_signal_advance),
-                              configuration->engine_period)) {
-                /* Load playlist for the new schedule node and write log entry */
+        if (!aras_time_reached(aras_time_current(), start_time_signal, configuration->engine_period)) {
+                engine->trigger_time = -1;
+        } else if (engine->trigger_time != start_time_signal) {
+                engine->trigger_time = start_time_signal;
+                /* Load playlist for the resolved block node of the new schedule node and write log entry */
                 engine->playlist = aras_playlist_free(engine->playlist);
-                engine->playlist = aras_playlist_load(engine->playlist, configuration->time_signal_block, block, 0);
+                engine->playlist = aras_playlist_load(engine->playlist, configuration->time_signal_block, block, 0, engine->rand);
+                aras_engine_set_block_settings(engine, aras_block_seek_node_name(block, configuration->time_signal_block));
                 engine->playlist_current_node = engine->playlist;
                 snprintf(msg, sizeof(msg),"Time signal block: \"%s\"\n", configuration->time_signal_block);
                 aras_log_write(configuration->log_file, msg);
@@ -646,22 +1467,22 @@ void aras_engine_monitor_time_signal(struct aras_engine *engine, struct aras_pla
         case ARAS_PLAYER_STATE_ERROR:
                 snprintf(msg, sizeof(msg),"ARAS TS engine: player error\n");
                 aras_log_write(configuration->log_file, msg);
-                aras_player_set_state_null(player, player->current_unit);
+                aras_engine_event(engine, "error", "player error");
                 aras_player_set_state_ready(player, player->current_unit);
                 aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_NEXT, 0);
                 break;
         case ARAS_PLAYER_STATE_STOP:
                 snprintf(msg, sizeof(msg),"ARAS TS engine: player stopped\n");
                 aras_log_write(configuration->log_file, msg);
-                aras_player_set_state_null(player, player->current_unit);
                 aras_player_set_state_ready(player, player->current_unit);
                 aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_NEXT, 0);
                 break;
         case ARAS_PLAYER_STATE_PLAYING:
-                /* If not streaming play the next playlist node */
-                if ((duration = aras_player_get_duration(player, player->current_unit)) != 0) {
+                /* If not streaming nor gapless play the next playlist node */
+                aras_engine_gapless_advance(engine, player, configuration->log_file);
+                if (aras_engine_gapless(engine, player) == -1 && (duration = aras_player_get_duration(player, player->current_unit)) != 0) {
                         position = aras_player_get_position(player, player->current_unit);
-                        if (duration - position <= configuration->fade_out_time)
+                        if (duration - position <= aras_engine_fade_time(engine, configuration))
                                 aras_engine_set_state(engine, ARAS_ENGINE_STATE_PLAY_NEXT, 0);
                 }
                 break;
@@ -687,19 +1508,197 @@ void aras_engine_time_signal(struct aras_engine *engine, struct aras_player *pla
                 aras_engine_monitor_time_signal(engine, player, configuration, block);
                 break;
         case ARAS_ENGINE_STATE_PLAY_NEXT:
-                aras_engine_play_next(engine, player, ARAS_CONFIGURATION_MODE_DEFAULT_BLOCK_OFF, configuration->default_block, block, configuration->fade_out_time, configuration->log_file);
+                aras_engine_play_next(engine, player, ARAS_CONFIGURATION_MODE_DEFAULT_BLOCK_OFF, configuration->default_block, block, aras_engine_fade_time(engine, configuration), configuration->log_file);
                 break;
         case ARAS_ENGINE_STATE_PLAY_CURRENT:
-                aras_engine_play_current(engine, player, configuration->fade_out_time, configuration->log_file);
+                aras_engine_play_current(engine, player, aras_engine_fade_time(engine, configuration), configuration->log_file);
                 break;
         case ARAS_ENGINE_STATE_CROSSFADE:
-                aras_engine_crossfade(engine, player, configuration->time_signal_player_volume, configuration->fade_out_slope, configuration->engine_period);
+                aras_engine_crossfade(engine, player, configuration->time_signal_player_volume, aras_engine_fade_curve(engine, configuration), configuration->fade_out_slope, configuration->engine_period);
                 break;
         case ARAS_ENGINE_STATE_FADE_OUT:
-                aras_engine_fade_out(engine, player, configuration->fade_out_slope, configuration->engine_period);
+                aras_engine_fade_out(engine, player, aras_engine_fade_curve(engine, configuration), configuration->fade_out_slope, configuration->engine_period);
                 break;
         default:
                 aras_engine_set_state(engine, ARAS_ENGINE_STATE_MONITOR_TIME_SIGNAL, 0);
                 break;
         }
 }
+
+/**
+ * This function computes the time until the engine has to check the player
+ * again, that is, the time until the current playlist node reaches the fade
+ * out point.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   player          Pointer to the player structure with which the
+ *                          engine works
+ * @param   configuration   Pointer to the configuration structure
+ *
+ * @return  The time in miliseconds
+ */
+long int aras_engine_player_timeout(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration)
+{
+        int state;
+        long duration;
+        long position;
+
+        /* If no files to play, wait for the next event */
+        if (engine->playlist_current_node == NULL)
+                return ARAS_ENGINE_TIMEOUT_MAXIMUM;
+
+        aras_player_get_state(player, player->current_unit, &state);
+        switch (state) {
+        case ARAS_PLAYER_STATE_PLAYING:
+                /* Streams and gapless files have no fade out point, the player wakes the engine on errors and file changes */
+                if (engine->gapless_uri != NULL || (duration = aras_player_get_duration(player, player->current_unit)) == 0)
+                        return ARAS_ENGINE_TIMEOUT_MAXIMUM;
+                position = aras_player_get_position(player, player->current_unit);
+                if (duration - position - aras_engine_fade_time(engine, configuration) < 0)
+                        return 0;
+                return duration - position - aras_engine_fade_time(engine, configuration);
+        default:
+                /* Transitions in progress are polled */
+                return configuration->engine_period;
+        }
+}
+
+/**
+ * This function computes the time until the engine has to run again while
+ * fading, that is, the end of the volume ramps. The engine period is used
+ * while waiting for the ramps to start.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   configuration   Pointer to the configuration structure
+ *
+ * @return  The time in miliseconds
+ */
+long int aras_engine_fade_timeout(struct aras_engine *engine, struct aras_configuration *configuration)
+{
+        if (engine->state_time_start == 0)
+                return configuration->engine_period;
+
+        return MAX(engine->state_time_maximum - aras_engine_state_time_elapsed(engine), 0);
+}
+
+/**
+ * This function computes the time until the block player engine has to run
+ * again: the next schedule node or the fade out point of the current playlist
+ * node while monitoring the schedule, the end of the fade while fading.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   player          Pointer to the player structure with which the
+ *                          engine works
+ * @param   configuration   Pointer to the configuration structure
+ * @param   schedule        Pointer to the schedule structure
+ *
+ * @return  The time in miliseconds, never greater than
+ *          ARAS_ENGINE_TIMEOUT_MAXIMUM
+ */
+long int aras_engine_schedule_timeout(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration, struct aras_schedule *schedule)
+{
+        struct aras_schedule_node *next_schedule_node;
+        long int next_time;
+        long int timeout;
+
+        switch (engine->state) {
+        case ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD:
+        case ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT:
+                timeout = MIN(aras_engine_player_timeout(engine, player, configuration),
+                              aras_engine_preroll_timeout(engine, player, configuration));
+                if ((next_schedule_node = aras_schedule_seek_node_next(schedule, aras_time_current())) != NULL) {
+                        next_time = aras_time_difference(next_schedule_node->time, aras_time_current());
+                        timeout = MIN(timeout, next_time);
+                        /* Start of the prefetch for the next schedule node */
+                        if (configuration->prefetch_time > 0 && (engine->prefetch == NULL || engine->prefetch->time != next_schedule_node->time) &&
+                            next_time > configuration->prefetch_time)
+                                timeout = MIN(timeout, next_time - configuration->prefetch_time);
+                }
+                break;
+        case ARAS_ENGINE_STATE_CROSSFADE:
+                timeout = MIN(aras_engine_fade_timeout(engine, configuration),
+                              aras_engine_preroll_timeout(engine, player, configuration));
+                break;
+        case ARAS_ENGINE_STATE_FADE_OUT:
+                timeout = aras_engine_fade_timeout(engine, configuration);
+                break;
+        default:
+                timeout = 0;
+                break;
+        }
+
+        return MIN(timeout, ARAS_ENGINE_TIMEOUT_MAXIMUM);
+}
+
+/**
+ * This function computes the time until the time signal engine has to run
+ * again: the start of the next time signal or the fade out point of the
+ * current playlist node while monitoring, the end of the fade while fading.
+ *
+ * @param   engine          Pointer to the engine structure
+ * @param   player          Pointer to the player structure with which the
+ *                          engine works
+ * @param   configuration   Pointer to the configuration structure
+ *
+ * @return  The time in miliseconds, never greater than
+ *          ARAS_ENGINE_TIMEOUT_MAXIMUM
+ */
+long int aras_engine_time_signal_timeout(struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration)
+{
+        long int interval;
+        long int current_time;
+        long int timeout;
+
+        switch (engine->state) {
+        case ARAS_ENGINE_STATE_MONITOR_TIME_SIGNAL:
+                timeout = aras_engine_player_timeout(engine, player, configuration);
+                if ((interval = aras_engine_time_signal_interval(configuration)) != 0) {
+                        /* First time signal start later than the current time */
+                        current_time = aras_time_current();
+                        timeout = MIN(timeout, (ldiv(current_time + configuration->time_signal_advance, interval).quot + 1) * interval
+                                               - configuration->time_signal_advance - current_time);
+                }
+                break;
+        case ARAS_ENGINE_STATE_CROSSFADE:
+        case ARAS_ENGINE_STATE_FADE_OUT:
+                timeout = aras_engine_fade_timeout(engine, configuration);
+                break;
+        default:
+                timeout = 0;
+                break;
+        }
+
+        return MIN(timeout, ARAS_ENGINE_TIMEOUT_MAXIMUM);
+}
+
+/**
+ * This function samples the status of an engine and its player for the status
+ * segment. It must be called by the thread running the engine.
+ *
+ * @param   engine  Pointer to the engine structure
+ * @param   player  Pointer to the player structure with which the engine works
+ * @param   status  Pointer to the player status to fill
+ */
+void aras_engine_status(struct aras_engine *engine, struct aras_player *player, struct aras_status_player *status)
+{
+        GList *node;
+        int state;
+        int unit;
+
+        node = engine->playlist_current_node;
+        status->engine_state = engine->state;
+        status->current_deck = aras_player_get_current_unit(player);
+        status->decks = MIN(aras_player_get_units(player), ARAS_STATUS_MAX_DECKS);
+        g_strlcpy(status->uri_current, node != NULL ? (char*)node->data : "", sizeof(status->uri_current));
+        g_strlcpy(status->uri_next, node != NULL && node->next != NULL ? (char*)node->next->data : "", sizeof(status->uri_next));
+
+        for (unit = 0; unit < status->decks; unit++) {
+                aras_player_get_state(player, unit, &state);
+                status->deck[unit].allocated = aras_player_get_allocated(player, unit);
+                status->deck[unit].state = state;
+                status->deck[unit].position = aras_player_get_position(player, unit);
+                status->deck[unit].duration = aras_player_get_duration(player, unit);
+                status->deck[unit].volume = aras_player_get_volume(player, unit);
+                status->deck[unit].buffer_percent = aras_player_get_buffer_percent(player, unit);
+        }
+}
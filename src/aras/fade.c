@@ -0,0 +1,99 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Source file for the ARAS Radio Automation System. Functions for the fade
+ * module.
+ */
+
+#include <math.h>
+#include <aras/configuration.h>
+#include <aras/fade.h>
+
+/**
+ * This function returns the value of a fade curve rising from 0 to 1.
+ *
+ * @param   curve   The fade curve
+ * @param   p       The elapsed fraction of the fade, from 0 to 1
+ *
+ * @return  The value of the curve
+ */
+double aras_fade_curve(int curve, double p)
+{
+        double floor;
+
+        switch (curve) {
+        case ARAS_CONFIGURATION_MODE_FADE_CURVE_EQUAL_POWER:
+                return sin(p * M_PI / 2);
+        case ARAS_CONFIGURATION_MODE_FADE_CURVE_LOGARITHMIC:
+                /* Linear in decibels, from the bottom of the range */
+                floor = pow(10, -ARAS_FADE_LOGARITHMIC_RANGE / 20);
+                return (pow(10, ARAS_FADE_LOGARITHMIC_RANGE * (p - 1) / 20) - floor) / (1 - floor);
+        case ARAS_CONFIGURATION_MODE_FADE_CURVE_S_CURVE:
+                return (1 - cos(p * M_PI)) / 2;
+        default:
+                return p;
+        }
+}
+
+/**
+ * This function initializes a fade structure. It computes once the progress
+ * tables of the volumes rising and falling during the fade, sampled at
+ * ARAS_FADE_POINTS equal intervals. A volume goes from its start value to
+ * its final value as start + (final - start) * progress.
+ *
+ * Falling volumes mirror rising ones, so that with equal power curves the
+ * power of a crossfade stays constant. Exponential fades keep the original
+ * curve, an increment with the given slope every period, and reach the final
+ * value at the end of the fade.
+ *
+ * @param   fade    Pointer to the fade structure
+ * @param   curve   The fade curve
+ * @param   time    The fade time in miliseconds
+ * @param   slope   The slope of exponential fades
+ * @param   period  The period in miliseconds of the slope of exponential fades
+ */
+void aras_fade_init(struct aras_fade *fade, int curve, long int time, float slope, int period)
+{
+        double p;
+        int k;
+
+        fade->curve = curve;
+        fade->time = time;
+
+        for (k = 0; k <= ARAS_FADE_POINTS; k++) {
+                p = (double)k / ARAS_FADE_POINTS;
+                if (curve == ARAS_CONFIGURATION_MODE_FADE_CURVE_EXPONENTIAL) {
+                        fade->in[k] = (period > 0) ? 1 - pow(1 - slope, p * time / period) : 1;
+                        fade->out[k] = fade->in[k];
+                } else {
+                        fade->in[k] = aras_fade_curve(curve, p);
+                        fade->out[k] = 1 - aras_fade_curve(curve, 1 - p);
+                }
+        }
+
+        /* Exact end values */
+        fade->in[0] = fade->out[0] = 0;
+        fade->in[ARAS_FADE_POINTS] = fade->out[ARAS_FADE_POINTS] = 1;
+}
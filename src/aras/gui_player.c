@@ -37,6 +37,8 @@
 #include <aras/schedule.h>
 #include <aras/block.h>
 #include <aras/engine.h>
+#include <aras/snapshot.h>
+#include <aras/command.h>
 #include <aras/gui_player.h>
 
 /**
@@ -188,9 +190,21 @@ void aras_gui_player_callback_status_icon_menu(GtkStatusIcon *status_icon, guint
 }
 
 /**
- * This function is the callback function for the backward button. It attempts
- * to set the state ARAS_ENGINE_STATE_BLOCK_PLAYER_PLAY_PREVIOUS with a time
- * limit according to the configuration fade_out_time field.
+ * This function sends a command to the engine thread through the command
+ * queue. The engine is never accessed by the GUI.
+ *
+ * @param   data    Pointer to the callback data
+ * @param   type    The type of command
+ */
+void aras_gui_player_command_send(struct aras_gui_player_callback *data, int type)
+{
+        if (aras_command_queue_push(data->command_queue, type, NULL) == -1)
+                fprintf(stderr, "aras: command queue full\n");
+}
+
+/**
+ * This function is the callback function for the backward button. It sends the
+ * engine thread the command ARAS_COMMAND_PLAY_PREVIOUS.
  *
  * @param   widget  Pointer to the widget
  * @param   event   Pointer to the event
@@ -198,14 +212,12 @@ void aras_gui_player_callback_status_icon_menu(GtkStatusIcon *status_icon, guint
  */
 void aras_gui_player_callback_button_backward(GtkWidget *widget, struct aras_gui_player_callback *data)
 {
-        if (data->engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD || data->engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT)
-                aras_engine_set_state(data->engine, ARAS_ENGINE_STATE_PLAY_PREVIOUS, data->configuration->fade_out_time);
+        aras_gui_player_command_send(data, ARAS_COMMAND_PLAY_PREVIOUS);
 }
 
 /**
- * This function is the callback function for the repeat button. It attempts to
- * set the state ARAS_ENGINE_STATE_BLOCK_PLAYER_PLAY_CURRENT with a time limit
- * according to the configuration fade_out_time field.
+ * This function is the callback function for the repeat button. It sends the
+ * engine thread the command ARAS_COMMAND_PLAY_CURRENT.
  *
  * @param   widget  Pointer to the widget
  * @param   event   Pointer to the event
@@ -213,14 +225,12 @@ void aras_gui_player_callback_button_backward(GtkWidget *widget, struct aras_gui
  */
 void aras_gui_player_callback_button_repeat(GtkWidget *widget, struct aras_gui_player_callback *data)
 {
-        if (data->engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD || data->engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT)
-                aras_engine_set_state(data->engine, ARAS_ENGINE_STATE_PLAY_CURRENT, data->configuration->fade_out_time);
+        aras_gui_player_command_send(data, ARAS_COMMAND_PLAY_CURRENT);
 }
 
 /**
- * This function is the callback function for the forward button. It attempts to
- * set the state ARAS_ENGINE_STATE_BLOCK_PLAYER_PLAY_NEXT with a time limit
- * according to the configuration fade_out_time field.
+ * This function is the callback function for the forward button. It sends the
+ * engine thread the command ARAS_COMMAND_PLAY_NEXT.
  *
  * @param   widget  Pointer to the widget
  * @param   event   Pointer to the event
@@ -228,14 +238,12 @@ void aras_gui_player_callback_button_repeat(GtkWidget *widget, struct aras_gui_p
  */
 void aras_gui_player_callback_button_forward(GtkWidget *widget, struct aras_gui_player_callback *data)
 {
-        if (data->engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD || data->engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT)
-                aras_engine_set_state(data->engine, ARAS_ENGINE_STATE_PLAY_NEXT, data->configuration->fade_out_time);
+        aras_gui_player_command_send(data, ARAS_COMMAND_PLAY_NEXT);
 }
 
 /**
- * This function is the callback function for the eject button. It attempts to
- * set the state ARAS_ENGINE_STATE_BLOCK_PLAYER_PLAY_DEFAULT with a time
- * limit according to the configuration fade_out_time field.
+ * This function is the callback function for the eject button. It sends the
+ * engine thread the command ARAS_COMMAND_PLAY_DEFAULT.
  *
  * @param   widget  Pointer to the widget
  * @param   event   Pointer to the event
@@ -243,8 +251,80 @@ void aras_gui_player_callback_button_forward(GtkWidget *widget, struct aras_gui_
  */
 void aras_gui_player_callback_button_eject(GtkWidget *widget, struct aras_gui_player_callback *data)
 {
-        if (data->engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD || data->engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT)
-                aras_engine_set_state(data->engine, ARAS_ENGINE_STATE_PLAY_DEFAULT, data->configuration->fade_out_time);
+        aras_gui_player_command_send(data, ARAS_COMMAND_PLAY_DEFAULT);
+}
+
+/**
+ * This function initializes the status published by the engine thread.
+ *
+ * @param   status  Pointer to the status structure
+ */
+void aras_gui_player_status_init(struct aras_gui_player_status *status)
+{
+        g_mutex_init(&status->mutex);
+        status->engine_state = ARAS_ENGINE_STATE_NULL;
+        status->playlist = 0;
+        status->file_current = 0;
+        status->file_previous = 0;
+        status->file_next = 0;
+        status->file_current_name[0] = '\0';
+        status->file_next_name[0] = '\0';
+        status->position = 0;
+        status->duration = 0;
+        status->player_state = ARAS_PLAYER_STATE_STOP;
+        status->block_current = 0;
+        status->block_next = 0;
+        status->block_current_name[0] = '\0';
+        status->block_next_name[0] = '\0';
+        status->block_current_time = 0;
+        status->block_next_time = 0;
+}
+
+/**
+ * This function publishes the status of the block player engine and player
+ * for the GUI. It is called periodically by the engine thread, the only one
+ * accessing the engine, the player and the current snapshot. The player and
+ * the schedule are queried before locking, so the GUI never waits for them.
+ *
+ * @param   status      Pointer to the status structure
+ * @param   engine      Pointer to the engine structure
+ * @param   player      Pointer to the player structure
+ * @param   schedule    Pointer to the schedule structure
+ */
+void aras_gui_player_status_publish(struct aras_gui_player_status *status, struct aras_engine *engine, struct aras_player *player, struct aras_schedule *schedule)
+{
+        GList *current_node;
+        struct aras_schedule_node *current_schedule_node;
+        struct aras_schedule_node *next_schedule_node;
+        long int position;
+        long int duration;
+        int player_state;
+
+        current_node = engine->playlist_current_node;
+        current_schedule_node = aras_schedule_seek_node_current(schedule, aras_time_current());
+        next_schedule_node = aras_schedule_seek_node_next(schedule, aras_time_current());
+        position = aras_player_get_position(player, player->current_unit);
+        duration = aras_player_get_duration(player, player->current_unit);
+        aras_player_get_state(player, player->current_unit, &player_state);
+
+        g_mutex_lock(&status->mutex);
+        status->engine_state = engine->state;
+        status->playlist = engine->playlist != NULL;
+        status->file_current = current_node != NULL;
+        status->file_previous = current_node != NULL && current_node->prev != NULL;
+        status->file_next = current_node != NULL && current_node->next != NULL;
+        g_strlcpy(status->file_current_name, current_node != NULL ? (char*)current_node->data : "", sizeof(status->file_current_name));
+        g_strlcpy(status->file_next_name, status->file_next ? (char*)current_node->next->data : "", sizeof(status->file_next_name));
+        status->position = position;
+        status->duration = duration;
+        status->player_state = player_state;
+        status->block_current = current_schedule_node != NULL;
+        status->block_next = next_schedule_node != NULL;
+        g_strlcpy(status->block_current_name, current_schedule_node != NULL ? current_schedule_node->block_name : "", sizeof(status->block_current_name));
+        g_strlcpy(status->block_next_name, next_schedule_node != NULL ? next_schedule_node->block_name : "", sizeof(status->block_next_name));
+        status->block_current_time = current_schedule_node != NULL ? current_schedule_node->time : 0;
+        status->block_next_time = next_schedule_node != NULL ? next_schedule_node->time : 0;
+        g_mutex_unlock(&status->mutex);
 }
 
 /**
@@ -279,26 +359,25 @@ void aras_gui_player_update_time(struct aras_gui_player *gui)
  * This function is called periodically and updates the next block label in the
  * block area.
  *
- * @param   gui         Pointer to the gui structure
- * @param   schedule    Pointer to the schedule structure
+ * @param   gui     Pointer to the gui structure
+ * @param   status  Pointer to the published status
  */
-void aras_gui_player_update_block_next_label(struct aras_gui_player *gui, struct aras_schedule *schedule)
+void aras_gui_player_update_block_next_label(struct aras_gui_player *gui, struct aras_gui_player_status *status)
 {
-        struct aras_schedule_node *next_schedule_node;
         long int time;
         int hours;
         int minutes;
         int seconds;
 
-        if ((next_schedule_node = aras_schedule_seek_node_next(schedule, aras_time_current())) == NULL)
+        if (!status->block_next)
                 return;
 
-        time = aras_time_difference(next_schedule_node->time, aras_time_current());
+        time = aras_time_difference(status->block_next_time, aras_time_current());
         aras_time_convert(time, &hours, &minutes, &seconds);
 
         snprintf(gui->block_next_str, sizeof(gui->block_next_str),
                  "Next block\n<span size = \"large\" weight = \"bold\">%s</span>\n<span size = \"large\" weight = \"bold\">%.2d:%.2d:%.2d</span> to start",
-                 next_schedule_node->block_name,
+                 status->block_next_name,
                  hours,
                  minutes,
                  seconds);
@@ -310,27 +389,26 @@ void aras_gui_player_update_block_next_label(struct aras_gui_player *gui, struct
  * This function is called periodically and updates the current block label in
  * the block area.
  *
- * @param   gui         Pointer to the gui structure
- * @param   schedule    Pointer to the schedule structure
+ * @param   gui     Pointer to the gui structure
+ * @param   status  Pointer to the published status
  */
-void aras_gui_player_update_block_current_label(struct aras_gui_player *gui, struct aras_schedule *schedule)
+void aras_gui_player_update_block_current_label(struct aras_gui_player *gui, struct aras_gui_player_status *status)
 {
-        struct aras_schedule_node *current_schedule_node;
         long int time;
         int hours;
         int minutes;
         int seconds;
 
-        if ((current_schedule_node = aras_schedule_seek_node_current(schedule, aras_time_current())) == NULL)
+        if (!status->block_current)
                 return;
 
-        time = aras_time_difference(aras_time_current(), current_schedule_node->time);
+        time = aras_time_difference(aras_time_current(), status->block_current_time);
         aras_time_convert(time, &hours, &minutes, &seconds);
 
         snprintf(gui->block_current_str,
                  sizeof(gui->block_current_str),
                  "Current block\n<span size = \"large\" weight = \"bold\">%s</span>\n<span size = \"large\" weight = \"bold\">%.2d:%.2d:%.2d</span> elapsed",
-                 current_schedule_node->block_name,
+                 status->block_current_name,
                  hours,
                  minutes,
                  seconds);
@@ -342,13 +420,11 @@ void aras_gui_player_update_block_current_label(struct aras_gui_player *gui, str
  * This function is called periodically and updates the progress bar in the
  * block area.
  *
- * @param   gui         Pointer to the gui structure
- * @param   schedule    Pointer to the schedule structure
+ * @param   gui     Pointer to the gui structure
+ * @param   status  Pointer to the published status
  */
-void aras_gui_player_update_block_progress_bar(struct aras_gui_player *gui, struct aras_schedule *schedule)
+void aras_gui_player_update_block_progress_bar(struct aras_gui_player *gui, struct aras_gui_player_status *status)
 {
-        struct aras_schedule_node *current_schedule_node;
-        struct aras_schedule_node *next_schedule_node;
         long int duration;
         long int position;
         int duration_hours;
@@ -359,15 +435,12 @@ void aras_gui_player_update_block_progress_bar(struct aras_gui_player *gui, stru
         int position_seconds;
         float fraction;
 
-        if ((current_schedule_node = aras_schedule_seek_node_current(schedule, aras_time_current())) == NULL)
-                return;
-
-        if ((next_schedule_node = aras_schedule_seek_node_next(schedule, aras_time_current())) == NULL)
+        if (!status->block_current || !status->block_next)
                 return;
 
         /* Get duration and position and compute fraction */
-        duration = aras_time_difference(next_schedule_node->time, current_schedule_node->time);
-        position = aras_time_difference(aras_time_current(), current_schedule_node->time);
+        duration = aras_time_difference(status->block_next_time, status->block_current_time);
+        position = aras_time_difference(aras_time_current(), status->block_current_time);
         fraction = (float)position/(float)duration;
 
         /* Convert duration and position to readable values */
@@ -396,20 +469,15 @@ void aras_gui_player_update_block_progress_bar(struct aras_gui_player *gui, stru
  * the file area.
  *
  * @param   gui     Pointer to the gui structure
- * @param   engine  Pointer to the engine structure
- * @param   player  Pointer to the player structure
+ * @param   status  Pointer to the published status
  */
-void aras_gui_player_update_file_current_label(struct aras_gui_player *gui, struct aras_engine *engine, struct aras_player *player)
+void aras_gui_player_update_file_current_label(struct aras_gui_player *gui, struct aras_gui_player_status *status)
 {
-        long int position;
         int position_hours;
         int position_minutes;
         int position_seconds;
 
-        if (engine == NULL)
-                return;
-
-        if (engine->playlist == NULL) {
+        if (!status->playlist) {
                 snprintf(gui->file_current_str,
                          sizeof(gui->file_current_str),
                          "Waiting for playlist");
@@ -417,7 +485,7 @@ void aras_gui_player_update_file_current_label(struct aras_gui_player *gui, stru
                 return;
         }
 
-        if (engine->playlist_current_node == NULL) {
+        if (!status->file_current) {
                 snprintf(gui->file_current_str,
                          sizeof(gui->file_current_str),
                          "Waiting for playback");
@@ -425,12 +493,11 @@ void aras_gui_player_update_file_current_label(struct aras_gui_player *gui, stru
                 return;
         }
 
-        position = aras_player_get_position(player, player->current_unit);
-        aras_time_convert(position, &position_hours, &position_minutes, &position_seconds);
+        aras_time_convert(status->position, &position_hours, &position_minutes, &position_seconds);
         snprintf(gui->file_current_str,
                  sizeof(gui->file_current_str),
                  "Current file\n%s\n<span size = \"large\" weight = \"bold\">%.2d:%.2d:%.2d</span> elapsed",
-                 (char*)engine->playlist_current_node->data,
+                 status->file_current_name,
                  position_hours,
                  position_minutes,
                  position_seconds);
@@ -442,22 +509,16 @@ void aras_gui_player_update_file_current_label(struct aras_gui_player *gui, stru
  * file area.
  *
  * @param   gui     Pointer to the gui structure
- * @param   engine  Pointer to the engine structure
- * @param   player  Pointer to the player structure
+ * @param   status  Pointer to the published status
  */
-void aras_gui_player_update_file_next_label(struct aras_gui_player *gui, struct aras_engine *engine, struct aras_player *player)
+void aras_gui_player_update_file_next_label(struct aras_gui_player *gui, struct aras_gui_player_status *status)
 {
-        long int position;
-        long int duration;
         long int difference;
         int difference_hours;
         int difference_minutes;
         int difference_seconds;
 
-        if (engine == NULL)
-                return;
-
-        if (engine->playlist == NULL) {
+        if (!status->playlist) {
                 snprintf(gui->file_next_str,
                          sizeof(gui->file_next_str),
                          "Waiting for playlist");
@@ -465,7 +526,7 @@ void aras_gui_player_update_file_next_label(struct aras_gui_player *gui, struct
                 return;
         }
 
-        if (engine->playlist_current_node == NULL) {
+        if (!status->file_current) {
                 snprintf(gui->file_next_str,
                          sizeof(gui->file_next_str),
                          "Waiting for playback");
@@ -473,7 +534,7 @@ void aras_gui_player_update_file_next_label(struct aras_gui_player *gui, struct
                 return;
         }
 
-        if (engine->playlist_current_node->next == NULL) {
+        if (!status->file_next) {
                 snprintf(gui->file_next_str,
                          sizeof(gui->file_next_str),
                          "No more files in this block");
@@ -481,14 +542,13 @@ void aras_gui_player_update_file_next_label(struct aras_gui_player *gui, struct
                 return;
         }
 
-        if ((duration = aras_player_get_duration(player, player->current_unit)) > 0) {
-                position = aras_player_get_position(player, player->current_unit);
-                difference = aras_time_difference(duration, position);
+        if (status->duration > 0) {
+                difference = aras_time_difference(status->duration, status->position);
                 aras_time_convert(difference, &difference_hours, &difference_minutes, &difference_seconds);
                 snprintf(gui->file_next_str,
                          sizeof(gui->file_next_str),
                          "Next file\n%s\n<span size = \"large\" weight = \"bold\">%.2d:%.2d:%.2d</span> to start",
-                         (char*)engine->playlist_current_node->next->data,
+                         status->file_next_name,
                          difference_hours,
                          difference_minutes,
                          difference_seconds);
@@ -496,7 +556,7 @@ void aras_gui_player_update_file_next_label(struct aras_gui_player *gui, struct
                 snprintf(gui->file_next_str,
                          sizeof(gui->file_next_str),
                          "Next file\n%s\n<span size = \"large\" weight = \"bold\">Undefined time</span> to start",
-                         (char*)engine->playlist_current_node->next->data);
+                         status->file_next_name);
         }
         gtk_label_set_markup(GTK_LABEL(gui->file_next_label), gui->file_next_str);
 }
@@ -506,11 +566,10 @@ void aras_gui_player_update_file_next_label(struct aras_gui_player *gui, struct
  * area.
  *
  * @param   gui     Pointer to the gui structure
- * @param   player  Pointer to the player structure
+ * @param   status  Pointer to the published status
  */
-void aras_gui_player_update_file_progress_bar(struct aras_gui_player *gui, struct aras_player *player)
+void aras_gui_player_update_file_progress_bar(struct aras_gui_player *gui, struct aras_gui_player_status *status)
 {
-        int state;
         long int duration;
         long int position;
         float fraction;
@@ -522,9 +581,9 @@ void aras_gui_player_update_file_progress_bar(struct aras_gui_player *gui, struc
         int position_seconds;
 
         /* Check if duration is greater then zero */
-        if ((duration = aras_player_get_duration(player, player->current_unit)) > 0) {
+        if ((duration = status->duration) > 0) {
                 /* Get position and compute fraction */
-                position = aras_player_get_position(player, player->current_unit);
+                position = status->position;
                 fraction = (float)position/(float)duration;
 
                 /* Convert duration and position to readable values */
@@ -543,17 +602,15 @@ void aras_gui_player_update_file_progress_bar(struct aras_gui_player *gui, struc
                          duration_seconds);
         } else {
                 /* If duration is zero and player state is libvlc_Playing then notify streaming */
-                aras_player_get_state(player, player->current_unit, &state);
-                if (state == ARAS_PLAYER_STATE_PLAYING) {
+                if (status->player_state == ARAS_PLAYER_STATE_PLAYING) {
                         /* Write string to be shown in the progress bar */
-                        position = aras_player_get_position(player, player->current_unit);
+                        position = status->position;
                         aras_time_convert(position, &position_hours, &position_minutes, &position_seconds);
                         fraction = 1;
                         snprintf(gui->file_progress_bar_str,
                                  sizeof(gui->file_progress_bar_str),
                                  "Connected to streaming %.2d:%.2d:%.2d", position_hours, position_minutes, position_seconds);
                 } else {
-                        aras_player_get_state(player, player->current_unit, &state);
                         fraction = 0;
                         snprintf(gui->file_progress_bar_str,
                                  sizeof(gui->file_progress_bar_str),
@@ -609,28 +666,32 @@ void aras_gui_player_update_file_progress_bar(struct aras_gui_player *gui, struc
 /**
  * This function is called periodically and updates the buttons.
  *
- * @param   gui             Pointer to the gui structure
- * @param   engine          Pointer to the engine structure
+ * @param   gui     Pointer to the gui structure
+ * @param   status  Pointer to the published status
  */
-void aras_gui_player_update_buttons(struct aras_gui_player *gui, struct aras_engine *engine)
+void aras_gui_player_update_buttons(struct aras_gui_player *gui, struct aras_gui_player_status *status)
 {
-        if (engine->playlist_current_node != NULL) {
-                if ((engine->playlist_current_node->prev != NULL) && ((engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD) || (engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT)))
+        int monitor;
+
+        monitor = (status->engine_state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD) || (status->engine_state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT);
+
+        if (status->file_current) {
+                if (status->file_previous && monitor)
                         gtk_widget_set_sensitive(gui->button_backward, TRUE);
                 else
                         gtk_widget_set_sensitive(gui->button_backward, FALSE);
 
-                if ((engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD) || (engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT))
+                if (monitor)
                         gtk_widget_set_sensitive(gui->button_repeat, TRUE);
                 else
                         gtk_widget_set_sensitive(gui->button_repeat, FALSE);
 
-                if ((engine->playlist_current_node->next != NULL) && ((engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD) || (engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT)))
+                if (status->file_next && monitor)
                         gtk_widget_set_sensitive(gui->button_forward, TRUE);
                 else
                         gtk_widget_set_sensitive(gui->button_forward, FALSE);
 
-                if ((engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_HARD) || (engine->state == ARAS_ENGINE_STATE_MONITOR_SCHEDULE_SOFT))
+                if (monitor)
                         gtk_widget_set_sensitive(gui->button_eject, TRUE);
                 else
                         gtk_widget_set_sensitive(gui->button_eject, FALSE);
@@ -644,24 +705,30 @@ void aras_gui_player_update_buttons(struct aras_gui_player *gui, struct aras_eng
 }
 
 /**
- * This function is called periodically and updates all the widgets.
+ * This function is called periodically and updates all the widgets. The
+ * published status is copied first, so the engine thread only waits for the
+ * copy.
  *
- * @param   gui             Pointer to the gui structure
- * @param   engine          Pointer to the engine structure
- * @param   player          Pointer to the player structure
- * @param   configuration   Pointer to the configuration structure
- * @param   schedule        Pointer to the schedule structure
+ * @param   gui     Pointer to the gui structure
+ * @param   status  Pointer to the published status
  */
-void aras_gui_player_update(struct aras_gui_player *gui, struct aras_engine *engine, struct aras_player *player, struct aras_configuration *configuration, struct aras_schedule *schedule)
+void aras_gui_player_update(struct aras_gui_player *gui, struct aras_gui_player_status *status)
 {
+        struct aras_gui_player_status current;
+
+        /* The mutex in the copy is not used */
+        g_mutex_lock(&status->mutex);
+        current = *status;
+        g_mutex_unlock(&status->mutex);
+
         aras_gui_player_update_time(gui);
-        aras_gui_player_update_block_current_label(gui, schedule);
-        aras_gui_player_update_block_next_label(gui, schedule);
-        aras_gui_player_update_block_progress_bar(gui, schedule);
-        aras_gui_player_update_file_current_label(gui, engine, player);
-        aras_gui_player_update_file_next_label(gui, engine, player);
-        aras_gui_player_update_file_progress_bar(gui, player);
-        aras_gui_player_update_buttons(gui, engine);
+        aras_gui_player_update_block_current_label(gui, &current);
+        aras_gui_player_update_block_next_label(gui, &current);
+        aras_gui_player_update_block_progress_bar(gui, &current);
+        aras_gui_player_update_file_current_label(gui, &current);
+        aras_gui_player_update_file_next_label(gui, &current);
+        aras_gui_player_update_file_progress_bar(gui, &current);
+        aras_gui_player_update_buttons(gui, &current);
 }
 
 /**
@@ -948,16 +1015,18 @@ void aras_gui_player_init_button_eject(struct aras_gui_player *gui, struct aras_
  * calls to callback functions.
  *
  * @param   gui             Pointer to the gui structure
- * @param   engine          Pointer to the engine
- * @param   configuration   Pointer to the configuration structure
+ * @param   status          Pointer to the status published by the engine
+ *                          thread
+ * @param   command_queue   Pointer to the command queue drained by the engine
+ *                          thread, the GUI is its only producer
  */
-void aras_gui_player_init(struct aras_gui_player *gui, struct aras_engine *engine, struct aras_configuration *configuration)
+void aras_gui_player_init(struct aras_gui_player *gui, struct aras_gui_player_status *status, struct aras_command_queue *command_queue)
 {
         static struct aras_gui_player_callback data;
 
         /* Pointers to arguments will remain after the function finishes */
-        data.engine = engine;
-        data.configuration = configuration;
+        data.status = status;
+        data.command_queue = command_queue;
 
         /* Quit dialog counter */
         gui->quit_dialog_count = 0;
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <aras/time.h>
 #include <aras/log.h>
 
 /**
@@ -47,8 +48,8 @@ int aras_log_write(char *file, char *msg)
         struct tm tm;
         char timestamp[ARAS_LOG_TIMESTAMP_MAX];
 
-        /* Get time */
-        t = time(NULL);
+        /* Get time, virtual in simulations */
+        t = (time_t)(aras_time_real() / 1000000);
         localtime_r(&t, &tm);
 
         /* Write timestamp */
@@ -0,0 +1,215 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Main source file for ARAS Benchmark. It measures the CPU time used by a deck
+ * of the block player resampling the audio of a test source to the sample
+ * rate of the audio output, for each resample quality.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <gst/gst.h>
+#include <aras/configuration.h>
+#include <aras/player.h>
+#include <aras/main_benchmark.h>
+
+/**
+ * This function checks the command line syntax
+ *
+ * @param   argc    The number of command line parameters
+ * @param   argv    The pointer to the command line parameters
+ *
+ * @return  0 if the syntax is correct, -1 if the syntax is not correct
+ */
+int aras_main_benchmark_syntax_check(int argc, char **argv)
+{
+        if (argc == 2)
+                return 0;
+        else if (argc == 3 && atoi(argv[2]) > 0)
+                return 0;
+        else
+                return -1;
+}
+
+/**
+ * This function returns the CPU time used by the process.
+ *
+ * @return  The user and system CPU time in seconds
+ */
+double aras_main_benchmark_cpu_time(void)
+{
+        struct rusage usage;
+
+        getrusage(RUSAGE_SELF, &usage);
+
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+/**
+ * This function plays the test source through an audio sink bin of the
+ * block player, writing to /dev/null as fast as possible, and measures the
+ * CPU time used.
+ *
+ * @param   main_benchmark  Pointer to the main benchmark structure
+ * @param   sample_rate     Sample rate of the audio output
+ * @param   quality         Resample quality
+ *
+ * @return  The CPU time in seconds, -1 if error
+ */
+double aras_main_benchmark_run(struct aras_main_benchmark *main_benchmark, int sample_rate, int quality)
+{
+        GstElement *pipeline;
+        GstElement *source;
+        GstCaps *caps;
+        GstBus *bus;
+        GstMessage *message;
+        struct aras_player_sink sink;
+        double start;
+        double cpu;
+
+        /* Create the test source, decoded audio at the source sample rate */
+        pipeline = gst_pipeline_new("benchmark");
+        source = gst_element_factory_make("audiotestsrc", "source");
+        g_object_set(source, "wave", 5, NULL);
+        g_object_set(source, "samplesperbuffer", ARAS_MAIN_BENCHMARK_SAMPLES, NULL);
+        g_object_set(source, "num-buffers", main_benchmark->time * ARAS_MAIN_BENCHMARK_SOURCE_RATE / ARAS_MAIN_BENCHMARK_SAMPLES, NULL);
+
+        /* Create the audio sink bin of a deck */
+        aras_player_init_audio_sink_bin(&sink,
+                                        "benchmark_sink",
+                                        ARAS_CONFIGURATION_MODE_AUDIO_FILE,
+                                        "/dev/null",
+                                        sample_rate,
+                                        main_benchmark->configuration.block_player_channels,
+                                        quality);
+
+        /* Link the elements */
+        gst_bin_add_many(GST_BIN(pipeline), source, sink.bin, NULL);
+        caps = gst_caps_new_simple("audio/x-raw",
+                                   "format",
+                                   G_TYPE_STRING,
+                                   "S16LE",
+                                   "channels",
+                                   G_TYPE_INT,
+                                   main_benchmark->configuration.block_player_channels,
+                                   "rate",
+                                   G_TYPE_INT,
+                                   ARAS_MAIN_BENCHMARK_SOURCE_RATE,
+                                   NULL);
+        if (gst_element_link_filtered(source, sink.bin, caps) == FALSE) {
+                gst_caps_unref(caps);
+                gst_object_unref(pipeline);
+                return -1;
+        }
+        gst_caps_unref(caps);
+
+        /* Run the pipeline until the end of the test source */
+        start = aras_main_benchmark_cpu_time();
+        gst_element_set_state(pipeline, GST_STATE_PLAYING);
+        bus = gst_element_get_bus(pipeline);
+        message = gst_bus_timed_pop_filtered(bus, GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+        cpu = aras_main_benchmark_cpu_time() - start;
+        if (message == NULL || GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR)
+                cpu = -1;
+
+        /* Free the pipeline */
+        if (message != NULL)
+                gst_message_unref(message);
+        gst_object_unref(bus);
+        gst_element_set_state(pipeline, GST_STATE_NULL);
+        gst_object_unref(pipeline);
+
+        return cpu;
+}
+
+/**
+ * This function prints the CPU usage of a deck for a benchmark run.
+ *
+ * @param   main_benchmark  Pointer to the main benchmark structure
+ * @param   label           Label of the run
+ * @param   cpu             CPU time of the run in seconds
+ */
+void aras_main_benchmark_print(struct aras_main_benchmark *main_benchmark, char *label, double cpu)
+{
+        if (cpu < 0)
+                printf("%-12s  error\n", label);
+        else
+                printf("%-12s  %10.2f  %10.3f%%\n", label, cpu * 1000 / main_benchmark->time, cpu * 100 / main_benchmark->time);
+}
+
+/**
+ * The main function for the ARAS Radio Automation System Benchmark
+ *
+ * @param   argc    The number of command line parameters
+ * @param   argv    The pointer to the command line parameters
+ */
+int main(int argc, char **argv)
+{
+        /* The main data structure */
+        struct aras_main_benchmark main_benchmark;
+
+        char label[16];
+        int quality;
+
+        /* Check syntax */
+        if (aras_main_benchmark_syntax_check(argc, argv) == -1) {
+                fprintf(stderr, "aras: Incorrect syntax\n");
+                exit(-1);
+        }
+
+        /* Define the configuration file and the audio time of each run */
+        main_benchmark.configuration_file = argv[1];
+        main_benchmark.time = argc == 3 ? atoi(argv[2]) : ARAS_MAIN_BENCHMARK_TIME;
+
+        /* Load configuration */
+        aras_configuration_init(&main_benchmark.configuration);
+        if (aras_configuration_load_file(&main_benchmark.configuration, main_benchmark.configuration_file) == -1) {
+                fprintf(stderr, "aras: unable to open configuration file ""%s""\n", main_benchmark.configuration_file);
+                exit(-1);
+        }
+
+        /* Initialize GStreamer */
+        gst_init(NULL, NULL);
+
+        printf("Source %d Hz, output %d Hz, %d channels, %d seconds per run\n\n",
+               ARAS_MAIN_BENCHMARK_SOURCE_RATE,
+               main_benchmark.configuration.block_player_sample_rate,
+               main_benchmark.configuration.block_player_channels,
+               main_benchmark.time);
+        printf("%-12s  %10s  %11s\n", "Quality", "CPU ms/s", "CPU/deck");
+
+        /* Baseline without sample rate conversion */
+        aras_main_benchmark_print(&main_benchmark, "passthrough", aras_main_benchmark_run(&main_benchmark, ARAS_MAIN_BENCHMARK_SOURCE_RATE, ARAS_MAIN_BENCHMARK_QUALITY_MIN));
+
+        /* Sample rate conversion for each quality */
+        for (quality = ARAS_MAIN_BENCHMARK_QUALITY_MIN; quality <= ARAS_MAIN_BENCHMARK_QUALITY_MAX; quality++) {
+                snprintf(label, sizeof(label), "%d", quality);
+                aras_main_benchmark_print(&main_benchmark, label, aras_main_benchmark_run(&main_benchmark, main_benchmark.configuration.block_player_sample_rate, quality));
+        }
+
+        exit(0);
+}
@@ -23,17 +23,26 @@
  *
  * @section DESCRIPTION
  *
- * Main source file for ARAS Daemon.
+ * Main source file for ARAS Daemon. The daemon runs a channel for each
+ * configuration file. Each channel has its own players, engines and main
+ * context, run by its own thread, so that a busy channel does not delay the
+ * others. The channels share the media index, whose watch runs in the main
+ * thread. Each channel may be controlled through its own control socket.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
+#include <string.h>
 #include <glib.h>
 #include <aras/configuration.h>
 #include <aras/schedule.h>
 #include <aras/block.h>
+#include <aras/snapshot.h>
+#include <aras/media.h>
 #include <aras/engine.h>
+#include <aras/status.h>
+#include <aras/command.h>
+#include <aras/control.h>
 #include <aras/main_daemon.h>
 
 /**
@@ -46,16 +55,171 @@
  */
 int aras_main_daemon_syntax_check(int argc, char **argv)
 {
-        if (argc == 2)
+        if (argc >= 2)
                 return 0;
         else
                 return -1;
 }
 
+/**
+ * This function adds a timeout to the main context of a channel.
+ *
+ * @param   main_daemon Pointer to the main daemon structure
+ * @param   priority    The priority of the timeout
+ * @param   interval    The time between calls in miliseconds
+ * @param   function    The function to call, with the main daemon structure as
+ *                      data
+ *
+ * @return  The identifier of the timeout
+ */
+guint aras_main_daemon_add_timeout(struct aras_main_daemon *main_daemon, gint priority, guint interval, GSourceFunc function)
+{
+        GSource *source;
+        guint id;
+
+        source = g_timeout_source_new(interval);
+        g_source_set_priority(source, priority);
+        g_source_set_callback(source, function, main_daemon, NULL);
+        id = g_source_attach(source, main_daemon->context);
+        g_source_unref(source);
+
+        return id;
+}
+
+/**
+ * This function is the callback function for engines in event mode. It calls
+ * the functions managing the engines and sets a single timeout for the
+ * earliest time at which an engine has to run again.
+ *
+ * @param   main_daemon Pointer to the main daemon structure
+ *
+ * @return  This function always returns FALSE
+ */
+int aras_main_daemon_callback_engine_event(struct aras_main_daemon *main_daemon)
+{
+        struct aras_snapshot *snapshot;
+        long int timeout;
+        long int timeout_time_signal;
+
+        main_daemon->engine_source = 0;
+        snapshot = aras_snapshot_get(&main_daemon->snapshot);
+
+        /* Run the engines, state changes do not wake them meanwhile */
+        main_daemon->engine_running = 1;
+        aras_engine_schedule(&main_daemon->engine_block_player, &main_daemon->block_player, snapshot->configuration, snapshot->schedule, snapshot->block);
+        aras_engine_time_signal(&main_daemon->engine_time_signal_player, &main_daemon->time_signal_player, snapshot->configuration, snapshot->block);
+        main_daemon->engine_running = 0;
+
+        /* Sleep until the next engine deadline */
+        timeout = aras_engine_schedule_timeout(&main_daemon->engine_block_player, &main_daemon->block_player, snapshot->configuration, snapshot->schedule);
+        timeout_time_signal = aras_engine_time_signal_timeout(&main_daemon->engine_time_signal_player, &main_daemon->time_signal_player, snapshot->configuration);
+        if (timeout_time_signal < timeout)
+                timeout = timeout_time_signal;
+        aras_snapshot_unref(snapshot);
+        main_daemon->engine_source = aras_main_daemon_add_timeout(main_daemon, G_PRIORITY_HIGH, timeout, (GSourceFunc)aras_main_daemon_callback_engine_event);
+
+        return FALSE;
+}
+
+/**
+ * This function is the wake up function for engines in event mode. It is
+ * called by the players and the engines when an event requires the engines to
+ * run before the current timeout expires.
+ *
+ * @param   data    Pointer to the main daemon structure
+ */
+void aras_main_daemon_callback_wake(void *data)
+{
+        struct aras_main_daemon *main_daemon;
+
+        main_daemon = (struct aras_main_daemon*)data;
+
+        /* The engines are already running */
+        if (main_daemon->engine_running)
+                return;
+
+        /* Replace the current timeout */
+        if (main_daemon->engine_source != 0)
+                g_source_destroy(g_main_context_find_source_by_id(main_daemon->context, main_daemon->engine_source));
+        main_daemon->engine_source = aras_main_daemon_add_timeout(main_daemon, G_PRIORITY_HIGH, 0, (GSourceFunc)aras_main_daemon_callback_engine_event);
+}
+
+/**
+ * This function is the callback function for the status segment. It is called
+ * periodically and it publishes the status of the engines in the shared memory
+ * segment.
+ *
+ * @param   main_daemon Pointer to the main daemon structure
+ *
+ * @return  This function always returns TRUE
+ */
+int aras_main_daemon_callback_status_segment(struct aras_main_daemon *main_daemon)
+{
+        struct aras_snapshot *snapshot;
+        struct aras_status_segment segment;
+
+        memset(&segment, 0, sizeof(segment));
+        snapshot = aras_snapshot_get(&main_daemon->snapshot);
+        aras_status_set_blocks(&segment, snapshot->schedule);
+        aras_snapshot_unref(snapshot);
+        aras_engine_status(&main_daemon->engine_block_player, &main_daemon->block_player, &segment.block_player);
+        aras_engine_status(&main_daemon->engine_time_signal_player, &main_daemon->time_signal_player, &segment.time_signal_player);
+        aras_status_publish(&main_daemon->status_segment, &segment);
+
+        return TRUE;
+}
+
+/**
+ * This function is the callback function for the reload command of the control
+ * socket. It starts reloading the configuration, schedule and block files in a
+ * new snapshot.
+ *
+ * @param   data    Pointer to the main daemon structure
+ */
+void aras_main_daemon_callback_reload(void *data)
+{
+        struct aras_main_daemon *main_daemon;
+
+        main_daemon = (struct aras_main_daemon*)data;
+        aras_snapshot_reload_start(&main_daemon->reload, ARAS_SNAPSHOT_FILE_ALL);
+}
+
+/**
+ * This function is the event function of the block player engine. It reports
+ * the event to the clients of the control socket.
+ *
+ * @param   data        Pointer to the main daemon structure
+ * @param   type        The type of event
+ * @param   argument    The argument of the event
+ */
+void aras_main_daemon_callback_event_block_player(void *data, char *type, char *argument)
+{
+        struct aras_main_daemon *main_daemon;
+
+        main_daemon = (struct aras_main_daemon*)data;
+        aras_control_event(&main_daemon->control, "block_player", type, argument);
+}
+
+/**
+ * This function is the event function of the time signal player engine. It
+ * reports the event to the clients of the control socket.
+ *
+ * @param   data        Pointer to the main daemon structure
+ * @param   type        The type of event
+ * @param   argument    The argument of the event
+ */
+void aras_main_daemon_callback_event_time_signal_player(void *data, char *type, char *argument)
+{
+        struct aras_main_daemon *main_daemon;
+
+        main_daemon = (struct aras_main_daemon*)data;
+        aras_control_event(&main_daemon->control, "time_signal_player", type, argument);
+}
+
 /**
  * This function is the callback function for configuration. It is called
- * periodically and it calls the functions responsible for updating the
- * configuration.
+ * periodically and it starts reloading the configuration, schedule and block
+ * files in a new snapshot.
  *
  * @param   main_daemon Pointer to the main daemon structure
  *
@@ -69,18 +233,8 @@ int aras_main_daemon_callback_configuration(struct aras_main_daemon *main_daemon
         if (main_daemon->configuration_file == NULL)
                 return FALSE;
 
-        /* Update data from configuration file */
-        aras_configuration_load_file(&main_daemon->configuration, main_daemon->configuration_file);
-
-        /* Update data from schedule file */
-        aras_schedule_list_free(&main_daemon->schedule);
-        aras_schedule_init(&main_daemon->schedule);
-        aras_schedule_load_file(&main_daemon->schedule, main_daemon->configuration.schedule_file);
-
-        /* Update data from block file */
-        aras_block_list_free(&main_daemon->block);
-        aras_block_init(&main_daemon->block);
-        aras_block_load_file(&main_daemon->block, main_daemon->configuration.block_file);
+        /* Load the files in a new snapshot without blocking the main loop */
+        aras_snapshot_reload_start(&main_daemon->reload, ARAS_SNAPSHOT_FILE_ALL);
 
         return TRUE;
 }
@@ -95,59 +249,167 @@ int aras_main_daemon_callback_configuration(struct aras_main_daemon *main_daemon
  */
 int aras_main_daemon_callback_engine(struct aras_main_daemon *main_daemon)
 {
-        aras_engine_schedule(&main_daemon->engine_block_player, &main_daemon->block_player, &main_daemon->configuration, &main_daemon->schedule, &main_daemon->block);
-        aras_engine_time_signal(&main_daemon->engine_time_signal_player, &main_daemon->time_signal_player, &main_daemon->configuration, &main_daemon->block);
+        struct aras_snapshot *snapshot;
+
+        snapshot = aras_snapshot_get(&main_daemon->snapshot);
+        aras_engine_schedule(&main_daemon->engine_block_player, &main_daemon->block_player, snapshot->configuration, snapshot->schedule, snapshot->block);
+        aras_engine_time_signal(&main_daemon->engine_time_signal_player, &main_daemon->time_signal_player, snapshot->configuration, snapshot->block);
+        aras_snapshot_unref(snapshot);
 
         return TRUE;
 }
 
 /**
- * This function initializes a main daemon structure.
+ * This function loads the configuration, schedule and block files of a
+ * channel in a new snapshot.
  *
  * @param   main_daemon Pointer to the main daemon structure
  *
  * @return  0 if success, -1 if error
  */
-int aras_main_daemon_init(struct aras_main_daemon *main_daemon)
+int aras_main_daemon_load(struct aras_main_daemon *main_daemon)
 {
-        struct timeval time;
-
-        /* Initialize the pseudorandom number generator */
-        gettimeofday(&time, NULL);
-        srand((time.tv_sec * 1000) + (time.tv_usec / 1000));
-
-        /* Initialize and load configuration */
-        aras_configuration_init(&main_daemon->configuration);
-        if (aras_configuration_load_file(&main_daemon->configuration, main_daemon->configuration_file) == -1) {
+        /* Initialize the snapshot and load configuration */
+        main_daemon->snapshot = aras_snapshot_new();
+        if (aras_configuration_load_file(main_daemon->snapshot->configuration, main_daemon->configuration_file) == -1) {
                 fprintf(stderr, "aras: unable to open configuration file ""%s""\n", main_daemon->configuration_file);
                 return -1;
         }
 
-        /* Initialize and load schedule */
-        aras_schedule_init(&main_daemon->schedule);
-        if (aras_schedule_load_file(&main_daemon->schedule, main_daemon->configuration.schedule_file) == -1) {
-                fprintf(stderr, "aras: unable to open schedule file ""%s""\n", main_daemon->configuration.schedule_file);
+        /* Load schedule */
+        if (aras_schedule_load_file(main_daemon->snapshot->schedule, main_daemon->snapshot->configuration->schedule_file) == -1) {
+                fprintf(stderr, "aras: unable to open schedule file ""%s""\n", main_daemon->snapshot->configuration->schedule_file);
                 return -1;
         }
 
-        /* Initialize and load block */
-        aras_block_init(&main_daemon->block);
-        if (aras_block_load_file(&main_daemon->block, main_daemon->configuration.block_file) == -1) {
-                fprintf(stderr, "aras: unable to open block file ""%s""\n", main_daemon->configuration.block_file);
+        /* Load block */
+        if (aras_block_load_file(main_daemon->snapshot->block, main_daemon->snapshot->configuration->block_file) == -1) {
+                fprintf(stderr, "aras: unable to open block file ""%s""\n", main_daemon->snapshot->configuration->block_file);
                 return -1;
         }
 
+        /* Link the schedule to the block */
+        aras_schedule_resolve(main_daemon->snapshot->schedule, main_daemon->snapshot->block, main_daemon->snapshot->configuration->log_file);
+
+        return 0;
+}
+
+/**
+ * This function initializes a main daemon structure, once its files are
+ * loaded. The players and the snapshot reload are bound to the thread default
+ * main context, which must be the main context of the channel.
+ *
+ * @param   main_daemon Pointer to the main daemon structure
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_main_daemon_init(struct aras_main_daemon *main_daemon)
+{
+        /* Index the directories of random blocks */
+        aras_media_scan_block(main_daemon->snapshot->block);
+
+        /* Initialize the snapshot reload */
+        aras_snapshot_reload_init(&main_daemon->reload, &main_daemon->snapshot, main_daemon->configuration_file);
+
         /* Initialize players */
-        aras_player_init_block_player(&main_daemon->block_player, &main_daemon->configuration);
-        aras_player_init_time_signal_player(&main_daemon->time_signal_player, &main_daemon->configuration);
+        if (aras_player_init_block_player(&main_daemon->block_player, main_daemon->snapshot->configuration) == -1 ||
+            aras_player_init_time_signal_player(&main_daemon->time_signal_player, main_daemon->snapshot->configuration) == -1)
+                return -1;
 
         /* Initialize engines */
         aras_engine_init(&main_daemon->engine_block_player);
         aras_engine_init(&main_daemon->engine_time_signal_player);
+        aras_engine_set_random_seed(&main_daemon->engine_block_player, main_daemon->snapshot->configuration->random_seed);
+        aras_engine_set_random_seed(&main_daemon->engine_time_signal_player, main_daemon->snapshot->configuration->random_seed);
+
+        /* Publish the status of the engines for external monitors */
+        main_daemon->status_segment.segment = NULL;
+        if (main_daemon->snapshot->configuration->status_segment[0] != '\0' &&
+            aras_status_open(&main_daemon->status_segment, main_daemon->snapshot->configuration->status_segment) == -1)
+                fprintf(stderr, "aras: unable to open status segment ""%s""\n", main_daemon->snapshot->configuration->status_segment);
+
+        /* Accept commands and report events on the control socket */
+        aras_command_queue_init(&main_daemon->command_queue);
+        aras_engine_set_command_queue(&main_daemon->engine_block_player, &main_daemon->command_queue);
+        main_daemon->control.fd = -1;
+        if (main_daemon->snapshot->configuration->control_socket[0] != '\0') {
+                if (aras_control_init(&main_daemon->control, main_daemon->snapshot->configuration->control_socket, &main_daemon->command_queue) == -1) {
+                        fprintf(stderr, "aras: unable to open control socket ""%s""\n", main_daemon->snapshot->configuration->control_socket);
+                } else {
+                        aras_control_set_callback_reload(&main_daemon->control, aras_main_daemon_callback_reload, main_daemon);
+                        aras_engine_set_callback_event(&main_daemon->engine_block_player, aras_main_daemon_callback_event_block_player, main_daemon);
+                        aras_engine_set_callback_event(&main_daemon->engine_time_signal_player, aras_main_daemon_callback_event_time_signal_player, main_daemon);
+                }
+        }
+
+        /* Wake up the engines on player events and state changes in event mode */
+        main_daemon->engine_mode = main_daemon->snapshot->configuration->engine_mode;
+        main_daemon->engine_source = 0;
+        main_daemon->engine_running = 0;
+        if (main_daemon->engine_mode == ARAS_CONFIGURATION_MODE_ENGINE_EVENT) {
+                aras_player_set_callback_wake(&main_daemon->block_player, aras_main_daemon_callback_wake, main_daemon);
+                aras_player_set_callback_wake(&main_daemon->time_signal_player, aras_main_daemon_callback_wake, main_daemon);
+                aras_engine_set_callback_wake(&main_daemon->engine_block_player, aras_main_daemon_callback_wake, main_daemon);
+                aras_engine_set_callback_wake(&main_daemon->engine_time_signal_player, aras_main_daemon_callback_wake, main_daemon);
+                aras_snapshot_reload_set_callback_done(&main_daemon->reload, aras_main_daemon_callback_wake, main_daemon);
+                aras_command_queue_set_callback_wake(&main_daemon->command_queue, aras_main_daemon_callback_wake, main_daemon);
+        }
 
         return 0;
 }
 
+/**
+ * This function is the body of the thread of a channel. It runs the main loop
+ * of the channel.
+ *
+ * @param   data    Pointer to the main daemon structure
+ *
+ * @return  This function always returns NULL
+ */
+gpointer aras_main_daemon_thread(gpointer data)
+{
+        struct aras_main_daemon *main_daemon;
+
+        main_daemon = (struct aras_main_daemon*)data;
+
+        g_main_context_push_thread_default(main_daemon->context);
+        g_main_loop_run(main_daemon->main_loop);
+        g_main_context_pop_thread_default(main_daemon->context);
+
+        return NULL;
+}
+
+/**
+ * This function sets the callback functions of a channel in its main context
+ * and starts the thread of the channel.
+ *
+ * @param   main_daemon Pointer to the main daemon structure
+ */
+void aras_main_daemon_start(struct aras_main_daemon *main_daemon)
+{
+        struct aras_configuration *configuration;
+
+        configuration = main_daemon->snapshot->configuration;
+
+        /* Set the callback functions */
+        if (configuration->configuration_mode != ARAS_CONFIGURATION_MODE_CONFIGURATION_WATCH)
+                aras_main_daemon_add_timeout(main_daemon, G_PRIORITY_DEFAULT, configuration->configuration_period, (GSourceFunc)aras_main_daemon_callback_configuration);
+        else if (aras_snapshot_reload_watch(&main_daemon->reload) == -1) {
+                fprintf(stderr, "aras: unable to watch configuration files, polling\n");
+                aras_main_daemon_add_timeout(main_daemon, G_PRIORITY_DEFAULT, configuration->configuration_period, (GSourceFunc)aras_main_daemon_callback_configuration);
+        }
+        if (main_daemon->engine_mode == ARAS_CONFIGURATION_MODE_ENGINE_EVENT)
+                main_daemon->engine_source = aras_main_daemon_add_timeout(main_daemon, G_PRIORITY_HIGH, 0, (GSourceFunc)aras_main_daemon_callback_engine_event);
+        else
+                aras_main_daemon_add_timeout(main_daemon, G_PRIORITY_DEFAULT, configuration->engine_period, (GSourceFunc)aras_main_daemon_callback_engine);
+        if (main_daemon->status_segment.segment != NULL)
+                aras_main_daemon_add_timeout(main_daemon, G_PRIORITY_DEFAULT_IDLE, configuration->status_period, (GSourceFunc)aras_main_daemon_callback_status_segment);
+
+        /* Run the main loop of the channel in its own thread */
+        main_daemon->main_loop = g_main_loop_new(main_daemon->context, FALSE);
+        main_daemon->thread = g_thread_new("aras-channel", aras_main_daemon_thread, main_daemon);
+}
+
 /**
  * The main function for the ARAS Radio Automation System Daemon
  *
@@ -156,8 +418,13 @@ int aras_main_daemon_init(struct aras_main_daemon *main_daemon)
  */
 int main(int argc, char **argv)
 {
-        /* The main data structure */
-        struct aras_main_daemon main_daemon;
+        /* The channels, one for each configuration file */
+        struct aras_main_daemon *main_daemon;
+        int channels;
+        int channel;
+        int started;
+        int result;
+        int media;
 
         /* The main loop */
         GMainLoop *main_loop;
@@ -168,11 +435,37 @@ int main(int argc, char **argv)
                 exit(-1);
         }
 
-        /* Define the configuration file */
-        main_daemon.configuration_file = argv[1];
+        /* Initialize the channels, a channel failing to start does not stop the others */
+        channels = argc - 1;
+        main_daemon = g_new0(struct aras_main_daemon, channels);
+        started = 0;
+        media = 0;
+        for (channel = 0; channel < channels; channel++) {
+                main_daemon[channel].channel = channel;
+                main_daemon[channel].configuration_file = argv[channel + 1];
+                main_daemon[channel].context = g_main_context_new();
+
+                g_main_context_push_thread_default(main_daemon[channel].context);
+                result = aras_main_daemon_load(&main_daemon[channel]);
+                if (result == 0 && !media) {
+                        /* The media index of the first channel is shared by all of them */
+                        aras_media_init(main_daemon[channel].snapshot->configuration->media_index_file);
+                        media = 1;
+                }
+                if (result == 0)
+                        result = aras_main_daemon_init(&main_daemon[channel]);
+                g_main_context_pop_thread_default(main_daemon[channel].context);
+
+                if (result == -1) {
+                        fprintf(stderr, "aras: Initialization error in ""%s""\n", main_daemon[channel].configuration_file);
+                        continue;
+                }
 
-        /* Main initialization */
-        if (aras_main_daemon_init(&main_daemon) == -1) {
+                aras_main_daemon_start(&main_daemon[channel]);
+                started++;
+        }
+
+        if (started == 0) {
                 fprintf(stderr, "aras: Initialization error\n");
                 exit(-1);
         }
@@ -180,9 +473,9 @@ int main(int argc, char **argv)
         /* Create the main loop */
         main_loop = g_main_loop_new(NULL, FALSE);
 
-        /* Set the callback functions */
-        g_timeout_add(main_daemon.configuration.configuration_period, (GSourceFunc)aras_main_daemon_callback_configuration, &main_daemon);
-        g_timeout_add(main_daemon.configuration.engine_period, (GSourceFunc)aras_main_daemon_callback_engine, &main_daemon);
+        /* Watch the media directories, they are checked in the background otherwise */
+        if (aras_media_watch() == -1)
+                fprintf(stderr, "aras: unable to watch media directories\n");
 
         /* Run the main loop */
         g_main_loop_run(main_loop);
@@ -23,17 +23,24 @@
  *
  * @section DESCRIPTION
  *
- * Main source file for ARAS Player.
+ * Main source file for ARAS Player. The engines run in a thread with its own
+ * main context, so that their timing does not depend on the GUI. The GUI runs
+ * in the main thread, reads the status published by the engine thread and
+ * sends commands to it through a lock free command queue.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
+#include <string.h>
 #include <glib.h>
 #include <aras/configuration.h>
 #include <aras/schedule.h>
 #include <aras/block.h>
+#include <aras/snapshot.h>
+#include <aras/media.h>
 #include <aras/engine.h>
+#include <aras/status.h>
+#include <aras/command.h>
 #include <aras/gui_player.h>
 #include <aras/main_player.h>
 
@@ -53,10 +60,145 @@ int aras_main_player_syntax_check(int argc, char **argv)
                 return -1;
 }
 
+/**
+ * This function adds a timeout to the main context of the engine thread.
+ *
+ * @param   main_player Pointer to the ARAS Player main structure
+ * @param   priority    The priority of the timeout
+ * @param   interval    The time between calls in miliseconds
+ * @param   function    The function to call, with the ARAS Player main
+ *                      structure as data
+ *
+ * @return  The identifier of the timeout
+ */
+guint aras_main_player_add_timeout(struct aras_main_player *main_player, gint priority, guint interval, GSourceFunc function)
+{
+        GSource *source;
+        guint id;
+
+        source = g_timeout_source_new(interval);
+        g_source_set_priority(source, priority);
+        g_source_set_callback(source, function, main_player, NULL);
+        id = g_source_attach(source, main_player->context);
+        g_source_unref(source);
+
+        return id;
+}
+
+/**
+ * This function is the callback function for engines in event mode. It calls
+ * the functions managing the engines and sets a single timeout for the
+ * earliest time at which an engine has to run again.
+ *
+ * @param   main_player Pointer to the ARAS Player main structure
+ *
+ * @return  This function always returns FALSE
+ */
+int aras_main_player_callback_engine_event(struct aras_main_player *main_player)
+{
+        struct aras_snapshot *snapshot;
+        long int timeout;
+        long int timeout_time_signal;
+
+        main_player->engine_source = 0;
+        snapshot = aras_snapshot_get(&main_player->snapshot);
+
+        /* Run the engines, state changes do not wake them meanwhile */
+        main_player->engine_running = 1;
+        aras_engine_schedule(&main_player->engine_block_player, &main_player->block_player, snapshot->configuration, snapshot->schedule, snapshot->block);
+        aras_engine_time_signal(&main_player->engine_time_signal_player, &main_player->time_signal_player, snapshot->configuration, snapshot->block);
+        main_player->engine_running = 0;
+
+        /* Sleep until the next engine deadline */
+        timeout = aras_engine_schedule_timeout(&main_player->engine_block_player, &main_player->block_player, snapshot->configuration, snapshot->schedule);
+        timeout_time_signal = aras_engine_time_signal_timeout(&main_player->engine_time_signal_player, &main_player->time_signal_player, snapshot->configuration);
+        if (timeout_time_signal < timeout)
+                timeout = timeout_time_signal;
+        aras_snapshot_unref(snapshot);
+        main_player->engine_source = aras_main_player_add_timeout(main_player, G_PRIORITY_HIGH, timeout, (GSourceFunc)aras_main_player_callback_engine_event);
+
+        return FALSE;
+}
+
+/**
+ * This function is the wake up function for engines in event mode. It is
+ * called by the players and the engines when an event requires the engines to
+ * run before the current timeout expires.
+ *
+ * @param   data    Pointer to the ARAS Player main structure
+ */
+void aras_main_player_callback_wake(void *data)
+{
+        struct aras_main_player *main_player;
+
+        main_player = (struct aras_main_player*)data;
+
+        /* The engines are already running */
+        if (main_player->engine_running)
+                return;
+
+        /* Replace the current timeout */
+        if (main_player->engine_source != 0)
+                g_source_destroy(g_main_context_find_source_by_id(main_player->context, main_player->engine_source));
+        main_player->engine_source = aras_main_player_add_timeout(main_player, G_PRIORITY_HIGH, 0, (GSourceFunc)aras_main_player_callback_engine_event);
+}
+
+/**
+ * This function wakes up the engines in the engine thread, once a command has
+ * been pushed to the command queue.
+ *
+ * @param   main_player Pointer to the ARAS Player main structure
+ *
+ * @return  This function always returns FALSE
+ */
+int aras_main_player_callback_command_wake(struct aras_main_player *main_player)
+{
+        aras_main_player_callback_wake(main_player);
+
+        return FALSE;
+}
+
+/**
+ * This function is the wake up function of the command queue for engines in
+ * event mode. It is called by the GUI thread whenever a command is pushed, so
+ * the engines are woken up in the engine thread.
+ *
+ * @param   data    Pointer to the ARAS Player main structure
+ */
+void aras_main_player_callback_command(void *data)
+{
+        aras_main_player_add_timeout((struct aras_main_player*)data, G_PRIORITY_HIGH, 0, (GSourceFunc)aras_main_player_callback_command_wake);
+}
+
+/**
+ * This function is the callback function for the status segment. It is called
+ * periodically and it publishes the status of the engines in the shared memory
+ * segment.
+ *
+ * @param   main_player Pointer to the ARAS Player main structure
+ *
+ * @return  This function always returns TRUE
+ */
+int aras_main_player_callback_status_segment(struct aras_main_player *main_player)
+{
+        struct aras_snapshot *snapshot;
+        struct aras_status_segment segment;
+
+        memset(&segment, 0, sizeof(segment));
+        snapshot = aras_snapshot_get(&main_player->snapshot);
+        aras_status_set_blocks(&segment, snapshot->schedule);
+        aras_snapshot_unref(snapshot);
+        aras_engine_status(&main_player->engine_block_player, &main_player->block_player, &segment.block_player);
+        aras_engine_status(&main_player->engine_time_signal_player, &main_player->time_signal_player, &segment.time_signal_player);
+        aras_status_publish(&main_player->status_segment, &segment);
+
+        return TRUE;
+}
+
 /**
  * This function is the callback function for configuration. It is called
- * periodically and it calls the functions responsible for updating the
- * configuration.
+ * periodically and it starts reloading the configuration, schedule and block
+ * files in a new snapshot.
  *
  * @param   main_player Pointer to the ARAS Player main structure
  *
@@ -70,18 +212,8 @@ int aras_main_player_callback_configuration(struct aras_main_player *main_player
         if (main_player->configuration_file == NULL)
                 return FALSE;
 
-        /* Update data from configuration file */
-        aras_configuration_load_file(&main_player->configuration, main_player->configuration_file);
-
-        /* Update data from schedule file */
-        aras_schedule_list_free(&main_player->schedule);
-        aras_schedule_init(&main_player->schedule);
-        aras_schedule_load_file(&main_player->schedule, main_player->configuration.schedule_file);
-
-        /* Update data from block file */
-        aras_block_list_free(&main_player->block);
-        aras_block_init(&main_player->block);
-        aras_block_load_file(&main_player->block, main_player->configuration.block_file);
+        /* Load the files in a new snapshot without blocking the main loop */
+        aras_snapshot_reload_start(&main_player->reload, ARAS_SNAPSHOT_FILE_ALL);
 
         return TRUE;
 }
@@ -96,14 +228,39 @@ int aras_main_player_callback_configuration(struct aras_main_player *main_player
  */
 int aras_main_player_callback_engine(struct aras_main_player *main_player)
 {
-        aras_engine_schedule(&main_player->engine_block_player, &main_player->block_player, &main_player->configuration, &main_player->schedule, &main_player->block);
-        aras_engine_time_signal(&main_player->engine_time_signal_player, &main_player->time_signal_player, &main_player->configuration, &main_player->block);
+        struct aras_snapshot *snapshot;
+
+        snapshot = aras_snapshot_get(&main_player->snapshot);
+        aras_engine_schedule(&main_player->engine_block_player, &main_player->block_player, snapshot->configuration, snapshot->schedule, snapshot->block);
+        aras_engine_time_signal(&main_player->engine_time_signal_player, &main_player->time_signal_player, snapshot->configuration, snapshot->block);
+        aras_snapshot_unref(snapshot);
+        return TRUE;
+}
+
+/**
+ * This function is the callback function for the status. It is called
+ * periodically by the engine thread and it publishes the status of the block
+ * player for the GUI.
+ *
+ * @param   main_player Pointer to the ARAS Player main structure
+ *
+ * @return  This function always returns TRUE
+ */
+int aras_main_player_callback_status(struct aras_main_player *main_player)
+{
+        struct aras_snapshot *snapshot;
+
+        snapshot = aras_snapshot_get(&main_player->snapshot);
+        aras_gui_player_status_publish(&main_player->status, &main_player->engine_block_player, &main_player->block_player, snapshot->schedule);
+        aras_snapshot_unref(snapshot);
+
         return TRUE;
 }
 
 /**
  * This function is the callback function for GUI. It is called periodically and
- * it calls the function managing the GUI.
+ * it calls the function managing the GUI, which only reads the status published
+ * by the engine thread and never the snapshot, retired by the engine thread.
  *
  * @param   main_player Pointer to the ARAS Player main structure
  *
@@ -111,12 +268,13 @@ int aras_main_player_callback_engine(struct aras_main_player *main_player)
  */
 int aras_main_player_callback_gui(struct aras_main_player *main_player)
 {
-        aras_gui_player_update(&main_player->gui, &main_player->engine_block_player, &main_player->block_player, &main_player->configuration, &main_player->schedule);
+        aras_gui_player_update(&main_player->gui, &main_player->status);
         return TRUE;
 }
 
 /**
- * This function initializes a main player structure.
+ * This function initializes a main player structure. The players and the
+ * snapshot reload are bound to the main context of the engine thread.
  *
  * @param   main_player Pointer to the main player structure
  *
@@ -124,49 +282,131 @@ int aras_main_player_callback_gui(struct aras_main_player *main_player)
  */
 int aras_main_player_init(struct aras_main_player *main_player)
 {
-        struct timeval time;
-
-        /* Initialize the pseudorandom number generator */
-        gettimeofday(&time, NULL);
-        srand((time.tv_sec * 1000) + (time.tv_usec / 1000));
-
-        /* Initialize and load configuration */
-        aras_configuration_init(&main_player->configuration);
-        if (aras_configuration_load_file(&main_player->configuration, main_player->configuration_file) == -1) {
+        /* Initialize the snapshot and load configuration */
+        main_player->snapshot = aras_snapshot_new();
+        if (aras_configuration_load_file(main_player->snapshot->configuration, main_player->configuration_file) == -1) {
                 fprintf(stderr, "aras: unable to open configuration file ""%s""\n", main_player->configuration_file);
                 return -1;
         }
 
-        /* Initialize and load schedule */
-        aras_schedule_init(&main_player->schedule);
-        if (aras_schedule_load_file(&main_player->schedule, main_player->configuration.schedule_file) == -1) {
-                fprintf(stderr, "aras: unable to open schedule file ""%s""\n", main_player->configuration.schedule_file);
+        /* Load schedule */
+        if (aras_schedule_load_file(main_player->snapshot->schedule, main_player->snapshot->configuration->schedule_file) == -1) {
+                fprintf(stderr, "aras: unable to open schedule file ""%s""\n", main_player->snapshot->configuration->schedule_file);
                 return -1;
         }
 
-        /* Initialize and load block */
-        aras_block_init(&main_player->block);
-        if (aras_block_load_file(&main_player->block, main_player->configuration.block_file) == -1) {
-                fprintf(stderr, "aras: unable to open block file ""%s""\n", main_player->configuration.block_file);
+        /* Load block */
+        if (aras_block_load_file(main_player->snapshot->block, main_player->snapshot->configuration->block_file) == -1) {
+                fprintf(stderr, "aras: unable to open block file ""%s""\n", main_player->snapshot->configuration->block_file);
                 return -1;
         }
 
-        /* Initialize players */
-        aras_player_init_block_player(&main_player->block_player, &main_player->configuration);
-        aras_player_init_time_signal_player(&main_player->time_signal_player, &main_player->configuration);
+        /* Link the schedule to the block */
+        aras_schedule_resolve(main_player->snapshot->schedule, main_player->snapshot->block, main_player->snapshot->configuration->log_file);
+
+        /* Index the directories of random blocks */
+        aras_media_init(main_player->snapshot->configuration->media_index_file);
+        aras_media_scan_block(main_player->snapshot->block);
+
+        /* Initialize the snapshot reload and players in the engine thread context */
+        main_player->context = g_main_context_new();
+        g_main_context_push_thread_default(main_player->context);
+        aras_snapshot_reload_init(&main_player->reload, &main_player->snapshot, main_player->configuration_file);
+        aras_player_init_block_player(&main_player->block_player, main_player->snapshot->configuration);
+        aras_player_init_time_signal_player(&main_player->time_signal_player, main_player->snapshot->configuration);
+        g_main_context_pop_thread_default(main_player->context);
 
         /* Initialize engines */
         aras_engine_init(&main_player->engine_block_player);
         aras_engine_init(&main_player->engine_time_signal_player);
+        aras_engine_set_random_seed(&main_player->engine_block_player, main_player->snapshot->configuration->random_seed);
+        aras_engine_set_random_seed(&main_player->engine_time_signal_player, main_player->snapshot->configuration->random_seed);
 
-        /* Initialize GTK and GUI */
+        /* Commands from the GUI are run by the block player engine */
+        aras_command_queue_init(&main_player->command_queue);
+        aras_engine_set_command_queue(&main_player->engine_block_player, &main_player->command_queue);
+
+        /* Publish the status of the engines for external monitors */
+        main_player->status_segment.segment = NULL;
+        if (main_player->snapshot->configuration->status_segment[0] != '\0' &&
+            aras_status_open(&main_player->status_segment, main_player->snapshot->configuration->status_segment) == -1)
+                fprintf(stderr, "aras: unable to open status segment ""%s""\n", main_player->snapshot->configuration->status_segment);
+
+        /* Wake up the engines on player events and state changes in event mode */
+        main_player->engine_mode = main_player->snapshot->configuration->engine_mode;
+        main_player->engine_source = 0;
+        main_player->engine_running = 0;
+        if (main_player->engine_mode == ARAS_CONFIGURATION_MODE_ENGINE_EVENT) {
+                aras_player_set_callback_wake(&main_player->block_player, aras_main_player_callback_wake, main_player);
+                aras_player_set_callback_wake(&main_player->time_signal_player, aras_main_player_callback_wake, main_player);
+                aras_engine_set_callback_wake(&main_player->engine_block_player, aras_main_player_callback_wake, main_player);
+                aras_engine_set_callback_wake(&main_player->engine_time_signal_player, aras_main_player_callback_wake, main_player);
+                aras_snapshot_reload_set_callback_done(&main_player->reload, aras_main_player_callback_wake, main_player);
+                aras_command_queue_set_callback_wake(&main_player->command_queue, aras_main_player_callback_command, main_player);
+        }
+
+        /* Initialize the status, GTK and GUI */
+        aras_gui_player_status_init(&main_player->status);
         gtk_disable_setlocale();
         gtk_init(NULL, NULL);
-        aras_gui_player_init(&main_player->gui, &main_player->engine_block_player, &main_player->configuration);
+        aras_gui_player_init(&main_player->gui, &main_player->status, &main_player->command_queue);
 
         return 0;
 }
 
+/**
+ * This function is the body of the engine thread. It runs the main loop of the
+ * engine thread.
+ *
+ * @param   data    Pointer to the ARAS Player main structure
+ *
+ * @return  This function always returns NULL
+ */
+gpointer aras_main_player_thread(gpointer data)
+{
+        struct aras_main_player *main_player;
+
+        main_player = (struct aras_main_player*)data;
+
+        g_main_context_push_thread_default(main_player->context);
+        g_main_loop_run(main_player->main_loop);
+        g_main_context_pop_thread_default(main_player->context);
+
+        return NULL;
+}
+
+/**
+ * This function sets the callback functions of the engines in the main context
+ * of the engine thread and starts the engine thread.
+ *
+ * @param   main_player Pointer to the ARAS Player main structure
+ */
+void aras_main_player_start(struct aras_main_player *main_player)
+{
+        struct aras_configuration *configuration;
+
+        configuration = main_player->snapshot->configuration;
+
+        /* Set the callback functions */
+        if (configuration->configuration_mode != ARAS_CONFIGURATION_MODE_CONFIGURATION_WATCH)
+                aras_main_player_add_timeout(main_player, G_PRIORITY_DEFAULT, configuration->configuration_period, (GSourceFunc)aras_main_player_callback_configuration);
+        else if (aras_snapshot_reload_watch(&main_player->reload) == -1) {
+                fprintf(stderr, "aras: unable to watch configuration files, polling\n");
+                aras_main_player_add_timeout(main_player, G_PRIORITY_DEFAULT, configuration->configuration_period, (GSourceFunc)aras_main_player_callback_configuration);
+        }
+        if (main_player->engine_mode == ARAS_CONFIGURATION_MODE_ENGINE_EVENT)
+                main_player->engine_source = aras_main_player_add_timeout(main_player, G_PRIORITY_HIGH, 0, (GSourceFunc)aras_main_player_callback_engine_event);
+        else
+                aras_main_player_add_timeout(main_player, G_PRIORITY_DEFAULT, configuration->engine_period, (GSourceFunc)aras_main_player_callback_engine);
+        aras_main_player_add_timeout(main_player, G_PRIORITY_DEFAULT_IDLE, configuration->gui_period, (GSourceFunc)aras_main_player_callback_status);
+        if (main_player->status_segment.segment != NULL)
+                aras_main_player_add_timeout(main_player, G_PRIORITY_DEFAULT_IDLE, configuration->status_period, (GSourceFunc)aras_main_player_callback_status_segment);
+
+        /* Run the main loop of the engines in their own thread */
+        main_player->main_loop = g_main_loop_new(main_player->context, FALSE);
+        main_player->thread = g_thread_new("aras-engine", aras_main_player_thread, main_player);
+}
+
 /**
  * The main function for the ARAS Radio Automation System Player
  *
@@ -193,10 +433,13 @@ int main(int argc, char **argv)
                 exit(-1);
         }
 
-        /* Set the callback functions */
-        g_timeout_add(main_player.configuration.configuration_period, (GSourceFunc)aras_main_player_callback_configuration, &main_player);
-        g_timeout_add(main_player.configuration.engine_period, (GSourceFunc)aras_main_player_callback_engine, &main_player);
-        g_timeout_add(main_player.configuration.gui_period, (GSourceFunc)aras_main_player_callback_gui, &main_player);
+        /* Watch the media directories, they are checked in the background otherwise */
+        if (aras_media_watch() == -1)
+                fprintf(stderr, "aras: unable to watch media directories\n");
+
+        /* Refresh the GUI in the main loop, the snapshot is owned by the engine thread once started */
+        g_timeout_add(main_player.snapshot->configuration->gui_period, (GSourceFunc)aras_main_player_callback_gui, &main_player);
+        aras_main_player_start(&main_player);
 
         /* Run the main loop */
         gtk_main();
@@ -0,0 +1,271 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Main source file for ARAS Simulator. It runs the engines of the daemon with
+ * the virtual clock of the time module and the simulated player, replaying
+ * days of the schedule in seconds. The log entries of the engines and the
+ * events of the players are written with their simulated time as an as-run
+ * trace.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <glib.h>
+#include <aras/time.h>
+#include <aras/configuration.h>
+#include <aras/schedule.h>
+#include <aras/block.h>
+#include <aras/snapshot.h>
+#include <aras/media.h>
+#include <aras/engine.h>
+#include <aras/main_simulator.h>
+
+/**
+ * This function checks the command line syntax
+ *
+ * @param   argc    The number of command line parameters
+ * @param   argv    The pointer to the command line parameters
+ *
+ * @return  0 if the syntax is correct, -1 if the syntax is not correct
+ */
+int aras_main_simulator_syntax_check(int argc, char **argv)
+{
+        if (argc == 2)
+                return 0;
+        else if ((argc == 3 || argc == 4) && atoi(argv[2]) > 0)
+                return 0;
+        else
+                return -1;
+}
+
+/**
+ * This function returns the CPU time used by the process.
+ *
+ * @return  The user and system CPU time in seconds
+ */
+double aras_main_simulator_cpu_time(void)
+{
+        struct rusage usage;
+
+        getrusage(RUSAGE_SELF, &usage);
+
+        return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
+/**
+ * This function returns the start of the current week, Sunday at 00:00 local
+ * time, at which simulations start.
+ *
+ * @return  The time in microseconds since the Epoch
+ */
+long long int aras_main_simulator_week_start(void)
+{
+        time_t t;
+        struct tm tm;
+
+        t = time(NULL);
+        localtime_r(&t, &tm);
+        tm.tm_mday -= tm.tm_wday;
+        tm.tm_hour = 0;
+        tm.tm_min = 0;
+        tm.tm_sec = 0;
+        tm.tm_isdst = -1;
+
+        return (long long int)mktime(&tm) * 1000000;
+}
+
+/**
+ * This function returns the time to advance the virtual clock after a run of
+ * the engines. In periodic mode it is the engine period. In event mode it is
+ * the time until the earliest engine deadline or change in a player unit.
+ *
+ * @param   main_simulator  Pointer to the main simulator structure
+ *
+ * @return  The time in miliseconds, at least 1
+ */
+long int aras_main_simulator_step(struct aras_main_simulator *main_simulator)
+{
+        struct aras_configuration *configuration;
+        long int step;
+        long int timeout;
+
+        configuration = main_simulator->snapshot->configuration;
+        if (configuration->engine_mode != ARAS_CONFIGURATION_MODE_ENGINE_EVENT)
+                return configuration->engine_period;
+
+        step = aras_engine_schedule_timeout(&main_simulator->engine_block_player, &main_simulator->block_player, configuration, main_simulator->snapshot->schedule);
+        timeout = aras_engine_time_signal_timeout(&main_simulator->engine_time_signal_player, &main_simulator->time_signal_player, configuration);
+        if (timeout < step)
+                step = timeout;
+        timeout = aras_player_get_timeout(&main_simulator->block_player);
+        if (timeout != -1 && timeout < step)
+                step = timeout;
+        timeout = aras_player_get_timeout(&main_simulator->time_signal_player);
+        if (timeout != -1 && timeout < step)
+                step = timeout;
+
+        /* Engines asking to run again at once run in the next milisecond */
+        if (step < 1)
+                step = 1;
+
+        return step;
+}
+
+/**
+ * This function runs the engines until the simulated time reaches the given
+ * number of days.
+ *
+ * @param   main_simulator  Pointer to the main simulator structure
+ */
+void aras_main_simulator_run(struct aras_main_simulator *main_simulator)
+{
+        struct aras_snapshot *snapshot;
+        long int step;
+
+        snapshot = main_simulator->snapshot;
+        while (main_simulator->time < main_simulator->days * ARAS_TIME_DAY) {
+                aras_engine_schedule(&main_simulator->engine_block_player, &main_simulator->block_player, snapshot->configuration, snapshot->schedule, snapshot->block);
+                aras_engine_time_signal(&main_simulator->engine_time_signal_player, &main_simulator->time_signal_player, snapshot->configuration, snapshot->block);
+                main_simulator->runs++;
+
+                step = aras_main_simulator_step(main_simulator);
+                aras_time_virtual_advance(step);
+                main_simulator->time += step;
+        }
+}
+
+/**
+ * This function initializes a main simulator structure. The virtual clock
+ * starts at the beginning of the current week and the log entries go to the
+ * trace file.
+ *
+ * @param   main_simulator  Pointer to the main simulator structure
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_main_simulator_init(struct aras_main_simulator *main_simulator)
+{
+        struct aras_configuration *configuration;
+
+        /* Start the virtual clock */
+        aras_time_virtual_init(aras_main_simulator_week_start());
+        main_simulator->time = 0;
+        main_simulator->runs = 0;
+
+        /* Initialize the snapshot and load configuration, logging to the trace file */
+        main_simulator->snapshot = aras_snapshot_new();
+        configuration = main_simulator->snapshot->configuration;
+        if (aras_configuration_load_file(configuration, main_simulator->configuration_file) == -1) {
+                fprintf(stderr, "aras: unable to open configuration file ""%s""\n", main_simulator->configuration_file);
+                return -1;
+        }
+        g_strlcpy(configuration->log_file, main_simulator->trace_file, ARAS_CONFIGURATION_MAX_ARGUMENT);
+
+        /* Load schedule */
+        if (aras_schedule_load_file(main_simulator->snapshot->schedule, configuration->schedule_file) == -1) {
+                fprintf(stderr, "aras: unable to open schedule file ""%s""\n", configuration->schedule_file);
+                return -1;
+        }
+
+        /* Load block */
+        if (aras_block_load_file(main_simulator->snapshot->block, configuration->block_file) == -1) {
+                fprintf(stderr, "aras: unable to open block file ""%s""\n", configuration->block_file);
+                return -1;
+        }
+
+        /* Link the schedule to the block */
+        aras_schedule_resolve(main_simulator->snapshot->schedule, main_simulator->snapshot->block, configuration->log_file);
+
+        /* Load playlists when blocks start, a prefetch ready or not depending on thread timing would make runs differ */
+        configuration->prefetch_time = 0;
+
+        /* Index the directories of random blocks */
+        aras_media_init(configuration->media_index_file);
+        aras_media_scan_block(main_simulator->snapshot->block);
+
+        /* Initialize players */
+        aras_player_init_block_player(&main_simulator->block_player, configuration);
+        aras_player_init_time_signal_player(&main_simulator->time_signal_player, configuration);
+        aras_player_set_trace_file(&main_simulator->block_player, configuration->log_file);
+        aras_player_set_trace_file(&main_simulator->time_signal_player, configuration->log_file);
+
+        /* Initialize engines */
+        aras_engine_init(&main_simulator->engine_block_player);
+        aras_engine_init(&main_simulator->engine_time_signal_player);
+        aras_engine_set_random_seed(&main_simulator->engine_block_player, configuration->random_seed);
+        aras_engine_set_random_seed(&main_simulator->engine_time_signal_player, configuration->random_seed);
+
+        return 0;
+}
+
+/**
+ * The main function for the ARAS Radio Automation System Simulator
+ *
+ * @param   argc    The number of command line parameters
+ * @param   argv    The pointer to the command line parameters
+ */
+int main(int argc, char **argv)
+{
+        /* The main data structure */
+        struct aras_main_simulator main_simulator;
+
+        double cpu;
+        gint64 wall;
+        long int hours;
+
+        /* Check syntax */
+        if (aras_main_simulator_syntax_check(argc, argv) == -1) {
+                fprintf(stderr, "aras: Incorrect syntax\n");
+                exit(-1);
+        }
+
+        /* Define the configuration file, the simulated days and the trace file */
+        main_simulator.configuration_file = argv[1];
+        main_simulator.days = argc >= 3 ? atoi(argv[2]) : ARAS_MAIN_SIMULATOR_DAYS;
+        main_simulator.trace_file = argc == 4 ? argv[3] : ARAS_MAIN_SIMULATOR_TRACE_FILE;
+
+        /* Main initialization */
+        if (aras_main_simulator_init(&main_simulator) == -1) {
+                fprintf(stderr, "aras: Initialization error\n");
+                exit(-1);
+        }
+
+        /* Run the simulation */
+        cpu = aras_main_simulator_cpu_time();
+        wall = g_get_monotonic_time();
+        aras_main_simulator_run(&main_simulator);
+        cpu = aras_main_simulator_cpu_time() - cpu;
+        wall = g_get_monotonic_time() - wall;
+
+        /* Report the engine cost */
+        hours = main_simulator.time / ARAS_TIME_HOUR;
+        fprintf(stderr, "Simulated %ld hours in %.2f s, %ld engine runs\n", hours, wall / 1000000.0, main_simulator.runs);
+        fprintf(stderr, "Engine CPU time: %.3f ms per simulated hour\n", hours > 0 ? cpu * 1000 / hours : 0);
+
+        exit(0);
+}
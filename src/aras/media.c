@@ -0,0 +1,796 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Source file for the ARAS Radio Automation System. Functions for the media
+ * module.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <aras/block.h>
+#include <aras/media.h>
+
+/* Index of directories, from directory path to directory structure */
+static GHashTable *aras_media_table = NULL;
+
+/* Watched directories, from watch descriptor to directory path */
+static GHashTable *aras_media_watches = NULL;
+
+/* Cache file, NULL if the index is not cached */
+static char *aras_media_file = NULL;
+
+/* Index state */
+static int aras_media_watch_fd = -1;
+static guint aras_media_events = 0;
+static int aras_media_changed = 0;
+static int aras_media_updating = 0;
+static guint aras_media_update_source = 0;
+
+G_LOCK_DEFINE_STATIC(aras_media);
+G_LOCK_DEFINE_STATIC(aras_media_save);
+
+/**
+ * This function frees a media directory structure.
+ *
+ * @param   directory   Pointer to the media directory structure
+ */
+void aras_media_directory_free(struct aras_media_directory *directory)
+{
+        guint i;
+
+        if (directory == NULL)
+                return;
+
+        for (i = 0; i < directory->stamps->len; i++)
+                g_free(g_array_index(directory->stamps, struct aras_media_stamp, i).path);
+        g_array_free(directory->stamps, TRUE);
+        g_ptr_array_free(directory->files, TRUE);
+        g_free(directory);
+}
+
+/**
+ * This function allocates an empty media directory structure.
+ *
+ * @param   time    Time of the scan in seconds
+ *
+ * @return  A pointer to the new media directory structure
+ */
+struct aras_media_directory *aras_media_directory_alloc(gint64 time)
+{
+        struct aras_media_directory *directory;
+
+        directory = g_new(struct aras_media_directory, 1);
+        directory->files = g_ptr_array_new_with_free_func(g_free);
+        directory->stamps = g_array_new(FALSE, FALSE, sizeof(struct aras_media_stamp));
+        directory->time = time;
+        directory->dirty = 0;
+
+        return directory;
+}
+
+/**
+ * This function adds a stamp to a media directory structure.
+ *
+ * @param   directory   Pointer to the media directory structure
+ * @param   path        Pointer to the path string of the directory
+ * @param   mtime       Modification time of the directory
+ */
+void aras_media_directory_stamp(struct aras_media_directory *directory, const char *path, gint64 mtime)
+{
+        struct aras_media_stamp stamp;
+
+        stamp.path = g_strdup(path);
+        stamp.mtime = mtime;
+        g_array_append_val(directory->stamps, stamp);
+}
+
+/**
+ * This function adds the URIs of the regular files in a local directory and
+ * its subdirectories to a media directory structure, together with a stamp
+ * for each directory.
+ *
+ * @param   directory   Pointer to the media directory structure
+ * @param   path        Pointer to the path string of a local directory
+ * @param   recursion   Recursion counter used to limit recursions
+ */
+void aras_media_directory_scan(struct aras_media_directory *directory, char *path, int recursion)
+{
+        GDir *dir;
+        const char *entry;
+        char *entry_path;
+        char *uri;
+        GStatBuf buffer;
+
+        /* If recursion is too deep, stop scanning */
+        if (recursion >= ARAS_MEDIA_MAX_RECURSION_DEPTH) {
+                fprintf(stderr, "aras: maximum number of recursions reached\n");
+                return;
+        }
+
+        /* Stamp the directory before reading it */
+        if (g_stat(path, &buffer) == -1)
+                return;
+        aras_media_directory_stamp(directory, path, buffer.st_mtime);
+
+        /* Open directory */
+        if ((dir = g_dir_open(path, 0, NULL)) == NULL)
+                return;
+
+        /* Read directory entries, a single stat call for each one */
+        while ((entry = g_dir_read_name(dir)) != NULL) {
+                entry_path = g_build_filename(path, entry, NULL);
+                if (g_stat(entry_path, &buffer) == 0) {
+                        if (S_ISREG(buffer.st_mode)) {
+                                if ((uri = g_filename_to_uri(entry_path, NULL, NULL)) != NULL)
+                                        g_ptr_array_add(directory->files, uri);
+                        } else if (S_ISDIR(buffer.st_mode)) {
+                                aras_media_directory_scan(directory, entry_path, recursion + 1);
+                        }
+                }
+                g_free(entry_path);
+        }
+
+        /* Close directory */
+        g_dir_close(dir);
+}
+
+/**
+ * This function checks the stamps of a media directory structure. It takes a
+ * stat call for each directory, not for each file. A directory modified
+ * within the second of the scan is not trusted, since its modification time
+ * cannot tell changes made after the scan.
+ *
+ * @param   directory   Pointer to the media directory structure
+ *
+ * @return  1 if no directory changed since the scan, 0 otherwise
+ */
+int aras_media_directory_check(struct aras_media_directory *directory)
+{
+        guint i;
+        GStatBuf buffer;
+        struct aras_media_stamp *stamp;
+
+        if (directory->stamps->len == 0)
+                return 0;
+
+        for (i = 0; i < directory->stamps->len; i++) {
+                stamp = &g_array_index(directory->stamps, struct aras_media_stamp, i);
+                if (g_stat(stamp->path, &buffer) == -1)
+                        return 0;
+                if (buffer.st_mtime != stamp->mtime || stamp->mtime >= directory->time)
+                        return 0;
+        }
+
+        return 1;
+}
+
+/**
+ * This function copies the stamps of a media directory structure, so that
+ * they can be checked without holding the media lock. It must be called with
+ * the media lock held.
+ *
+ * @param   directory   Pointer to the media directory structure
+ *
+ * @return  A pointer to a new media directory structure without files
+ */
+struct aras_media_directory *aras_media_directory_copy_stamps(struct aras_media_directory *directory)
+{
+        struct aras_media_directory *copy;
+        struct aras_media_stamp *stamp;
+        guint i;
+
+        copy = aras_media_directory_alloc(directory->time);
+        for (i = 0; i < directory->stamps->len; i++) {
+                stamp = &g_array_index(directory->stamps, struct aras_media_stamp, i);
+                aras_media_directory_stamp(copy, stamp->path, stamp->mtime);
+        }
+
+        return copy;
+}
+
+/**
+ * This function adds inotify watches on the directories of a media directory
+ * structure. It must be called with the media lock held.
+ *
+ * @param   directory   Pointer to the media directory structure
+ */
+void aras_media_directory_watch(struct aras_media_directory *directory)
+{
+        struct aras_media_stamp *stamp;
+        guint i;
+        int wd;
+
+        if (aras_media_watch_fd == -1)
+                return;
+
+        for (i = 0; i < directory->stamps->len; i++) {
+                stamp = &g_array_index(directory->stamps, struct aras_media_stamp, i);
+                wd = inotify_add_watch(aras_media_watch_fd, stamp->path,
+                                       IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                       IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+                if (wd != -1)
+                        g_hash_table_replace(aras_media_watches, GINT_TO_POINTER(wd), g_strdup(stamp->path));
+        }
+}
+
+/**
+ * This function creates the index tables if needed. It must be called with
+ * the media lock held.
+ */
+void aras_media_table_init(void)
+{
+        if (aras_media_table == NULL)
+                aras_media_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)aras_media_directory_free);
+        if (aras_media_watches == NULL)
+                aras_media_watches = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+}
+
+/**
+ * This function makes sure that the index holds an up to date media directory
+ * structure for a local directory. While directories are watched, changes
+ * mark the structure as dirty and no stat calls are needed. Otherwise the
+ * stamps are checked, with a stat call for each directory. Stamps are checked
+ * and the directory is scanned without holding the media lock.
+ *
+ * @param   path    Pointer to the path string of a local directory
+ *
+ * @return  1 if the directory was scanned, 0 otherwise
+ */
+int aras_media_update(char *path)
+{
+        struct aras_media_directory *directory;
+        struct aras_media_directory *stamps = NULL;
+        guint events;
+        int valid;
+
+        G_LOCK(aras_media);
+        aras_media_table_init();
+        directory = g_hash_table_lookup(aras_media_table, path);
+        if (directory != NULL && !directory->dirty) {
+                if (aras_media_watch_fd != -1) {
+                        G_UNLOCK(aras_media);
+                        return 0;
+                }
+                stamps = aras_media_directory_copy_stamps(directory);
+        }
+        events = aras_media_events;
+        G_UNLOCK(aras_media);
+
+        /* Check the stamps of an unwatched directory */
+        if (stamps != NULL) {
+                valid = aras_media_directory_check(stamps);
+                aras_media_directory_free(stamps);
+                if (valid)
+                        return 0;
+        }
+
+        /* Scan the directory */
+        directory = aras_media_directory_alloc(g_get_real_time() / G_USEC_PER_SEC);
+        aras_media_directory_scan(directory, path, 0);
+
+        /* Replace the previous structure, changes during the scan are rescanned later */
+        G_LOCK(aras_media);
+        if (events != aras_media_events)
+                directory->dirty = 1;
+        g_hash_table_replace(aras_media_table, g_strdup(path), directory);
+        aras_media_directory_watch(directory);
+        aras_media_changed = 1;
+        G_UNLOCK(aras_media);
+
+        return 1;
+}
+
+/**
+ * This function serializes the index for the cache file. Each directory is
+ * written as a line with its scan time and path, followed by a line for each
+ * stamp and a line for each file. It must be called with the media lock held.
+ *
+ * @return  A newly allocated string with the serialized index
+ */
+GString *aras_media_save_index(void)
+{
+        GHashTableIter iter;
+        gpointer key;
+        struct aras_media_directory *directory;
+        struct aras_media_stamp *stamp;
+        GString *index;
+        guint i;
+
+        index = g_string_new("# ARAS media index\n");
+        g_hash_table_iter_init(&iter, aras_media_table);
+        while (g_hash_table_iter_next(&iter, &key, (gpointer*)&directory)) {
+                if (directory->dirty || strchr(key, '\n') != NULL)
+                        continue;
+                g_string_append_printf(index, "R %" G_GINT64_FORMAT " %s\n", directory->time, (char*)key);
+                for (i = 0; i < directory->stamps->len; i++) {
+                        stamp = &g_array_index(directory->stamps, struct aras_media_stamp, i);
+                        g_string_append_printf(index, "D %" G_GINT64_FORMAT " %s\n", stamp->mtime, stamp->path);
+                }
+                for (i = 0; i < directory->files->len; i++)
+                        g_string_append_printf(index, "F %s\n", (char*)g_ptr_array_index(directory->files, i));
+        }
+
+        return index;
+}
+
+/**
+ * This function saves the index in the cache file if it changed. The index is
+ * serialized with the media lock held, but it is written without holding it,
+ * so picking files never waits for the disk. Saves are serialized, so an older
+ * index never replaces a newer one.
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_media_save_file(void)
+{
+        GString *index;
+        char *file;
+        char *tmp_file;
+        FILE *fp;
+        int result = 0;
+
+        G_LOCK(aras_media_save);
+
+        /* Serialize the index */
+        G_LOCK(aras_media);
+        if (aras_media_file == NULL || aras_media_table == NULL || !aras_media_changed) {
+                G_UNLOCK(aras_media);
+                G_UNLOCK(aras_media_save);
+                return aras_media_file == NULL ? -1 : 0;
+        }
+        index = aras_media_save_index();
+        file = g_strdup(aras_media_file);
+        aras_media_changed = 0;
+        G_UNLOCK(aras_media);
+
+        /* Write a temporary file and replace the cache file */
+        tmp_file = g_strconcat(file, ".tmp", NULL);
+        if ((fp = fopen(tmp_file, "w")) == NULL) {
+                result = -1;
+        } else if (fwrite(index->str, 1, index->len, fp) != index->len) {
+                fclose(fp);
+                g_unlink(tmp_file);
+                result = -1;
+        } else if (fclose(fp) != 0 || g_rename(tmp_file, file) == -1) {
+                g_unlink(tmp_file);
+                result = -1;
+        }
+
+        /* Save again the next time */
+        if (result == -1) {
+                G_LOCK(aras_media);
+                aras_media_changed = 1;
+                G_UNLOCK(aras_media);
+        }
+
+        g_free(tmp_file);
+        g_free(file);
+        g_string_free(index, TRUE);
+        G_UNLOCK(aras_media_save);
+
+        return result;
+}
+
+/**
+ * This function loads the index from the cache file. Directories changed
+ * since they were saved are discarded, so they are scanned again. It must be
+ * called with the media lock held.
+ *
+ * @param   file    Pointer to the cache file name string
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_media_load_file(char *file)
+{
+        FILE *fp;
+        char line[ARAS_MEDIA_MAX_LINE];
+        char *path;
+        char *end;
+        gint64 value;
+        char *root = NULL;
+        struct aras_media_directory *directory = NULL;
+
+        if ((fp = fopen(file, "r")) == NULL)
+                return -1;
+
+        while (fgets(line, sizeof(line), fp) != NULL) {
+                /* Remove the end of line */
+                line[strcspn(line, "\n")] = '\0';
+                if (line[0] == '\0' || line[0] == '#' || line[1] != ' ')
+                        continue;
+
+                /* Read the time of root and directory lines */
+                path = &line[2];
+                if (line[0] == 'R' || line[0] == 'D') {
+                        value = g_ascii_strtoll(&line[2], &end, 10);
+                        if (end == &line[2] || *end != ' ')
+                                continue;
+                        path = end + 1;
+                }
+
+                switch (line[0]) {
+                case 'R':
+                        /* Keep the previous directory if it did not change */
+                        if (directory != NULL && aras_media_directory_check(directory))
+                                g_hash_table_replace(aras_media_table, root, directory);
+                        else if (directory != NULL) {
+                                aras_media_directory_free(directory);
+                                g_free(root);
+                        }
+                        directory = aras_media_directory_alloc(value);
+                        root = g_strdup(path);
+                        break;
+                case 'D':
+                        if (directory != NULL)
+                                aras_media_directory_stamp(directory, path, value);
+                        break;
+                case 'F':
+                        if (directory != NULL)
+                                g_ptr_array_add(directory->files, g_strdup(path));
+                        break;
+                default:
+                        break;
+                }
+        }
+
+        /* Keep the last directory if it did not change */
+        if (directory != NULL && aras_media_directory_check(directory))
+                g_hash_table_replace(aras_media_table, root, directory);
+        else if (directory != NULL) {
+                aras_media_directory_free(directory);
+                g_free(root);
+        }
+
+        fclose(fp);
+
+        return 0;
+}
+
+/**
+ * This function initializes the index and loads it from the cache file.
+ *
+ * @param   file    Pointer to the cache file name string, NULL or empty if the
+ *                  index is not cached
+ *
+ * @return  0 if success, -1 if the cache file cannot be loaded
+ */
+int aras_media_init(char *file)
+{
+        int result = 0;
+
+        G_LOCK(aras_media);
+        aras_media_table_init();
+        g_free(aras_media_file);
+        aras_media_file = NULL;
+        if (file != NULL && file[0] != '\0') {
+                aras_media_file = g_strdup(file);
+                result = aras_media_load_file(aras_media_file);
+        }
+        G_UNLOCK(aras_media);
+
+        return result;
+}
+
+/**
+ * This function indexes the directories used by the random blocks in a block
+ * structure and saves the index if any directory was scanned.
+ *
+ * @param   block   Pointer to the block structure
+ */
+void aras_media_scan_block(struct aras_block *block)
+{
+        GList *pointer;
+        struct aras_block_node *node;
+
+        if (block == NULL)
+                return;
+
+        for (pointer = block->list; pointer != NULL; pointer = pointer->next) {
+                node = pointer->data;
+                if (node->type == ARAS_BLOCK_TYPE_RANDOM || node->type == ARAS_BLOCK_TYPE_RANDOM_FILE)
+                        aras_media_update(node->data);
+        }
+
+        aras_media_save_file();
+}
+
+/**
+ * This function is the update thread. It scans the directories marked as
+ * dirty, or every changed directory if they are not watched, and saves the
+ * index.
+ *
+ * @param   data    Not used
+ *
+ * @return  This function always returns NULL
+ */
+gpointer aras_media_thread_update(gpointer data)
+{
+        GHashTableIter iter;
+        gpointer key;
+        struct aras_media_directory *directory;
+        GSList *paths = NULL;
+        GSList *pointer;
+
+        /* Collect the dirty directories */
+        G_LOCK(aras_media);
+        g_hash_table_iter_init(&iter, aras_media_table);
+        while (g_hash_table_iter_next(&iter, &key, (gpointer*)&directory))
+                if (directory->dirty || aras_media_watch_fd == -1)
+                        paths = g_slist_prepend(paths, g_strdup(key));
+        G_UNLOCK(aras_media);
+
+        /* Scan them again, unwatched directories only if their stamps changed */
+        for (pointer = paths; pointer != NULL; pointer = pointer->next)
+                aras_media_update(pointer->data);
+        g_slist_free_full(paths, g_free);
+
+        aras_media_save_file();
+
+        G_LOCK(aras_media);
+        aras_media_updating = 0;
+        G_UNLOCK(aras_media);
+
+        return NULL;
+}
+
+/**
+ * This function is the callback function for delayed updates. It starts the
+ * update thread, or waits for the running one to finish.
+ *
+ * @param   data    Not used
+ *
+ * @return  TRUE while an update thread is running, FALSE otherwise
+ */
+gboolean aras_media_callback_update(gpointer data)
+{
+        G_LOCK(aras_media);
+        if (aras_media_updating) {
+                G_UNLOCK(aras_media);
+                return TRUE;
+        }
+        aras_media_updating = 1;
+        aras_media_update_source = 0;
+        G_UNLOCK(aras_media);
+
+        g_thread_unref(g_thread_new("aras-media", aras_media_thread_update, NULL));
+
+        return FALSE;
+}
+
+/**
+ * This function marks as dirty the indexed directories containing a path. It
+ * must be called with the media lock held.
+ *
+ * @param   path    Pointer to the path string, NULL to mark every directory
+ *
+ * @return  The number of directories marked
+ */
+int aras_media_mark(const char *path)
+{
+        GHashTableIter iter;
+        gpointer key;
+        struct aras_media_directory *directory;
+        size_t length;
+        int count = 0;
+
+        g_hash_table_iter_init(&iter, aras_media_table);
+        while (g_hash_table_iter_next(&iter, &key, (gpointer*)&directory)) {
+                length = strlen(key);
+                if (path == NULL || (!strncmp(path, key, length) && (path[length] == '\0' || path[length] == G_DIR_SEPARATOR))) {
+                        directory->dirty = 1;
+                        count++;
+                }
+        }
+
+        return count;
+}
+
+/**
+ * This function is the callback function for the inotify file descriptor. It
+ * marks the changed directories as dirty and schedules their update, so that
+ * bursts of changes are scanned once.
+ *
+ * @param   channel     Pointer to the channel
+ * @param   condition   The condition
+ * @param   data        Not used
+ *
+ * @return  This function always returns TRUE
+ */
+gboolean aras_media_callback_watch(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+        struct inotify_event *event;
+        char buffer[ARAS_MEDIA_WATCH_BUFFER] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        ssize_t length;
+        char *pointer;
+        char *path;
+        int count = 0;
+
+        G_LOCK(aras_media);
+        while ((length = read(aras_media_watch_fd, buffer, sizeof(buffer))) > 0) {
+                for (pointer = buffer; pointer < buffer + length; pointer += sizeof(struct inotify_event) + event->len) {
+                        event = (struct inotify_event*)pointer;
+                        if (event->mask & IN_Q_OVERFLOW) {
+                                count += aras_media_mark(NULL);
+                                continue;
+                        }
+                        if ((path = g_hash_table_lookup(aras_media_watches, GINT_TO_POINTER(event->wd))) == NULL)
+                                continue;
+                        count += aras_media_mark(path);
+                        if (event->mask & IN_IGNORED)
+                                g_hash_table_remove(aras_media_watches, GINT_TO_POINTER(event->wd));
+                }
+        }
+        if (count > 0) {
+                aras_media_events++;
+                if (aras_media_update_source == 0)
+                        aras_media_update_source = g_timeout_add(ARAS_MEDIA_UPDATE_DELAY, aras_media_callback_update, NULL);
+        }
+        G_UNLOCK(aras_media);
+
+        return TRUE;
+}
+
+/**
+ * This function starts watching the indexed directories, so that changes are
+ * indexed in the background instead of checking the stamps of every directory
+ * periodically. Directories changed since they were scanned are updated.
+ *
+ * @return  0 if success, -1 if the directories cannot be watched
+ */
+int aras_media_watch(void)
+{
+        GHashTableIter iter;
+        struct aras_media_directory *directory;
+        GIOChannel *channel;
+        int count = 0;
+
+        G_LOCK(aras_media);
+        if (aras_media_watch_fd != -1) {
+                G_UNLOCK(aras_media);
+                return 0;
+        }
+        if ((aras_media_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1) {
+                G_UNLOCK(aras_media);
+                return -1;
+        }
+
+        /* Watch the indexed directories and catch changes made before */
+        aras_media_table_init();
+        g_hash_table_iter_init(&iter, aras_media_table);
+        while (g_hash_table_iter_next(&iter, NULL, (gpointer*)&directory)) {
+                aras_media_directory_watch(directory);
+                if (!aras_media_directory_check(directory)) {
+                        directory->dirty = 1;
+                        count++;
+                }
+        }
+        if (count > 0 && aras_media_update_source == 0)
+                aras_media_update_source = g_timeout_add(ARAS_MEDIA_UPDATE_DELAY, aras_media_callback_update, NULL);
+        G_UNLOCK(aras_media);
+
+        channel = g_io_channel_unix_new(aras_media_watch_fd);
+        g_io_add_watch(channel, G_IO_IN, aras_media_callback_watch, NULL);
+
+        return 0;
+}
+
+/**
+ * This function looks up the media directory structure of a local directory
+ * for the engine. An indexed directory is served from memory and, if it is
+ * dirty or not watched, checked later by the update thread. Only a directory
+ * not indexed yet is scanned. It returns with the media lock held.
+ *
+ * @param   path    Pointer to the path string of a local directory
+ *
+ * @return  A pointer to the media directory structure, NULL if not indexed
+ */
+struct aras_media_directory *aras_media_lookup(char *path)
+{
+        struct aras_media_directory *directory;
+
+        G_LOCK(aras_media);
+        aras_media_table_init();
+        if ((directory = g_hash_table_lookup(aras_media_table, path)) != NULL) {
+                if ((directory->dirty || aras_media_watch_fd == -1) && aras_media_update_source == 0)
+                        aras_media_update_source = g_timeout_add(ARAS_MEDIA_UPDATE_DELAY, aras_media_callback_update, NULL);
+                return directory;
+        }
+        G_UNLOCK(aras_media);
+
+        /* Scan a directory not indexed yet */
+        aras_media_update(path);
+
+        G_LOCK(aras_media);
+        return g_hash_table_lookup(aras_media_table, path);
+}
+
+/**
+ * This function picks a random file from a local directory and its
+ * subdirectories using the directory index.
+ *
+ * @param   path    Pointer to the path string of a local directory
+ * @param   rand    Pointer to the pseudorandom number generator, NULL for the
+ *                  global one
+ *
+ * @return  A newly allocated URI string, NULL if there are no files
+ */
+char *aras_media_pick_file(char *path, GRand *rand)
+{
+        struct aras_media_directory *directory;
+        char *uri = NULL;
+        int i;
+
+        if (path == NULL)
+                return NULL;
+
+        directory = aras_media_lookup(path);
+        if (directory != NULL && directory->files->len > 0) {
+                if (rand != NULL)
+                        i = g_rand_int_range(rand, 0, directory->files->len);
+                else
+                        i = g_random_int_range(0, directory->files->len);
+                uri = g_strdup(g_ptr_array_index(directory->files, i));
+        }
+        G_UNLOCK(aras_media);
+
+        return uri;
+}
+
+/**
+ * This function adds the URIs of the files in a local directory and its
+ * subdirectories to the playlist tail using the directory index.
+ *
+ * @param   playlist    Pointer to the playlist
+ * @param   path        Pointer to the path string of a local directory
+ *
+ * @return  The augmented playlist
+ */
+GList *aras_media_load_directory(GList *playlist, char *path)
+{
+        struct aras_media_directory *directory;
+        guint i;
+
+        if (path == NULL)
+                return playlist;
+
+        /* Reverse the list */
+        playlist = g_list_reverse(playlist);
+
+        directory = aras_media_lookup(path);
+        for (i = 0; directory != NULL && i < directory->files->len; i++)
+                playlist = g_list_prepend(playlist, g_strdup(g_ptr_array_index(directory->files, i)));
+        G_UNLOCK(aras_media);
+
+        /* Reverse the list */
+        playlist = g_list_reverse(playlist);
+
+        return playlist;
+}
@@ -28,146 +28,334 @@
  */
 
 #include <gst/gst.h>
+#include <gst/controller/controller.h>
 #include <aras/configuration.h>
 #include <aras/player.h>
 
-void aras_player_message_check(GstBus *bus)
+/**
+ * This function calls the wake up function of a player, if any, so that the
+ * engine working with the player handles an event without delay.
+ *
+ * @param   player  Pointer to the player
+ */
+void aras_player_wake(struct aras_player *player)
+{
+        if (player->callback_wake != NULL)
+                player->callback_wake(player->callback_wake_data);
+}
+
+/**
+ * This function returns a deck of the pool of a player.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The deck, NULL if the unit does not exist
+ */
+struct aras_player_deck *aras_player_get_deck(struct aras_player *player, int unit)
 {
-        GstMessage *msg;
+        if (unit < 0 || unit >= player->units)
+                return NULL;
 
-        while ((msg = gst_bus_pop(bus)) != NULL)
-                gst_message_unref(msg);
+        return &player->deck[unit];
 }
 
 /**
- * This function is the callback function for a player.
+ * This function initializes the gapless queue of a player unit.
  *
- * @param   bus     Pointer to the bus
- * @param   msg     Pointer to the message
- * @param   data    Pointer to the callback data
+ * @param   queue   Pointer to the queue
  */
-gboolean aras_player_callback_block_player_a(GstBus *bus, GstMessage *msg, gpointer data)
+void aras_player_queue_init(struct aras_player_queue *queue)
 {
-        struct aras_player *player;
+        g_mutex_init(&queue->lock);
+        queue->uri = NULL;
+        queue->handed = 0;
+        queue->started = 0;
+}
 
-        player = (struct aras_player*)data;
+/**
+ * This function empties the gapless queue of a player unit and forgets the
+ * URIs handed to the playbin, for units being stopped.
+ *
+ * @param   queue   Pointer to the queue
+ */
+void aras_player_queue_reset(struct aras_player_queue *queue)
+{
+        g_mutex_lock(&queue->lock);
+        g_free(queue->uri);
+        queue->uri = NULL;
+        queue->handed = 0;
+        queue->started = 0;
+        g_mutex_unlock(&queue->lock);
+}
 
-        switch (GST_MESSAGE_TYPE(msg)) {
-        case GST_MESSAGE_EOS:
-                gst_element_set_state(player->playbin_a, GST_STATE_NULL);
-                break;
-        case GST_MESSAGE_ERROR:
-                gst_element_set_state(player->playbin_a, GST_STATE_NULL);
-        break;
-        case GST_MESSAGE_BUFFERING:
-                gst_message_parse_buffering(msg, &player->buffer_percent_a);
-                if (player->buffer_percent_a < 100)
-                        gst_element_set_state(player->playbin_a, GST_STATE_PAUSED);
-                else
-                        gst_element_set_state(player->playbin_a, GST_STATE_PLAYING);
-                break;
-        default:
-                break;
+/**
+ * This function is the callback function for the about-to-finish signal of a
+ * playbin. It is called from a streaming thread when the current media is
+ * about to finish, and it hands the queued URI, if any, to the playbin, which
+ * plays it next reusing the pipeline without a gap.
+ *
+ * @param   playbin Pointer to the playbin
+ * @param   data    Pointer to the gapless queue of the unit
+ */
+void aras_player_callback_about_to_finish(GstElement *playbin, gpointer data)
+{
+        struct aras_player_queue *queue;
+
+        queue = (struct aras_player_queue*)data;
+
+        g_mutex_lock(&queue->lock);
+        if (queue->uri != NULL) {
+                g_object_set(playbin, "uri", queue->uri, NULL);
+                g_free(queue->uri);
+                queue->uri = NULL;
+                queue->handed = 1;
         }
-        return TRUE;
+        g_mutex_unlock(&queue->lock);
 }
 
 /**
- * This function is the callback function for a player.
+ * This function initializes the status of a player unit in GST_STATE_READY.
  *
- * @param   bus     Pointer to the bus
- * @param   msg     Pointer to the message
- * @param   data    Pointer to the callback data
+ * @param   status  Pointer to the status
  */
-gboolean aras_player_callback_block_player_b(GstBus *bus, GstMessage *msg, gpointer data)
+void aras_player_status_init(struct aras_player_status *status)
 {
-        struct aras_player *player;
-
-        player = (struct aras_player*)data;
+        status->state = ARAS_PLAYER_STATE_STOP;
+        status->target = GST_STATE_READY;
+        status->prerolled = 0;
+        status->duration = 0;
+        status->position = 0;
+        status->clock = NULL;
+        status->clock_time = GST_CLOCK_TIME_NONE;
+        status->buffer_percent = 0;
+}
 
-        switch (GST_MESSAGE_TYPE(msg)) {
-        case GST_MESSAGE_EOS:
-                gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-                break;
-        case GST_MESSAGE_ERROR:
-                gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-        break;
-        case GST_MESSAGE_BUFFERING:
-                gst_message_parse_buffering(msg, &player->buffer_percent_b);
-                if (player->buffer_percent_b < 100)
-                        gst_element_set_state(player->playbin_b, GST_STATE_PAUSED);
-                else 
-                        gst_element_set_state(player->playbin_b, GST_STATE_PLAYING);
-                break;
-        default:
-                break;
+/**
+ * This function returns the position in miliseconds recorded in the status of
+ * a player unit, extrapolated with the pipeline clock while playing.
+ *
+ * @param   status  Pointer to the status
+ * @return  The position
+ */
+long int aras_player_status_get_position(struct aras_player_status *status)
+{
+        GstClockTime now;
+        long int position;
+
+        position = status->position;
+        if (status->state == ARAS_PLAYER_STATE_PLAYING && status->clock != NULL && GST_CLOCK_TIME_IS_VALID(status->clock_time)) {
+                now = gst_clock_get_time(status->clock);
+                if (GST_CLOCK_TIME_IS_VALID(now) && now > status->clock_time)
+                        position += (long int)((now - status->clock_time) / GST_MSECOND);
         }
-        return TRUE;
+
+        if (status->duration > 0 && position > status->duration)
+                position = status->duration;
+
+        return position;
 }
 
 /**
- * This function is the callback function for a player.
+ * This function queries the duration of the media in a player unit and records
+ * it in the status.
  *
- * @param   bus     Pointer to the bus
- * @param   msg     Pointer to the message
- * @param   data    Pointer to the callback data
+ * @param   playbin Pointer to the playbin
+ * @param   status  Pointer to the status
  */
-gboolean aras_player_callback_time_signal_player_a(GstBus *bus, GstMessage *msg, gpointer data)
+void aras_player_status_query_duration(GstElement *playbin, struct aras_player_status *status)
 {
-        struct aras_player *player;
+        gint64 duration;
 
-        player = (struct aras_player*)data;
+        if (gst_element_query_duration(playbin, GST_FORMAT_TIME, &duration) && duration > 0)
+                status->duration = (long int)(duration / GST_MSECOND);
+        else
+                status->duration = 0;
+}
 
-        switch (GST_MESSAGE_TYPE(msg)) {
-        case GST_MESSAGE_EOS:
-                gst_element_set_state(player->playbin_a, GST_STATE_NULL);
+/**
+ * This function queries the position of a player unit and records it in the
+ * status together with the time of the pipeline clock, so that later
+ * positions are extrapolated without querying the pipeline.
+ *
+ * @param   playbin Pointer to the playbin
+ * @param   status  Pointer to the status
+ */
+void aras_player_status_query_position(GstElement *playbin, struct aras_player_status *status)
+{
+        gint64 position;
+
+        if (status->clock != NULL)
+                gst_object_unref(status->clock);
+        status->clock = gst_element_get_clock(playbin);
+        status->clock_time = status->clock != NULL ? gst_clock_get_time(status->clock) : GST_CLOCK_TIME_NONE;
+
+        if (gst_element_query_position(playbin, GST_FORMAT_TIME, &position) && position > 0)
+                status->position = (long int)(position / GST_MSECOND);
+        else
+                status->position = 0;
+}
+
+/**
+ * This function records in the status of a player unit that the unit has
+ * reached a state.
+ *
+ * @param   playbin Pointer to the playbin
+ * @param   status  Pointer to the status
+ * @param   state   The state reached
+ */
+void aras_player_status_set_state(GstElement *playbin, struct aras_player_status *status, GstState state)
+{
+        switch (state) {
+        case GST_STATE_PLAYING:
+                status->state = ARAS_PLAYER_STATE_PLAYING;
+                aras_player_status_query_duration(playbin, status);
+                aras_player_status_query_position(playbin, status);
                 break;
-        case GST_MESSAGE_ERROR:
-                gst_element_set_state(player->playbin_a, GST_STATE_NULL);
-        break;
-        case GST_MESSAGE_BUFFERING:
-                gst_message_parse_buffering(msg, &player->buffer_percent_a);
-                if (player->buffer_percent_a < 100)
-                        gst_element_set_state(player->playbin_a, GST_STATE_PAUSED);
-                else
-                        gst_element_set_state(player->playbin_a, GST_STATE_PLAYING);
+        case GST_STATE_PAUSED:
+                status->state = ARAS_PLAYER_STATE_OTHER;
+                status->prerolled = 1;
+                aras_player_status_query_duration(playbin, status);
+                break;
+        case GST_STATE_READY:
+                status->state = ARAS_PLAYER_STATE_STOP;
+                status->duration = 0;
+                status->position = 0;
                 break;
         default:
+                status->state = ARAS_PLAYER_STATE_ERROR;
+                status->duration = 0;
+                status->position = 0;
                 break;
         }
-        return TRUE;
 }
 
 /**
- * This function is the callback function for a player.
+ * This function requests a state change in a playbin without waiting for it
+ * and updates the status of the unit. The status is reported as
+ * ARAS_PLAYER_STATE_OTHER until the bus callback receives the change.
  *
- * @param   bus     Pointer to the bus
+ * @param   playbin Pointer to the playbin
+ * @param   status  Pointer to the status
+ * @param   state   The requested state
+ * @return  The result of the state change
+ */
+GstStateChangeReturn aras_player_status_request(GstElement *playbin, struct aras_player_status *status, GstState state)
+{
+        GstStateChangeReturn ret;
+
+        /* Freeze the position out of GST_STATE_PLAYING */
+        status->position = aras_player_status_get_position(status);
+        if (status->clock != NULL) {
+                gst_object_unref(status->clock);
+                status->clock = NULL;
+        }
+        status->clock_time = GST_CLOCK_TIME_NONE;
+
+        status->target = state;
+        status->state = ARAS_PLAYER_STATE_OTHER;
+        status->prerolled = 0;
+
+        ret = gst_element_set_state(playbin, state);
+        if (ret == GST_STATE_CHANGE_SUCCESS || ret == GST_STATE_CHANGE_NO_PREROLL)
+                aras_player_status_set_state(playbin, status, state);
+        else if (ret == GST_STATE_CHANGE_FAILURE)
+                aras_player_status_set_state(playbin, status, GST_STATE_NULL);
+
+        return ret;
+}
+
+/**
+ * This function handles a bus message of a deck. It keeps the status of the
+ * deck current, so that reading it does not query the pipeline.
+ *
+ * @param   deck    Pointer to the deck
  * @param   msg     Pointer to the message
- * @param   data    Pointer to the callback data
  */
-gboolean aras_player_callback_time_signal_player_b(GstBus *bus, GstMessage *msg, gpointer data)
+void aras_player_handle_message(struct aras_player_deck *deck, GstMessage *msg)
 {
         struct aras_player *player;
+        GstElement *playbin;
+        struct aras_player_status *status;
+        struct aras_player_queue *queue;
+        int handed;
+        GstState old_state;
+        GstState new_state;
+        GstState pending;
 
-        player = (struct aras_player*)data;
+        player = deck->player;
+        playbin = deck->playbin;
+        status = &deck->status;
+        queue = &deck->queue;
 
         switch (GST_MESSAGE_TYPE(msg)) {
         case GST_MESSAGE_EOS:
-                gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-                break;
         case GST_MESSAGE_ERROR:
-                gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-        break;
+                aras_player_status_request(playbin, status, GST_STATE_NULL);
+                aras_player_wake(player);
+                break;
+        case GST_MESSAGE_STATE_CHANGED:
+                /* State changes of the playbin itself complete transitions,
+                   changes queued before the last request are outdated */
+                if (GST_MESSAGE_SRC(msg) != GST_OBJECT(playbin))
+                        break;
+                gst_message_parse_state_changed(msg, &old_state, &new_state, &pending);
+                if (new_state == status->target && pending == GST_STATE_VOID_PENDING && status->state == ARAS_PLAYER_STATE_OTHER && !status->prerolled)
+                        aras_player_status_set_state(playbin, status, new_state);
+                aras_player_wake(player);
+                break;
+        case GST_MESSAGE_ASYNC_DONE:
+                /* Resynchronize the position after prerolls and seeks */
+                if (status->state == ARAS_PLAYER_STATE_PLAYING)
+                        aras_player_status_query_position(playbin, status);
+                aras_player_wake(player);
+                break;
+        case GST_MESSAGE_STREAM_START:
+                /* A queued URI starts playing, its position starts from zero */
+                g_mutex_lock(&queue->lock);
+                handed = queue->handed;
+                queue->handed = 0;
+                queue->started += handed;
+                g_mutex_unlock(&queue->lock);
+                if (!handed)
+                        break;
+                if (status->state == ARAS_PLAYER_STATE_PLAYING) {
+                        status->position = 0;
+                        if (status->clock != NULL)
+                                status->clock_time = gst_clock_get_time(status->clock);
+                        aras_player_status_query_duration(playbin, status);
+                }
+                aras_player_wake(player);
+                break;
+        case GST_MESSAGE_DURATION_CHANGED:
+                if (status->state == ARAS_PLAYER_STATE_PLAYING || status->prerolled)
+                        aras_player_status_query_duration(playbin, status);
+                aras_player_wake(player);
+                break;
         case GST_MESSAGE_BUFFERING:
-                gst_message_parse_buffering(msg, &player->buffer_percent_b);
-                if (player->buffer_percent_b < 100)
-                        gst_element_set_state(player->playbin_b, GST_STATE_PAUSED);
-                else
-                        gst_element_set_state(player->playbin_b, GST_STATE_PLAYING);
+                /* Pause while buffering only units meant to be playing, prerolled units stay paused */
+                gst_message_parse_buffering(msg, &status->buffer_percent);
+                if (deck->playing) {
+                        if (status->buffer_percent < 100 && status->target == GST_STATE_PLAYING)
+                                aras_player_status_request(playbin, status, GST_STATE_PAUSED);
+                        else if (status->buffer_percent == 100 && status->target == GST_STATE_PAUSED)
+                                aras_player_status_request(playbin, status, GST_STATE_PLAYING);
+                }
                 break;
         default:
                 break;
         }
+}
+
+/**
+ * This function is the bus callback function for the decks of a player.
+ *
+ * @param   bus     Pointer to the bus
+ * @param   msg     Pointer to the message
+ * @param   data    Pointer to the deck
+ */
+gboolean aras_player_callback(GstBus *bus, GstMessage *msg, gpointer data)
+{
+        aras_player_handle_message((struct aras_player_deck*)data, msg);
         return TRUE;
 }
 
@@ -317,26 +505,37 @@ GstElement *aras_player_init_audio_sink(char *name, int audio_output, char *audi
 
 /**
  * This function returns an audio sink bin to be used as an audio sink with a
- * playbin element.
+ * playbin element. The media is resampled to the sample rate of the output in
+ * the bin, whatever rates the audio sink accepts.
  *
- * @param   sink            Pointer to an aras_player_sink structure
- * @param   name            Pointer to the name string
- * @param   audio_output    Value for the audio output
- * @param   audio_device    Pointer to the audio device string
- * @param   sample_rate     Value for the sample rate
- * @param   channels        Value for the number of channels
+ * @param   sink                Pointer to an aras_player_sink structure
+ * @param   name                Pointer to the name string
+ * @param   audio_output        Value for the audio output
+ * @param   audio_device        Pointer to the audio device string
+ * @param   sample_rate         Value for the sample rate
+ * @param   channels            Value for the number of channels
+ * @param   resample_quality    Value for the resample quality, from 0 to 10
  */
-void aras_player_init_audio_sink_bin(struct aras_player_sink *sink, char *name, int audio_output, char *audio_device, int sample_rate, int channels)
+void aras_player_init_audio_sink_bin(struct aras_player_sink *sink, char *name, int audio_output, char *audio_device, int sample_rate, int channels, int resample_quality)
 {
         /* Create bin */
         sink->bin = gst_bin_new("audio_sink_bin");
 
         /* Create the elements */
         sink->convert = gst_element_factory_make("audioconvert", "audioconvert");
+        sink->resample = gst_element_factory_make("audioresample", "audioresample");
+        sink->volume = gst_element_factory_make("volume", "volume");
         sink->sink = aras_player_init_audio_sink(name, audio_output, audio_device);
+        g_object_set(sink->resample, "quality", resample_quality, NULL);
 
         /* Add the elements to the bin */
-        gst_bin_add_many(GST_BIN(sink->bin), sink->convert, sink->sink, NULL);
+        gst_bin_add_many(GST_BIN(sink->bin), sink->convert, sink->resample, sink->volume, sink->sink, NULL);
+
+        /* Bind the volume to a control source, ramps are interpolated for each sample */
+        sink->control = gst_interpolation_control_source_new();
+        g_object_set(sink->control, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+        sink->binding = gst_direct_control_binding_new_absolute(GST_OBJECT(sink->volume), "volume", sink->control);
+        gst_object_add_control_binding(GST_OBJECT(sink->volume), sink->binding);
 
         /* Create the capabilities and link elements */
         sink->caps = gst_caps_new_simple("audio/x-raw",
@@ -347,7 +546,8 @@ void aras_player_init_audio_sink_bin(struct aras_player_sink *sink, char *name,
                                                  G_TYPE_INT,
                                                  sample_rate,
                                                  NULL);
-        gst_element_link_filtered(sink->convert, sink->sink, sink->caps);
+        gst_element_link_many(sink->convert, sink->resample, sink->volume, NULL);
+        gst_element_link_filtered(sink->volume, sink->sink, sink->caps);
         //gst_caps_unref(sink->caps);
 
         /* Create the pad in the bin */
@@ -358,6 +558,104 @@ void aras_player_init_audio_sink_bin(struct aras_player_sink *sink, char *name,
         //gst_object_unref(sink->pad);
 }
 
+/**
+ * This function sets up a playbin for audio only playback. The flags of the
+ * playbin disable video, visualisations and subtitles, so that video tracks
+ * and cover art are neither decoded nor scaled, and no video sink bin is
+ * created.
+ *
+ * @param   playbin Pointer to the playbin
+ * @param   sink    Pointer to the video sink left empty
+ */
+void aras_player_init_audio_only(GstElement *playbin, struct aras_player_sink *sink)
+{
+        guint flags;
+
+        memset(sink, 0, sizeof(*sink));
+
+        g_object_get(playbin, "flags", &flags, NULL);
+        flags &= ~(ARAS_PLAYER_FLAG_VIDEO | ARAS_PLAYER_FLAG_TEXT | ARAS_PLAYER_FLAG_VIS);
+        g_object_set(playbin, "flags", flags, NULL);
+}
+
+/**
+ * This function initializes a deck of the pool of a player. The playbin and
+ * its sink bins are created once and reused for every playlist node, the deck
+ * is left in GST_STATE_READY.
+ *
+ * @param   player          Pointer to the player
+ * @param   unit            The identifier of the player unit
+ * @param   name            Pointer to the name string
+ * @param   audio_output    Value for the audio output
+ * @param   audio_device    Pointer to the audio device string
+ * @param   sample_rate     Value for the sample rate
+ * @param   channels        Value for the number of channels
+ * @param   resample_quality Value for the resample quality
+ * @param   video_output    Value for the video output
+ * @param   video_device    Pointer to the video device string
+ * @param   video_display   Pointer to the video display string
+ * @param   resolution      Array containing the screen resolution
+ */
+void aras_player_init_deck(struct aras_player *player,
+                           int unit,
+                           char *name,
+                           int audio_output,
+                           char *audio_device,
+                           int sample_rate,
+                           int channels,
+                           int resample_quality,
+                           int video_output,
+                           char *video_device,
+                           char *video_display,
+                           int resolution[])
+{
+        struct aras_player_deck *deck;
+        char deck_name[ARAS_PLAYER_MAX_NAME];
+
+        /* Initialize volume and status */
+        deck = &player->deck[unit];
+        deck->player = player;
+        deck->unit = unit;
+        deck->allocated = 0;
+        deck->volume = 0;
+        deck->playing = 0;
+        aras_player_status_init(&deck->status);
+        aras_player_queue_init(&deck->queue);
+
+        /* Create the playbin */
+        snprintf(deck_name, sizeof(deck_name), "deck_%d", unit);
+        deck->playbin = gst_element_factory_make("playbin", deck_name);
+
+        /* Create the audio sink bin */
+        aras_player_init_audio_sink_bin(&deck->audio_sink, name, audio_output, audio_device, sample_rate, channels, resample_quality);
+        g_object_set(deck->playbin, "audio-sink", deck->audio_sink.bin, NULL);
+
+        /* Create the video sink bin, audio only players do not decode video */
+        if (video_output == ARAS_CONFIGURATION_MODE_VIDEO_NONE) {
+                aras_player_init_audio_only(deck->playbin, &deck->video_sink);
+        } else {
+                aras_player_init_video_sink_bin(&deck->video_sink, name, video_output, video_device, video_display, resolution);
+                g_object_set(deck->playbin, "video-sink", deck->video_sink.bin, NULL);
+        }
+
+        /* Enable property async-handling */
+        g_object_set(deck->playbin, "async-handling", TRUE, NULL);
+
+        /* Hand the queued URIs to the playbin for gapless playback */
+        g_signal_connect(deck->playbin, "about-to-finish", G_CALLBACK(aras_player_callback_about_to_finish), &deck->queue);
+
+        /* Create the bus */
+        deck->bus = gst_pipeline_get_bus(GST_PIPELINE(deck->playbin));
+        gst_bus_add_watch(deck->bus, aras_player_callback, deck);
+        //gst_object_unref(deck->bus);
+
+        /* Set the volume */
+        aras_player_set_volume(player, unit, deck->volume);
+
+        /* Set state to GST_STATE_READY */
+        gst_element_set_state(deck->playbin, GST_STATE_READY);
+}
+
 /**
  * This function initializes a player structure with the block player
  * configuration.
@@ -369,70 +667,32 @@ void aras_player_init_audio_sink_bin(struct aras_player_sink *sink, char *name,
  */
 int aras_player_init_block_player(struct aras_player *player, struct aras_configuration *configuration)
 {
+        int unit;
+
         /* Initialize GStreamer */
         gst_init(NULL, NULL);
 
-        /* Initialize current unit, volume and buffer percent */
+        /* Initialize current unit and the pool of decks */
         player->current_unit = 0;
-        player->volume_a = 0;
-        player->volume_b = 0;
-        player->buffer_percent_a = 0;
-        player->buffer_percent_b = 0;
-
-        /* Create playbin_a and playbin_b */
-        player->playbin_a = gst_element_factory_make("playbin", "deck_a");
-        player->playbin_b = gst_element_factory_make("playbin", "deck_b");
-
-        /* Create the audio sink bin and the video sink bin */
-        aras_player_init_audio_sink_bin(&player->audio_sink_a,
-                                        configuration->block_player_name,
-                                        configuration->block_player_audio_output,
-                                        configuration->block_player_audio_device,
-                                        configuration->block_player_sample_rate,
-                                        configuration->block_player_channels);
-        aras_player_init_video_sink_bin(&player->video_sink_a,
-                                        configuration->block_player_name,
-                                        configuration->block_player_video_output,
-                                        configuration->block_player_video_device,
-                                        configuration->block_player_video_display,
-                                        configuration->block_player_display_resolution);
-        aras_player_init_audio_sink_bin(&player->audio_sink_b,
-                                        configuration->block_player_name,
-                                        configuration->block_player_audio_output,
-                                        configuration->block_player_audio_device,
-                                        configuration->block_player_sample_rate,
-                                        configuration->block_player_channels);
-        aras_player_init_video_sink_bin(&player->video_sink_b,
-                                        configuration->block_player_name,
-                                        configuration->block_player_video_output,
-                                        configuration->block_player_video_device,
-                                        configuration->block_player_video_display,
-                                        configuration->block_player_display_resolution);
-
-        g_object_set(player->playbin_a, "audio-sink", player->audio_sink_a.bin, NULL);
-        g_object_set(player->playbin_a, "video-sink", player->video_sink_a.bin, NULL);
-        g_object_set(player->playbin_b, "audio-sink", player->audio_sink_b.bin, NULL);
-        g_object_set(player->playbin_b, "video-sink", player->video_sink_b.bin, NULL);
-
-        /* Enable property async-handling */
-        g_object_set(player->playbin_a, "async-handling", TRUE, NULL);
-        g_object_set(player->playbin_b, "async-handling", TRUE, NULL);
+        player->units = configuration->block_player_decks;
+        player->callback_wake = NULL;
+        player->callback_wake_data = NULL;
+
+        /* Create the decks */
+        for (unit = 0; unit < player->units; unit++)
+                aras_player_init_deck(player,
+                                      unit,
+                                      configuration->block_player_name,
+                                      configuration->block_player_audio_output,
+                                      configuration->block_player_audio_device,
+                                      configuration->block_player_sample_rate,
+                                      configuration->block_player_channels,
+                                      configuration->block_player_resample_quality,
+                                      configuration->block_player_video_output,
+                                      configuration->block_player_video_device,
+                                      configuration->block_player_video_display,
+                                      configuration->block_player_display_resolution);
 
-        /* Create the buses */
-        player->bus_a = gst_pipeline_get_bus(GST_PIPELINE(player->playbin_a));
-        player->bus_b = gst_pipeline_get_bus(GST_PIPELINE(player->playbin_b));
-        gst_bus_add_watch(player->bus_a, aras_player_callback_block_player_a, player);
-        gst_bus_add_watch(player->bus_b, aras_player_callback_block_player_b, player);
-        //gst_object_unref(player->bus_a);
-        //gst_object_unref(player->bus_b);
-
-        /* Set the volume */
-        g_object_set(player->playbin_a, "volume", player->volume_a, NULL);
-        g_object_set(player->playbin_b, "volume", player->volume_b, NULL);
-
-        /* Set state to GST_STATE_NULL */
-        gst_element_set_state(player->playbin_a, GST_STATE_READY);
-        gst_element_set_state(player->playbin_b, GST_STATE_READY);
         return 0;
 }
 
@@ -447,70 +707,35 @@ int aras_player_init_block_player(struct aras_player *player, struct aras_config
  */
 int aras_player_init_time_signal_player(struct aras_player *player, struct aras_configuration *configuration)
 {
-        /* Initialize current unit, volume and buffer percent */
-        player->current_unit = 0;
-        player->volume_a = 0;
-        player->volume_b = 0;
-        player->buffer_percent_a = 0;
-        player->buffer_percent_b = 0;
-
-        /* Create playbin_a and playbin_b */
-        player->playbin_a = gst_element_factory_make("playbin", "deck_a");
-        player->playbin_b = gst_element_factory_make("playbin", "deck_b");
-
-        /* Create the audio sink bin and the video sink bin */
-        aras_player_init_audio_sink_bin(&player->audio_sink_a, configuration->time_signal_player_name,
-                                        configuration->time_signal_player_audio_output,
-                                        configuration->time_signal_player_audio_device,
-                                        configuration->time_signal_player_sample_rate,
-                                        configuration->time_signal_player_channels);
-        aras_player_init_video_sink_bin(&player->video_sink_a, configuration->time_signal_player_name,
-                                        configuration->time_signal_player_video_output,
-                                        configuration->time_signal_player_video_device,
-                                        configuration->time_signal_player_video_display,
-                                        configuration->time_signal_player_display_resolution);
-        aras_player_init_audio_sink_bin(&player->audio_sink_b, configuration->time_signal_player_name,
-                                        configuration->time_signal_player_audio_output,
-                                        configuration->time_signal_player_audio_device,
-                                        configuration->time_signal_player_sample_rate,
-                                        configuration->time_signal_player_channels);
-        aras_player_init_video_sink_bin(&player->video_sink_b, configuration->time_signal_player_name,
-                                        configuration->time_signal_player_video_output,
-                                        configuration->time_signal_player_video_device,
-                                        configuration->time_signal_player_video_display,
-                                        configuration->time_signal_player_display_resolution);
-
-        /* Bind the audio sink bin and the video sink bin to the playbin */
-        g_object_set(player->playbin_a, "audio-sink", player->audio_sink_a.bin, NULL);
-        g_object_set(player->playbin_a, "video-sink", player->video_sink_a.bin, NULL);
-        g_object_set(player->playbin_b, "audio-sink", player->audio_sink_b.bin, NULL);
-        g_object_set(player->playbin_b, "video-sink", player->video_sink_b.bin, NULL);
-        
-        /* Enable property async-handling */
-        g_object_set(player->playbin_a, "async-handling", TRUE, NULL);
-        g_object_set(player->playbin_b, "async-handling", TRUE, NULL);
+        int unit;
 
-        /* Create the buses */
-        player->bus_a = gst_pipeline_get_bus(GST_PIPELINE(player->playbin_a));
-        player->bus_b = gst_pipeline_get_bus(GST_PIPELINE(player->playbin_b));
-        gst_bus_add_watch(player->bus_a, aras_player_callback_time_signal_player_a, player);
-        gst_bus_add_watch(player->bus_b, aras_player_callback_time_signal_player_b, player);
-        //gst_object_unref(player->bus_a);
-        //gst_object_unref(player->bus_b);
-
-        /* Set the volume */
-        g_object_set(player->playbin_a, "volume", player->volume_a, NULL);
-        g_object_set(player->playbin_b, "volume", player->volume_b, NULL);
-
-        /* Set state to GST_STATE_NULL */
-        gst_element_set_state(player->playbin_a, GST_STATE_READY);
-        gst_element_set_state(player->playbin_b, GST_STATE_READY);
+        /* Initialize current unit and the pool of decks */
+        player->current_unit = 0;
+        player->units = configuration->time_signal_player_decks;
+        player->callback_wake = NULL;
+        player->callback_wake_data = NULL;
+
+        /* Create the decks */
+        for (unit = 0; unit < player->units; unit++)
+                aras_player_init_deck(player,
+                                      unit,
+                                      configuration->time_signal_player_name,
+                                      configuration->time_signal_player_audio_output,
+                                      configuration->time_signal_player_audio_device,
+                                      configuration->time_signal_player_sample_rate,
+                                      configuration->time_signal_player_channels,
+                                      configuration->time_signal_player_resample_quality,
+                                      configuration->time_signal_player_video_output,
+                                      configuration->time_signal_player_video_device,
+                                      configuration->time_signal_player_video_display,
+                                      configuration->time_signal_player_display_resolution);
 
         return 0;
 }
 
 /**
- * This function sets the volume in a player.
+ * This function sets the volume in a player. A volume ramp in progress is
+ * cancelled.
  *
  * @param   player  Pointer to the player
  * @param   unit    The identifier of the player unit
@@ -518,18 +743,14 @@ int aras_player_init_time_signal_player(struct aras_player *player, struct aras_
  */
 void aras_player_set_volume(struct aras_player *player, int unit, float volume)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                player->volume_a = volume;
-                g_object_set(player->playbin_a, "volume", player->volume_a, NULL);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                player->volume_b = volume;
-                g_object_set(player->playbin_b, "volume", player->volume_b, NULL);
-                break;
-        default:
-                break;
-        }
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        deck->volume = volume;
+        gst_timed_value_control_source_unset_all(GST_TIMED_VALUE_CONTROL_SOURCE(deck->audio_sink.control));
+        g_object_set(deck->audio_sink.volume, "volume", (gdouble)volume, NULL);
 }
 
 /**
@@ -542,18 +763,59 @@ void aras_player_set_volume(struct aras_player *player, int unit, float volume)
  */
 void aras_player_set_volume_increment(struct aras_player *player, int unit, float slope, float limit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                player->volume_a += slope * (limit - player->volume_a);
-                g_object_set(player->playbin_a, "volume", player->volume_a, NULL);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                player->volume_b += slope * (limit - player->volume_b);
-                g_object_set(player->playbin_b, "volume", player->volume_b, NULL);
-                break;
-        default:
-                break;
+        float volume;
+
+        volume = aras_player_get_volume(player, unit);
+        aras_player_set_volume(player, unit, volume + slope * (limit - volume));
+}
+
+/**
+ * This function schedules a volume ramp in a player unit. The ramp goes from
+ * the current volume to the limit in the given time, following a table of
+ * progress weights at equal intervals, from 0 at the start to 1 at the end.
+ * The volume is interpolated for each sample by the pipeline, without further
+ * calls.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   limit   The final volume
+ * @param   time    The duration of the ramp in miliseconds
+ * @param   weights Pointer to the table of points + 1 progress weights
+ * @param   points  The number of intervals of the ramp
+ */
+void aras_player_set_volume_ramp(struct aras_player *player, int unit, float limit, long int time, const float *weights, int points)
+{
+        struct aras_player_deck *deck;
+        struct aras_player_sink *sink;
+        struct aras_player_status *status;
+        GstTimedValueControlSource *control;
+        GstClockTime start;
+        gdouble volume;
+        int k;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+        sink = &deck->audio_sink;
+        status = &deck->status;
+
+        /* Units not playing do not need a ramp */
+        if (status->state != ARAS_PLAYER_STATE_PLAYING || time <= 0 || points <= 0) {
+                aras_player_set_volume(player, unit, limit);
+                return;
         }
+
+        /* Control points are stream times, starting at the current position */
+        start = (GstClockTime)aras_player_status_get_position(status) * GST_MSECOND;
+        control = GST_TIMED_VALUE_CONTROL_SOURCE(sink->control);
+        if (!gst_control_source_get_value(sink->control, start, &volume))
+                volume = deck->volume;
+
+        gst_timed_value_control_source_unset_all(control);
+        for (k = 0; k < points; k++)
+                gst_timed_value_control_source_set(control, start + gst_util_uint64_scale(time * GST_MSECOND, k, points), volume + weights[k] * (limit - volume));
+        gst_timed_value_control_source_set(control, start + time * GST_MSECOND, limit);
+
+        deck->volume = limit;
 }
 
 /**
@@ -565,15 +827,66 @@ void aras_player_set_volume_increment(struct aras_player *player, int unit, floa
  */
 void aras_player_set_uri(struct aras_player *player, int unit, gchar *uri)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                g_object_set(player->playbin_a, "uri", uri, NULL);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                g_object_set(player->playbin_b, "uri", uri, NULL);
-                break;
-        default:
-                break;
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        g_object_set(deck->playbin, "uri", uri, NULL);
+}
+
+/**
+ * This function queues the URI to be played next in a player unit without a
+ * gap, reusing the playbin when the current media is about to finish. The URI
+ * replaces any URI queued before, NULL empties the queue.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   uri     A pointer to the URI string, NULL to empty the queue
+ * @return  0 if success, -1 if error
+ */
+int aras_player_set_next_uri(struct aras_player *player, int unit, gchar *uri)
+{
+        struct aras_player_deck *deck;
+        struct aras_player_queue *queue;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return -1;
+        queue = &deck->queue;
+
+        g_mutex_lock(&queue->lock);
+        g_free(queue->uri);
+        queue->uri = g_strdup(uri);
+        g_mutex_unlock(&queue->lock);
+
+        return 0;
+}
+
+/**
+ * This function requests a state change in a player unit without waiting for
+ * it. Asynchronous changes complete in the bus callbacks, which wake the
+ * engine. A failed change leaves the unit in GST_STATE_NULL.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   state   The requested state
+ */
+void aras_player_set_state(struct aras_player *player, int unit, GstState state)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        /* Stopped units drop the gapless queue */
+        if (state <= GST_STATE_READY)
+                aras_player_queue_reset(&deck->queue);
+
+        deck->playing = (state == GST_STATE_PLAYING);
+        if (aras_player_status_request(deck->playbin, &deck->status, state) == GST_STATE_CHANGE_FAILURE) {
+                deck->playing = 0;
+                aras_player_status_request(deck->playbin, &deck->status, GST_STATE_NULL);
+                aras_player_wake(player);
         }
 }
 
@@ -585,16 +898,7 @@ void aras_player_set_uri(struct aras_player *player, int unit, gchar *uri)
  */
 void aras_player_set_state_null(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                gst_element_set_state(player->playbin_a, GST_STATE_NULL);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-                break;
-        default:
-                break;
-        }
+        aras_player_set_state(player, unit, GST_STATE_NULL);
 }
 
 /**
@@ -605,53 +909,7 @@ void aras_player_set_state_null(struct aras_player *player, int unit)
  */
 void aras_player_set_state_ready(struct aras_player *player, int unit)
 {
-        GstState state;
-        GstState pending;
-
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                do {
-                        gst_element_get_state(player->playbin_a, &state, &pending, GST_CLOCK_TIME_NONE);
-                        g_usleep(1000);
-                } while (pending != GST_STATE_VOID_PENDING);
-                gst_element_set_state(player->playbin_a, GST_STATE_READY);
-                switch (gst_element_get_state(player->playbin_a, &state, &pending, GST_CLOCK_TIME_NONE)) {
-                case GST_STATE_CHANGE_SUCCESS:
-                        break;
-                case GST_STATE_CHANGE_ASYNC:
-                        break;
-                case GST_STATE_CHANGE_FAILURE:
-                        gst_element_set_state(player->playbin_a, GST_STATE_NULL);
-                        break;
-                default:
-                        gst_element_set_state(player->playbin_a, GST_STATE_NULL);
-                        break;
-                }
-                aras_player_message_check(player->bus_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                do {
-                        gst_element_get_state(player->playbin_b, &state, &pending, GST_CLOCK_TIME_NONE);
-                        g_usleep(1000);
-                } while (pending != GST_STATE_VOID_PENDING);
-                gst_element_set_state(player->playbin_b, GST_STATE_READY);
-                switch (gst_element_get_state(player->playbin_b, &state, &pending, GST_CLOCK_TIME_NONE)) {
-                case GST_STATE_CHANGE_SUCCESS:
-                        break;
-                case GST_STATE_CHANGE_ASYNC:
-                        break;
-                case GST_STATE_CHANGE_FAILURE:
-                        gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-                        break;
-                default:
-                        gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-                        break;
-                }
-                aras_player_message_check(player->bus_b);
-                break;
-        default:
-                break;
-        }
+        aras_player_set_state(player, unit, GST_STATE_READY);
 }
 
 /**
@@ -662,16 +920,7 @@ void aras_player_set_state_ready(struct aras_player *player, int unit)
  */
 void aras_player_set_state_paused(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                gst_element_set_state(player->playbin_a, GST_STATE_PAUSED);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                gst_element_set_state(player->playbin_b, GST_STATE_PAUSED);
-                break;
-        default:
-                break;
-        }
+        aras_player_set_state(player, unit, GST_STATE_PAUSED);
 }
 
 /**
@@ -682,53 +931,7 @@ void aras_player_set_state_paused(struct aras_player *player, int unit)
  */
 void aras_player_set_state_playing(struct aras_player *player, int unit)
 {
-        GstState state;
-        GstState pending;
-
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                do {
-                        gst_element_get_state(player->playbin_a, &state, &pending, GST_CLOCK_TIME_NONE);
-                        g_usleep(1000);
-                } while (pending != GST_STATE_VOID_PENDING);
-                gst_element_set_state(player->playbin_a, GST_STATE_PLAYING);
-                switch (gst_element_get_state(player->playbin_a, &state, &pending, GST_CLOCK_TIME_NONE)) {
-                case GST_STATE_CHANGE_SUCCESS:
-                        break;
-                case GST_STATE_CHANGE_ASYNC:
-                        break;
-                case GST_STATE_CHANGE_FAILURE:
-                        gst_element_set_state(player->playbin_a, GST_STATE_NULL);
-                        break;
-                default:
-                        gst_element_set_state(player->playbin_a, GST_STATE_NULL);
-                        break;
-                }
-                aras_player_message_check(player->bus_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                do {
-                        gst_element_get_state(player->playbin_b, &state, &pending, GST_CLOCK_TIME_NONE);
-                        g_usleep(1000);
-                } while (pending != GST_STATE_VOID_PENDING);
-                gst_element_set_state(player->playbin_b, GST_STATE_PLAYING);
-                switch (gst_element_get_state(player->playbin_b, &state, &pending, GST_CLOCK_TIME_NONE)) {
-                case GST_STATE_CHANGE_SUCCESS:
-                        break;
-                case GST_STATE_CHANGE_ASYNC:
-                        break;
-                case GST_STATE_CHANGE_FAILURE:
-                        gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-                        break;
-                default:
-                        gst_element_set_state(player->playbin_b, GST_STATE_NULL);
-                        break;
-                }
-                aras_player_message_check(player->bus_b);
-                break;
-        default:
-                break;
-        }
+        aras_player_set_state(player, unit, GST_STATE_PLAYING);
 }
 
 /**
@@ -743,14 +946,69 @@ void aras_player_set_current_unit(struct aras_player *player, int unit)
 }
 
 /**
- * This function sets the player current unit.
+ * This function sets the function called when a player event requires the
+ * attention of the engine, such as the end of the stream or an error.
+ *
+ * @param   player          Pointer to the player
+ * @param   callback_wake   Pointer to the wake up function, NULL to disable it
+ * @param   data            Pointer to the data passed to the wake up function
+ */
+void aras_player_set_callback_wake(struct aras_player *player, void (*callback_wake)(void *data), void *data)
+{
+        player->callback_wake = callback_wake;
+        player->callback_wake_data = data;
+}
+
+/**
+ * This function allocates a free deck of the pool of a player. Stopped decks
+ * are preferred, they are reused without a state change. The deck keeps its
+ * pipeline while allocated and after being released.
+ *
+ * @param   player  Pointer to the player
+ * @return  The identifier of the player unit, ARAS_PLAYER_UNIT_NONE if every
+ *          deck is allocated
+ */
+int aras_player_alloc_unit(struct aras_player *player)
+{
+        int unit;
+        int free_unit;
+
+        free_unit = ARAS_PLAYER_UNIT_NONE;
+        for (unit = 0; unit < player->units; unit++) {
+                if (player->deck[unit].allocated)
+                        continue;
+                if (player->deck[unit].status.state == ARAS_PLAYER_STATE_STOP) {
+                        free_unit = unit;
+                        break;
+                }
+                if (free_unit == ARAS_PLAYER_UNIT_NONE)
+                        free_unit = unit;
+        }
+
+        if (free_unit != ARAS_PLAYER_UNIT_NONE)
+                player->deck[free_unit].allocated = 1;
+
+        return free_unit;
+}
+
+/**
+ * This function releases a deck of the pool of a player. The deck is muted
+ * and stopped in GST_STATE_READY, so that it is reused without building its
+ * pipeline again.
  *
  * @param   player  Pointer to the player
  * @param   unit    The identifier of the player unit
  */
-void aras_player_swap_current_unit(struct aras_player *player)
+void aras_player_release_unit(struct aras_player *player, int unit)
 {
-        player->current_unit = (player->current_unit + 1) % 2;
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        aras_player_set_volume(player, unit, 0);
+        aras_player_set_state_ready(player, unit);
+        deck->allocated = 0;
 }
 
 /**
@@ -762,18 +1020,18 @@ void aras_player_swap_current_unit(struct aras_player *player)
  */
 float aras_player_get_volume(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                return(player->volume_a);
-        case ARAS_PLAYER_UNIT_B:
-                return(player->volume_b);
-        default:
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
                 return 0;
-        }
+
+        return deck->volume;
 }
 
 /**
- * This function gets the player state.
+ * This function gets the player state. The state is read from the status kept
+ * by the bus callbacks, units changing state are reported as
+ * ARAS_PLAYER_STATE_OTHER.
  *
  * @param   player  Pointer to the player
  * @param   unit    The identifier of the player unit
@@ -781,37 +1039,32 @@ float aras_player_get_volume(struct aras_player *player, int unit)
  */
 void aras_player_get_state(struct aras_player *player, int unit, int *state)
 {
-        GstState gst_state;
+        struct aras_player_deck *deck;
 
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                gst_element_get_state(player->playbin_a, &gst_state, NULL, GST_CLOCK_TIME_NONE);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                gst_element_get_state(player->playbin_b, &gst_state, NULL, GST_CLOCK_TIME_NONE);
-                break;
-        default:
-                gst_element_get_state(player->playbin_a, &gst_state, NULL, GST_CLOCK_TIME_NONE);
-                break;
-        }
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                deck = &player->deck[0];
 
-        switch (gst_state) {
-        case GST_STATE_NULL:
-                *state = ARAS_PLAYER_STATE_ERROR;
-                break;
-        case GST_STATE_READY:
-                *state = ARAS_PLAYER_STATE_STOP;
-                break;
-        case GST_STATE_PLAYING:
-                *state = ARAS_PLAYER_STATE_PLAYING;
-                break;
-        case GST_STATE_PAUSED:
-                *state = ARAS_PLAYER_STATE_OTHER;
-                break;
-        default:
-                *state = ARAS_PLAYER_STATE_OTHER;
-                break;
-        }
+        *state = deck->status.state;
+}
+
+/**
+ * This function checks whether a player unit is prerolled, that is, paused
+ * with the media ready to start playing.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  1 if the unit is prerolled, 0 otherwise
+ */
+int aras_player_get_prerolled(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+        struct aras_player_status *status;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+        status = &deck->status;
+
+        return status->prerolled && status->target == GST_STATE_PAUSED;
 }
 
 /**
@@ -823,14 +1076,14 @@ void aras_player_get_state(struct aras_player *player, int unit, int *state)
  */
 int aras_player_get_buffer_percent(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                return player->buffer_percent_a;
-        case ARAS_PLAYER_UNIT_B:
-                return player->buffer_percent_b;
-        default:
+        struct aras_player_deck *deck;
+        struct aras_player_status *status;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
                 return 0;
-        }
+        status = &deck->status;
+
+        return status->buffer_percent;
 }
 
 /**
@@ -844,9 +1097,38 @@ int aras_player_get_current_unit(struct aras_player *player)
         return player->current_unit;
 }
 
+/**
+ * This function returns the number of decks in the pool of a player.
+ *
+ * @param   player  Pointer to the player
+ * @return  The number of player units
+ */
+int aras_player_get_units(struct aras_player *player)
+{
+        return player->units;
+}
+
+/**
+ * This function checks whether a deck of the pool of a player is allocated.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  1 if the unit is allocated, 0 otherwise
+ */
+int aras_player_get_allocated(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        return deck->allocated;
+}
+
 /**
  * This function returns the duration in miliseconds of the file being played in
- * a player structure.
+ * a player structure. The duration is read from the status kept by the bus
+ * callbacks.
  *
  * @param   player  Pointer to the player
  * @param   unit    The identifier of the player unit
@@ -854,35 +1136,23 @@ int aras_player_get_current_unit(struct aras_player *player)
  */
 long int aras_player_get_duration(struct aras_player *player, int unit)
 {
-        GstState state;
-        gint64 duration;
+        struct aras_player_deck *deck;
+        struct aras_player_status *status;
 
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                gst_element_get_state(player->playbin_a, &state, NULL, GST_CLOCK_TIME_NONE);
-                if (state == GST_STATE_PLAYING)
-                        gst_element_query_duration(player->playbin_a, GST_FORMAT_TIME, &duration);
-                else
-                        duration = 0;
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                gst_element_get_state(player->playbin_b, &state, NULL, GST_CLOCK_TIME_NONE);
-                if (state == GST_STATE_PLAYING)
-                        gst_element_query_duration(player->playbin_b, GST_FORMAT_TIME, &duration);
-                else
-                        duration = 0;
-                break;
-        default:
-                        duration = 0;
-                break;
-        }
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+        status = &deck->status;
 
-        return (long int)(lldiv(duration, 1000000).quot);
+        if (status->state != ARAS_PLAYER_STATE_PLAYING)
+                return 0;
+
+        return status->duration;
 }
 
 /**
  * This function returns the position in miliseconds of the file being played in
- * a player structure.
+ * a player structure. The position is extrapolated with the pipeline clock
+ * from the last position recorded by the bus callbacks.
  *
  * @param   player  Pointer to the player
  * @param   unit    The identifier of the player unit
@@ -890,28 +1160,41 @@ long int aras_player_get_duration(struct aras_player *player, int unit)
  */
 long int aras_player_get_position(struct aras_player *player, int unit)
 {
-        GstState state;
-        gint64 position;
+        struct aras_player_deck *deck;
+        struct aras_player_status *status;
 
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                gst_element_get_state(player->playbin_a, &state, NULL, GST_CLOCK_TIME_NONE);
-                if (state == GST_STATE_PLAYING)
-                        gst_element_query_position(player->playbin_a, GST_FORMAT_TIME, &position);
-                else
-                        position = 0;
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                gst_element_get_state(player->playbin_b, &state, NULL, GST_CLOCK_TIME_NONE);
-                if (state == GST_STATE_PLAYING)
-                        gst_element_query_position(player->playbin_b, GST_FORMAT_TIME, &position);
-                else
-                        position = 0;
-                break;
-        default:
-                        position = 0;
-                break;
-        }
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+        status = &deck->status;
+
+        if (status->state != ARAS_PLAYER_STATE_PLAYING)
+                return 0;
+
+        return aras_player_status_get_position(status);
+}
+
+/**
+ * This function returns the number of queued URIs that have started playing
+ * in a player unit since the last call.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The number of queued URIs started
+ */
+int aras_player_take_next_started(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+        struct aras_player_queue *queue;
+        int started;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+        queue = &deck->queue;
+
+        g_mutex_lock(&queue->lock);
+        started = queue->started;
+        queue->started = 0;
+        g_mutex_unlock(&queue->lock);
 
-        return (long int)(lldiv(position, 1000000).quot);
+        return started;
 }
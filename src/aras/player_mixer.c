@@ -0,0 +1,1035 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Source file for the ARAS Radio Automation System. Functions for the mixer
+ * player module. The player units are decoding bins attached to an audio
+ * mixer in a single pipeline, with one audio sink and one clock, so that both
+ * sides of a crossfade are mixed sample aligned.
+ */
+
+#include <gst/gst.h>
+#include <gst/controller/controller.h>
+#include <aras/configuration.h>
+#include <aras/player_mixer.h>
+
+/**
+ * This function calls the wake up function of a player, if any, so that the
+ * engine working with the player handles an event without delay.
+ *
+ * @param   player  Pointer to the player
+ */
+void aras_player_wake(struct aras_player *player)
+{
+        if (player->callback_wake != NULL)
+                player->callback_wake(player->callback_wake_data);
+}
+
+/**
+ * This function returns an input of a player.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The input, NULL if the unit does not exist
+ */
+struct aras_player_input *aras_player_get_input(struct aras_player *player, int unit)
+{
+        if (unit < 0 || unit >= player->units)
+                return NULL;
+
+        return &player->input[unit];
+}
+
+/**
+ * This function returns the input of a player containing the source of a bus
+ * message.
+ *
+ * @param   player  Pointer to the player
+ * @param   src     Pointer to the source of the message
+ * @return  The input, NULL if the source is not in an input
+ */
+struct aras_player_input *aras_player_get_input_by_src(struct aras_player *player, GstObject *src)
+{
+        int unit;
+
+        for (unit = 0; unit < player->units; unit++) {
+                if (player->input[unit].bin == NULL)
+                        continue;
+                if (src == GST_OBJECT(player->input[unit].bin) || gst_object_has_as_ancestor(src, GST_OBJECT(player->input[unit].bin)))
+                        return &player->input[unit];
+        }
+
+        return NULL;
+}
+
+/**
+ * This function returns the running time of the pipeline of a player.
+ *
+ * @param   player  Pointer to the player
+ * @return  The running time, GST_CLOCK_TIME_NONE if the pipeline has no clock
+ */
+GstClockTime aras_player_get_running_time(struct aras_player *player)
+{
+        GstClock *clock;
+        GstClockTime now;
+
+        if ((clock = gst_element_get_clock(player->pipeline)) == NULL)
+                return GST_CLOCK_TIME_NONE;
+
+        now = gst_clock_get_time(clock);
+        gst_object_unref(clock);
+
+        if (!GST_CLOCK_TIME_IS_VALID(now) || now < gst_element_get_base_time(player->pipeline))
+                return GST_CLOCK_TIME_NONE;
+
+        return now - gst_element_get_base_time(player->pipeline);
+}
+
+/**
+ * This function is the callback function for the pads of a decoding bin. It
+ * links the decoded audio to the decoding chain of the input.
+ *
+ * @param   decodebin   Pointer to the decoding bin
+ * @param   pad         Pointer to the new pad
+ * @param   data        Pointer to the first element of the decoding chain
+ */
+void aras_player_callback_pad_added(GstElement *decodebin, GstPad *pad, gpointer data)
+{
+        GstPad *sink;
+
+        sink = gst_element_get_static_pad(GST_ELEMENT(data), "sink");
+        if (!gst_pad_is_linked(sink))
+                gst_pad_link(pad, sink);
+        gst_object_unref(sink);
+}
+
+/**
+ * This function is the probe holding the first buffer of an input until the
+ * input is started. It is called from a streaming thread, the input is
+ * notified in the bus callback.
+ *
+ * @param   pad     Pointer to the pad
+ * @param   info    Pointer to the probe information
+ * @param   data    Pointer to the decoding bin of the input
+ * @return  GST_PAD_PROBE_OK, so that the data stays blocked
+ */
+GstPadProbeReturn aras_player_probe_block(GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+        gst_element_post_message(GST_ELEMENT(data), gst_message_new_application(GST_OBJECT(data), gst_structure_new_empty("aras-prerolled")));
+
+        return GST_PAD_PROBE_OK;
+}
+
+/**
+ * This function is the probe for the events of an input. The end of stream of
+ * an input is dropped, so that it does not reach the mixer, and notified in
+ * the bus callback.
+ *
+ * @param   pad     Pointer to the pad
+ * @param   info    Pointer to the probe information
+ * @param   data    Pointer to the decoding bin of the input
+ * @return  GST_PAD_PROBE_DROP for the end of stream, GST_PAD_PROBE_OK otherwise
+ */
+GstPadProbeReturn aras_player_probe_event(GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+        if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) != GST_EVENT_EOS)
+                return GST_PAD_PROBE_OK;
+
+        gst_element_post_message(GST_ELEMENT(data), gst_message_new_application(GST_OBJECT(data), gst_structure_new_empty("aras-eos")));
+
+        return GST_PAD_PROBE_DROP;
+}
+
+/**
+ * This function queries the duration of the media in an input.
+ *
+ * @param   input   Pointer to the input
+ */
+void aras_player_input_query_duration(struct aras_player_input *input)
+{
+        gint64 duration;
+
+        if (input->src != NULL && gst_pad_query_duration(input->src, GST_FORMAT_TIME, &duration) && duration > 0)
+                input->duration = (long int)(duration / GST_MSECOND);
+        else
+                input->duration = 0;
+}
+
+/**
+ * This function detaches an input from the mixer and destroys its decoding
+ * bin.
+ *
+ * @param   player  Pointer to the player
+ * @param   input   Pointer to the input
+ */
+void aras_player_input_detach(struct aras_player *player, struct aras_player_input *input)
+{
+        if (input->bin == NULL)
+                return;
+
+        /* Stop the streaming threads, releasing blocked data */
+        gst_element_set_state(input->bin, GST_STATE_NULL);
+
+        if (input->mixer_pad != NULL) {
+                gst_object_remove_control_binding(GST_OBJECT(input->mixer_pad), input->binding);
+                input->binding = NULL;
+                gst_pad_unlink(input->ghost_pad, input->mixer_pad);
+                gst_element_release_request_pad(player->mixer, input->mixer_pad);
+                gst_object_unref(input->mixer_pad);
+                input->mixer_pad = NULL;
+        }
+
+        gst_object_unref(input->src);
+        gst_bin_remove(GST_BIN(player->pipeline), input->bin);
+        input->bin = NULL;
+        input->src = NULL;
+        input->ghost_pad = NULL;
+        input->block_probe = 0;
+        input->prerolled = 0;
+        input->duration = 0;
+        input->buffer_percent = 0;
+}
+
+/**
+ * This function creates the decoding bin of an input and adds it to the
+ * pipeline. The decoded data is held until the input is started.
+ *
+ * @param   player  Pointer to the player
+ * @param   input   Pointer to the input
+ * @return  0 if success, -1 if error
+ */
+int aras_player_input_attach(struct aras_player *player, struct aras_player_input *input)
+{
+        GstElement *decodebin;
+        GstElement *convert;
+        GstElement *resample;
+        GstCaps *caps;
+
+        decodebin = gst_element_factory_make("uridecodebin", NULL);
+        convert = gst_element_factory_make("audioconvert", NULL);
+        resample = gst_element_factory_make("audioresample", NULL);
+        if (decodebin == NULL || convert == NULL || resample == NULL) {
+                if (decodebin != NULL)
+                        gst_object_unref(decodebin);
+                if (convert != NULL)
+                        gst_object_unref(convert);
+                if (resample != NULL)
+                        gst_object_unref(resample);
+                return -1;
+        }
+
+        /* Decode only the audio streams */
+        caps = gst_caps_new_empty_simple("audio/x-raw");
+        g_object_set(decodebin, "uri", input->uri, "caps", caps, "expose-all-streams", FALSE, NULL);
+        gst_caps_unref(caps);
+        g_signal_connect(decodebin, "pad-added", G_CALLBACK(aras_player_callback_pad_added), convert);
+
+        input->bin = gst_bin_new(NULL);
+        gst_bin_add_many(GST_BIN(input->bin), decodebin, convert, resample, NULL);
+        gst_element_link(convert, resample);
+        g_object_set(resample, "quality", player->resample_quality, NULL);
+
+        input->src = gst_element_get_static_pad(resample, "src");
+        input->ghost_pad = gst_ghost_pad_new("src", input->src);
+        gst_pad_set_active(input->ghost_pad, TRUE);
+        gst_element_add_pad(input->bin, input->ghost_pad);
+
+        input->block_probe = gst_pad_add_probe(input->src, GST_PAD_PROBE_TYPE_BLOCK | GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+                                               aras_player_probe_block, input->bin, NULL);
+        gst_pad_add_probe(input->src, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, aras_player_probe_event, input->bin, NULL);
+
+        gst_bin_add(GST_BIN(player->pipeline), input->bin);
+        if (!gst_element_sync_state_with_parent(input->bin)) {
+                aras_player_input_detach(player, input);
+                return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * This function starts a prerolled input. The input is linked to the mixer
+ * and its running time is shifted so that it starts now.
+ *
+ * @param   player  Pointer to the player
+ * @param   input   Pointer to the input
+ */
+void aras_player_input_start(struct aras_player *player, struct aras_player_input *input)
+{
+        GstClockTime now;
+
+        input->mixer_pad = gst_element_get_request_pad(player->mixer, "sink_%u");
+        g_object_set(input->mixer_pad, "volume", (gdouble)input->volume, NULL);
+        input->binding = gst_direct_control_binding_new_absolute(GST_OBJECT(input->mixer_pad), "volume", input->control);
+        gst_object_add_control_binding(GST_OBJECT(input->mixer_pad), input->binding);
+        gst_pad_link(input->ghost_pad, input->mixer_pad);
+
+        now = aras_player_get_running_time(player);
+        input->start_time = (GST_CLOCK_TIME_IS_VALID(now) ? now : 0) + ARAS_PLAYER_MIXER_START_DELAY * GST_MSECOND;
+        gst_pad_set_offset(input->src, (gint64)input->start_time);
+
+        gst_pad_remove_probe(input->src, input->block_probe);
+        input->block_probe = 0;
+        input->prerolled = 0;
+        input->state = ARAS_PLAYER_STATE_PLAYING;
+}
+
+/**
+ * This function is the bus callback function for a player.
+ *
+ * @param   bus     Pointer to the bus
+ * @param   msg     Pointer to the message
+ * @param   data    Pointer to the callback data
+ */
+gboolean aras_player_callback(GstBus *bus, GstMessage *msg, gpointer data)
+{
+        struct aras_player *player;
+        struct aras_player_input *input;
+        int unit;
+
+        player = (struct aras_player*)data;
+        input = aras_player_get_input_by_src(player, GST_MESSAGE_SRC(msg));
+
+        switch (GST_MESSAGE_TYPE(msg)) {
+        case GST_MESSAGE_APPLICATION:
+                if (input == NULL || GST_MESSAGE_SRC(msg) != GST_OBJECT(input->bin))
+                        break;
+                if (gst_message_has_name(msg, "aras-prerolled")) {
+                        if (input->block_probe == 0 || input->prerolled)
+                                break;
+                        input->prerolled = 1;
+                        aras_player_input_query_duration(input);
+                        if (input->target == GST_STATE_PLAYING)
+                                aras_player_input_start(player, input);
+                        aras_player_wake(player);
+                } else if (gst_message_has_name(msg, "aras-eos")) {
+                        aras_player_input_detach(player, input);
+                        input->state = ARAS_PLAYER_STATE_ERROR;
+                        aras_player_wake(player);
+                }
+                break;
+        case GST_MESSAGE_ERROR:
+                /* An error in the output stops every input */
+                if (input != NULL) {
+                        aras_player_input_detach(player, input);
+                        input->state = ARAS_PLAYER_STATE_ERROR;
+                } else {
+                        for (unit = 0; unit < player->units; unit++) {
+                                aras_player_input_detach(player, &player->input[unit]);
+                                player->input[unit].state = ARAS_PLAYER_STATE_ERROR;
+                        }
+                }
+                aras_player_wake(player);
+                break;
+        case GST_MESSAGE_DURATION_CHANGED:
+                if (input != NULL) {
+                        aras_player_input_query_duration(input);
+                        aras_player_wake(player);
+                }
+                break;
+        case GST_MESSAGE_BUFFERING:
+                /* The shared pipeline is not paused, buffering is only reported */
+                if (input != NULL)
+                        gst_message_parse_buffering(msg, &input->buffer_percent);
+                break;
+        default:
+                break;
+        }
+        return TRUE;
+}
+
+/**
+ * This function returns an audio sink.
+ *
+ * @param   name            Pointer to the name string
+ * @param   audio_output    Value for the audio output
+ * @param   audio_device    Pointer to the audio device string
+ * @return  The audio sink
+ */
+GstElement *aras_player_init_audio_sink(char *name, int audio_output, char *audio_device)
+{
+        GstElement *sink;
+
+        switch (audio_output) {
+        case ARAS_CONFIGURATION_MODE_AUDIO_AUTO:
+                sink = gst_element_factory_make("autoaudiosink", name);
+                break;
+        case ARAS_CONFIGURATION_MODE_AUDIO_PULSEAUDIO:
+                sink = gst_element_factory_make("pulsesink", name);
+                g_object_set(G_OBJECT(sink), "device", audio_device, NULL);
+                break;
+        case ARAS_CONFIGURATION_MODE_AUDIO_ALSA:
+                sink = gst_element_factory_make("alsasink", name);
+                g_object_set(G_OBJECT(sink), "device", audio_device, NULL);
+                break;
+        case ARAS_CONFIGURATION_MODE_AUDIO_JACK:
+                sink = gst_element_factory_make("jackaudiosink", name);
+                g_object_set(G_OBJECT(sink), "server", audio_device, NULL);
+                g_object_set(G_OBJECT(sink), "connect", 0, NULL);
+                break;
+        case ARAS_CONFIGURATION_MODE_AUDIO_OSS:
+                sink = gst_element_factory_make("osssink", name);
+                g_object_set(G_OBJECT(sink), "device", audio_device, NULL);
+                break;
+        case ARAS_CONFIGURATION_MODE_AUDIO_OSS4:
+                sink = gst_element_factory_make("oss4sink", name);
+                g_object_set(G_OBJECT(sink), "device", audio_device, NULL);
+                break;
+        case ARAS_CONFIGURATION_MODE_AUDIO_OPENAL:
+                sink = gst_element_factory_make("openalsink", name);
+                g_object_set(G_OBJECT(sink), "device", audio_device, NULL);
+                break;
+        case ARAS_CONFIGURATION_MODE_AUDIO_FILE:
+                sink = gst_element_factory_make("filesink", name);
+                g_object_set(G_OBJECT(sink), "location", audio_device, NULL);
+                g_object_set(G_OBJECT(sink), "buffer-mode", 1, NULL);
+                g_object_set(G_OBJECT(sink), "buffer-size", 1000000, NULL);
+                break;
+        default:
+                sink = gst_element_factory_make("autoaudiosink", name);
+                break;
+        }
+        return sink;
+}
+
+/**
+ * This function initializes a player structure. The pipeline mixes the inputs
+ * with a silent source, which keeps the output and the clock running while no
+ * input is playing. Video is not supported and the video settings are
+ * ignored.
+ *
+ * @param   player              Pointer to the player
+ * @param   name                Pointer to the name string
+ * @param   audio_output        Value for the audio output
+ * @param   audio_device        Pointer to the audio device string
+ * @param   audio_sample_rate   Value for the sample rate
+ * @param   audio_channels      Value for the number of channels
+ * @param   video_output        Value for the video output
+ * @param   video_device        Pointer to the video device string
+ * @param   video_display       Pointer to the video display string
+ * @param   video_resolution    Array containing the screen resolution
+ * @return  0 if success, -1 if error
+ */
+int aras_player_init(struct aras_player *player,
+                     char *name,
+                     int audio_output,
+                     char *audio_device,
+                     int audio_sample_rate,
+                     int audio_channels,
+                     int video_output,
+                     char *video_device,
+                     char *video_display,
+                     int video_resolution[])
+{
+        int unit;
+
+        /* Initialize GStreamer */
+        gst_init(NULL, NULL);
+
+        /* Initialize current unit and inputs */
+        player->current_unit = 0;
+        player->units = ARAS_PLAYER_UNITS;
+        player->resample_quality = ARAS_PLAYER_RESAMPLE_QUALITY;
+        player->callback_wake = NULL;
+        player->callback_wake_data = NULL;
+        for (unit = 0; unit < ARAS_PLAYER_MAX_UNITS; unit++) {
+                player->input[unit].allocated = 0;
+                player->input[unit].uri[0] = '\0';
+                player->input[unit].volume = 0;
+                player->input[unit].bin = NULL;
+                player->input[unit].src = NULL;
+                player->input[unit].ghost_pad = NULL;
+                player->input[unit].mixer_pad = NULL;
+                player->input[unit].control = gst_interpolation_control_source_new();
+                g_object_set(player->input[unit].control, "mode", GST_INTERPOLATION_MODE_LINEAR, NULL);
+                player->input[unit].binding = NULL;
+                player->input[unit].block_probe = 0;
+                player->input[unit].state = ARAS_PLAYER_STATE_STOP;
+                player->input[unit].target = GST_STATE_READY;
+                player->input[unit].prerolled = 0;
+                player->input[unit].duration = 0;
+                player->input[unit].start_time = 0;
+                player->input[unit].buffer_percent = 0;
+        }
+
+        /* Create the pipeline */
+        player->pipeline = gst_pipeline_new(name);
+        player->source = gst_element_factory_make("audiotestsrc", NULL);
+        player->mixer = gst_element_factory_make("audiomixer", NULL);
+        player->convert = gst_element_factory_make("audioconvert", NULL);
+        player->sink = aras_player_init_audio_sink(name, audio_output, audio_device);
+        if (player->pipeline == NULL || player->source == NULL || player->mixer == NULL || player->convert == NULL || player->sink == NULL) {
+                fprintf(stderr, "aras: unable to create the mixer pipeline\n");
+                return -1;
+        }
+
+        g_object_set(player->source, "is-live", TRUE, NULL);
+        gst_util_set_object_arg(G_OBJECT(player->source), "wave", "silence");
+
+        /* Link the elements, the mixer output has the configured format */
+        gst_bin_add_many(GST_BIN(player->pipeline), player->source, player->mixer, player->convert, player->sink, NULL);
+        player->caps = gst_caps_new_simple("audio/x-raw",
+                                           "channels",
+                                           G_TYPE_INT,
+                                           audio_channels,
+                                           "rate",
+                                           G_TYPE_INT,
+                                           audio_sample_rate,
+                                           NULL);
+        gst_element_link(player->source, player->mixer);
+        gst_element_link_filtered(player->mixer, player->convert, player->caps);
+        gst_element_link(player->convert, player->sink);
+
+        /* Create the bus */
+        player->bus = gst_pipeline_get_bus(GST_PIPELINE(player->pipeline));
+        gst_bus_add_watch(player->bus, aras_player_callback, player);
+
+        /* The pipeline plays all the time, inputs are attached and detached */
+        gst_element_set_state(player->pipeline, GST_STATE_PLAYING);
+
+        return 0;
+}
+
+/**
+ * This function initializes a player structure with the block player
+ * configuration.
+ *
+ * @param   player          Pointer to the player
+ * @param   configuration   Pointer to the configuration
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_player_init_block_player(struct aras_player *player, struct aras_configuration *configuration)
+{
+        if (aras_player_init(player,
+                             configuration->block_player_name,
+                             configuration->block_player_audio_output,
+                             configuration->block_player_audio_device,
+                             configuration->block_player_sample_rate,
+                             configuration->block_player_channels,
+                             configuration->block_player_video_output,
+                             configuration->block_player_video_device,
+                             configuration->block_player_video_display,
+                             configuration->block_player_display_resolution) == -1)
+                return -1;
+
+        player->units = configuration->block_player_decks;
+        player->resample_quality = configuration->block_player_resample_quality;
+
+        return 0;
+}
+
+/**
+ * This function initializes a player structure with the time signal player
+ * configuration.
+ *
+ * @param   player          Pointer to the player
+ * @param   configuration   Pointer to the configuration
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_player_init_time_signal_player(struct aras_player *player, struct aras_configuration *configuration)
+{
+        if (aras_player_init(player,
+                             configuration->time_signal_player_name,
+                             configuration->time_signal_player_audio_output,
+                             configuration->time_signal_player_audio_device,
+                             configuration->time_signal_player_sample_rate,
+                             configuration->time_signal_player_channels,
+                             configuration->time_signal_player_video_output,
+                             configuration->time_signal_player_video_device,
+                             configuration->time_signal_player_video_display,
+                             configuration->time_signal_player_display_resolution) == -1)
+                return -1;
+
+        player->units = configuration->time_signal_player_decks;
+        player->resample_quality = configuration->time_signal_player_resample_quality;
+
+        return 0;
+}
+
+/**
+ * This function sets the volume in a player. A volume ramp in progress is
+ * cancelled.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   volume  The volume value
+ */
+void aras_player_set_volume(struct aras_player *player, int unit, float volume)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        input->volume = volume;
+        gst_timed_value_control_source_unset_all(GST_TIMED_VALUE_CONTROL_SOURCE(input->control));
+        if (input->mixer_pad != NULL)
+                g_object_set(input->mixer_pad, "volume", (gdouble)input->volume, NULL);
+}
+
+/**
+ * This function sets a given volume increment in a player.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   slope   The slope of the volume curve
+ * @param   limit   The asymptotic limit for the volume
+ */
+void aras_player_set_volume_increment(struct aras_player *player, int unit, float slope, float limit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        aras_player_set_volume(player, unit, input->volume + slope * (limit - input->volume));
+}
+
+/**
+ * This function schedules a volume ramp in a player unit. The ramp goes from
+ * the current volume to the limit in the given time, following a table of
+ * progress weights at equal intervals, from 0 at the start to 1 at the end.
+ * The mixer applies the volume of each buffer without further calls.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   limit   The final volume
+ * @param   time    The duration of the ramp in miliseconds
+ * @param   weights Pointer to the table of points + 1 progress weights
+ * @param   points  The number of intervals of the ramp
+ */
+void aras_player_set_volume_ramp(struct aras_player *player, int unit, float limit, long int time, const float *weights, int points)
+{
+        struct aras_player_input *input;
+        GstTimedValueControlSource *control;
+        GstClockTime start;
+        gdouble volume;
+        int k;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        /* Inputs not mixed do not need a ramp */
+        if (input->mixer_pad == NULL || time <= 0 || points <= 0) {
+                aras_player_set_volume(player, unit, limit);
+                return;
+        }
+
+        /* Control points are stream times of the input, starting at the current position */
+        start = (GstClockTime)aras_player_get_position(player, unit) * GST_MSECOND;
+        control = GST_TIMED_VALUE_CONTROL_SOURCE(input->control);
+        if (!gst_control_source_get_value(input->control, start, &volume))
+                volume = input->volume;
+
+        gst_timed_value_control_source_unset_all(control);
+        for (k = 0; k < points; k++)
+                gst_timed_value_control_source_set(control, start + gst_util_uint64_scale(time * GST_MSECOND, k, points), volume + weights[k] * (limit - volume));
+        gst_timed_value_control_source_set(control, start + time * GST_MSECOND, limit);
+
+        input->volume = limit;
+}
+
+/**
+ * This function queues the URI to be played next in a player unit without a
+ * gap. Inputs of the mixer are
+ * started one by one with their own offset, so there is no gapless queue and
+ * the engine crossfades consecutive media.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   uri     A pointer to the URI string, NULL to empty the queue
+ * @return  -1, gapless playback is not supported
+ */
+int aras_player_set_next_uri(struct aras_player *player, int unit, gchar *uri)
+{
+        return -1;
+}
+
+/**
+ * This function sets the URI in a player. An input holding another URI is
+ * detached.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   uri     A pointer to the URI string
+ */
+void aras_player_set_uri(struct aras_player *player, int unit, gchar *uri)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        if (input->bin != NULL && strcmp(input->uri, uri) != 0) {
+                aras_player_input_detach(player, input);
+                input->state = ARAS_PLAYER_STATE_STOP;
+                input->target = GST_STATE_READY;
+        }
+
+        g_strlcpy(input->uri, uri, ARAS_PLAYER_MAX_URI);
+}
+
+/**
+ * This function sets the player state to GST_STATE_NULL.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_state_null(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        aras_player_input_detach(player, input);
+        input->state = ARAS_PLAYER_STATE_ERROR;
+        input->target = GST_STATE_NULL;
+}
+
+/**
+ * This function sets the player state to GST_STATE_READY.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_state_ready(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        aras_player_input_detach(player, input);
+        input->state = ARAS_PLAYER_STATE_STOP;
+        input->target = GST_STATE_READY;
+}
+
+/**
+ * This function sets the player state to GST_STATE_PAUSED, that is, it
+ * prerolls the input without starting it. A started input is prerolled again
+ * from the beginning.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_state_paused(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        if (input->mixer_pad != NULL)
+                aras_player_input_detach(player, input);
+
+        input->target = GST_STATE_PAUSED;
+        input->state = ARAS_PLAYER_STATE_OTHER;
+        if (input->bin == NULL && aras_player_input_attach(player, input) == -1) {
+                input->state = ARAS_PLAYER_STATE_ERROR;
+                aras_player_wake(player);
+        }
+}
+
+/**
+ * This function sets the player state to GST_STATE_PLAYING. A prerolled input
+ * starts immediately, otherwise it starts in the bus callback once prerolled.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_state_playing(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        if (input->mixer_pad != NULL)
+                return;
+
+        input->target = GST_STATE_PLAYING;
+        input->state = ARAS_PLAYER_STATE_OTHER;
+        if (input->bin == NULL && aras_player_input_attach(player, input) == -1) {
+                input->state = ARAS_PLAYER_STATE_ERROR;
+                aras_player_wake(player);
+                return;
+        }
+
+        if (input->prerolled)
+                aras_player_input_start(player, input);
+}
+
+/**
+ * This function sets the player current unit.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_current_unit(struct aras_player *player, int unit)
+{
+        player->current_unit = unit;
+}
+
+/**
+ * This function sets the function called when a player event requires the
+ * attention of the engine, such as the end of the stream or an error.
+ *
+ * @param   player          Pointer to the player
+ * @param   callback_wake   Pointer to the wake up function, NULL to disable it
+ * @param   data            Pointer to the data passed to the wake up function
+ */
+void aras_player_set_callback_wake(struct aras_player *player, void (*callback_wake)(void *data), void *data)
+{
+        player->callback_wake = callback_wake;
+        player->callback_wake_data = data;
+}
+
+/**
+ * This function allocates a free input of the pool of a player, stopped
+ * inputs first.
+ *
+ * @param   player  Pointer to the player
+ * @return  The identifier of the player unit, ARAS_PLAYER_UNIT_NONE if every
+ *          input is allocated
+ */
+int aras_player_alloc_unit(struct aras_player *player)
+{
+        int unit;
+        int free_unit;
+
+        free_unit = ARAS_PLAYER_UNIT_NONE;
+        for (unit = 0; unit < player->units; unit++) {
+                if (player->input[unit].allocated)
+                        continue;
+                if (player->input[unit].state == ARAS_PLAYER_STATE_STOP) {
+                        free_unit = unit;
+                        break;
+                }
+                if (free_unit == ARAS_PLAYER_UNIT_NONE)
+                        free_unit = unit;
+        }
+
+        if (free_unit != ARAS_PLAYER_UNIT_NONE)
+                player->input[free_unit].allocated = 1;
+
+        return free_unit;
+}
+
+/**
+ * This function releases an input of the pool of a player. The input is
+ * muted and detached from the mixer, its volume control is kept for the next
+ * allocation.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_release_unit(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return;
+
+        aras_player_set_volume(player, unit, 0);
+        aras_player_set_state_ready(player, unit);
+        input->allocated = 0;
+}
+
+/**
+ * This function gets the volume in a player.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  volume  The volume value
+ */
+float aras_player_get_volume(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return 0;
+
+        return input->volume;
+}
+
+/**
+ * This function gets the player state. Inputs waiting to be prerolled or
+ * started are reported as ARAS_PLAYER_STATE_OTHER.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   state   Pointer to the buffer where the state is written
+ */
+void aras_player_get_state(struct aras_player *player, int unit, int *state)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                input = &player->input[0];
+
+        *state = input->state;
+}
+
+/**
+ * This function checks whether a player unit is prerolled, that is, with the
+ * media ready to start playing.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  1 if the unit is prerolled, 0 otherwise
+ */
+int aras_player_get_prerolled(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return 0;
+
+        return input->prerolled && input->target == GST_STATE_PAUSED;
+}
+
+/**
+ * This function returns the buffer percent of a player unit.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The current buffer percent value
+ */
+int aras_player_get_buffer_percent(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return 0;
+
+        return input->buffer_percent;
+}
+
+/**
+ * This function gets the player current unit.
+ *
+ * @param   player  Pointer to the player
+ * @return  The current unit
+ */
+int aras_player_get_current_unit(struct aras_player *player)
+{
+        return player->current_unit;
+}
+
+/**
+ * This function returns the number of inputs in the pool of a player.
+ *
+ * @param   player  Pointer to the player
+ * @return  The number of player units
+ */
+int aras_player_get_units(struct aras_player *player)
+{
+        return player->units;
+}
+
+/**
+ * This function checks whether an input of the pool of a player is allocated.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  1 if the unit is allocated, 0 otherwise
+ */
+int aras_player_get_allocated(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return 0;
+
+        return input->allocated;
+}
+
+/**
+ * This function returns the duration in miliseconds of the file being played in
+ * a player structure.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The duration of the file being played
+ */
+long int aras_player_get_duration(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return 0;
+
+        if (input->state != ARAS_PLAYER_STATE_PLAYING)
+                return 0;
+
+        return input->duration;
+}
+
+/**
+ * This function returns the position in miliseconds of the file being played in
+ * a player structure. The position is the running time of the pipeline since
+ * the input started.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The position of the file being played
+ */
+long int aras_player_get_position(struct aras_player *player, int unit)
+{
+        struct aras_player_input *input;
+        GstClockTime now;
+        long int position;
+
+        if ((input = aras_player_get_input(player, unit)) == NULL)
+                return 0;
+
+        if (input->state != ARAS_PLAYER_STATE_PLAYING)
+                return 0;
+
+        now = aras_player_get_running_time(player);
+        if (!GST_CLOCK_TIME_IS_VALID(now) || now < input->start_time)
+                return 0;
+
+        position = (long int)((now - input->start_time) / GST_MSECOND);
+        if (input->duration > 0 && position > input->duration)
+                position = input->duration;
+
+        return position;
+}
+
+/**
+ * This function returns the number of queued URIs that have started playing
+ * in a player unit since the last call.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  0, gapless playback is not supported
+ */
+int aras_player_take_next_started(struct aras_player *player, int unit)
+{
+        return 0;
+}
@@ -0,0 +1,858 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Simulated player module for the ARAS Radio Automation System. It implements
+ * the player API without playing any media, so that the engine runs in
+ * simulations with the virtual clock of the time module. Durations, preroll
+ * latencies and errors of the media are derived from a hash of the URI, so
+ * the same schedule always plays the same way.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <glib.h>
+#include <aras/configuration.h>
+#include <aras/time.h>
+#include <aras/log.h>
+#include <aras/fade.h>
+#include <aras/player_sim.h>
+
+/**
+ * This function returns a deck of a player.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The deck, NULL if the unit does not exist
+ */
+struct aras_player_deck *aras_player_get_deck(struct aras_player *player, int unit)
+{
+        if (unit < 0 || unit >= player->units)
+                return NULL;
+
+        return &player->deck[unit];
+}
+
+/**
+ * This function writes an event of a player unit in the as-run trace.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   event   Pointer to the event string
+ * @param   uri     Pointer to the URI string
+ */
+void aras_player_trace(struct aras_player *player, int unit, char *event, char *uri)
+{
+        char msg[ARAS_LOG_MESSAGE_MAX];
+
+        if (player->trace_file == NULL)
+                return;
+
+        snprintf(msg, sizeof(msg), "ARAS player: %s unit %d: %s %s\n", player->name, unit, event, uri);
+        aras_log_write(player->trace_file, msg);
+}
+
+/**
+ * This function returns a hash of a URI, from which the simulated media is
+ * derived. The salt selects independent hashes for each property.
+ *
+ * @param   uri     Pointer to the URI string
+ * @param   salt    The salt
+ * @return  The hash
+ */
+guint aras_player_hash(const char *uri, guint salt)
+{
+        guint hash;
+
+        /* Mix the bits, similar URIs have similar string hashes */
+        hash = g_str_hash(uri) ^ (salt * 2654435761u);
+        hash ^= hash >> 16;
+        hash *= 0x7feb352du;
+        hash ^= hash >> 15;
+        hash *= 0x846ca68bu;
+        hash ^= hash >> 16;
+
+        return hash;
+}
+
+/**
+ * This function returns the simulated duration of a media.
+ *
+ * @param   player  Pointer to the player
+ * @param   uri     Pointer to the URI string
+ * @return  The duration in miliseconds
+ */
+long int aras_player_media_duration(struct aras_player *player, const char *uri)
+{
+        return player->duration_min + (long int)(aras_player_hash(uri, 0) % (guint)(player->duration_max - player->duration_min + 1));
+}
+
+/**
+ * This function checks whether a simulated media fails to play. Empty URIs
+ * always fail.
+ *
+ * @param   uri     Pointer to the URI string
+ * @return  1 if the media fails, 0 otherwise
+ */
+int aras_player_media_failed(const char *uri)
+{
+        if (uri[0] == '\0')
+                return 1;
+
+        return ARAS_PLAYER_SIM_ERROR_RATE != 0 && aras_player_hash(uri, 1) % ARAS_PLAYER_SIM_ERROR_RATE == 0;
+}
+
+/**
+ * This function loads the media of a deck, which is prerolled after the
+ * simulated latency. The latency varies from one load to the next.
+ *
+ * @param   player  Pointer to the player
+ * @param   deck    Pointer to the deck
+ */
+void aras_player_deck_load(struct aras_player *player, struct aras_player_deck *deck)
+{
+        long int latency;
+
+        deck->loads++;
+        latency = ARAS_PLAYER_SIM_LATENCY_MIN + (long int)(aras_player_hash(deck->uri, deck->loads + 1) % (ARAS_PLAYER_SIM_LATENCY_MAX - ARAS_PLAYER_SIM_LATENCY_MIN + 1));
+
+        deck->duration = aras_player_media_duration(player, deck->uri);
+        deck->ready_time = aras_time_monotonic() + (long long int)latency * 1000;
+        deck->start_time = deck->ready_time;
+        deck->state = ARAS_PLAYER_STATE_OTHER;
+}
+
+/**
+ * This function brings a deck up to date with the virtual clock: the media
+ * is prerolled or fails once the latency has elapsed, it starts playing at
+ * the start time and it ends after its duration, going on with the queued URI,
+ * if any. As with the playbin, the end of the stream leaves the unit in
+ * ARAS_PLAYER_STATE_ERROR.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_deck_update(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+        long long int now;
+
+        deck = &player->deck[unit];
+        now = aras_time_monotonic();
+
+        if (deck->target == ARAS_PLAYER_SIM_TARGET_READY || deck->state == ARAS_PLAYER_STATE_ERROR)
+                return;
+
+        /* Still prerolling */
+        if (now < deck->ready_time)
+                return;
+
+        if (deck->state == ARAS_PLAYER_STATE_OTHER) {
+                if (aras_player_media_failed(deck->uri)) {
+                        deck->state = ARAS_PLAYER_STATE_ERROR;
+                        aras_player_trace(player, unit, "error", deck->uri);
+                        return;
+                }
+                if (deck->target != ARAS_PLAYER_SIM_TARGET_PLAYING || now < deck->start_time)
+                        return;
+                deck->state = ARAS_PLAYER_STATE_PLAYING;
+                aras_player_trace(player, unit, "play", deck->uri);
+        }
+
+        /* End of the media, the queued URI goes on without a gap */
+        while (deck->state == ARAS_PLAYER_STATE_PLAYING && now - deck->start_time >= (long long int)deck->duration * 1000) {
+                if (deck->next_uri[0] == '\0' || aras_player_media_failed(deck->next_uri)) {
+                        deck->state = ARAS_PLAYER_STATE_ERROR;
+                        aras_player_trace(player, unit, "end of stream", deck->uri);
+                        break;
+                }
+                deck->start_time += (long long int)deck->duration * 1000;
+                g_strlcpy(deck->uri, deck->next_uri, ARAS_PLAYER_MAX_URI);
+                deck->next_uri[0] = '\0';
+                deck->duration = aras_player_media_duration(player, deck->uri);
+                deck->next_started++;
+                aras_player_trace(player, unit, "play gapless", deck->uri);
+        }
+}
+
+/**
+ * This function returns the volume of a deck, following the volume ramp in
+ * progress, if any.
+ *
+ * @param   deck    Pointer to the deck
+ * @return  The volume
+ */
+float aras_player_deck_volume(struct aras_player_deck *deck)
+{
+        long int elapsed;
+        float position;
+        float weight;
+        int k;
+
+        if (deck->ramp_time <= 0)
+                return deck->limit;
+
+        elapsed = (long int)((aras_time_monotonic() - deck->ramp_start) / 1000);
+        if (elapsed >= deck->ramp_time)
+                return deck->limit;
+
+        /* Interpolate the weights of the ramp */
+        position = (float)elapsed * deck->ramp_points / deck->ramp_time;
+        k = (int)position;
+        weight = deck->ramp_weights[k] + (position - k) * (deck->ramp_weights[k + 1] - deck->ramp_weights[k]);
+
+        return deck->volume + weight * (deck->limit - deck->volume);
+}
+
+/**
+ * This function initializes a player structure. No media is played, the
+ * audio and video settings are ignored.
+ *
+ * @param   player              Pointer to the player
+ * @param   name                Pointer to the name string
+ * @param   audio_output        Value for the audio output
+ * @param   audio_device        Pointer to the audio device string
+ * @param   audio_sample_rate   Value for the sample rate
+ * @param   audio_channels      Value for the number of channels
+ * @param   video_output        Value for the video output
+ * @param   video_device        Pointer to the video device string
+ * @param   video_display       Pointer to the video display string
+ * @param   video_resolution    Array containing the screen resolution
+ * @return  0 if success, -1 if error
+ */
+int aras_player_init(struct aras_player *player,
+                     char *name,
+                     int audio_output,
+                     char *audio_device,
+                     int audio_sample_rate,
+                     int audio_channels,
+                     int video_output,
+                     char *video_device,
+                     char *video_display,
+                     int video_resolution[])
+{
+        int unit;
+
+        /* Initialize current unit and decks */
+        player->current_unit = 0;
+        g_strlcpy(player->name, name, ARAS_PLAYER_MAX_NAME);
+        player->units = ARAS_PLAYER_UNITS;
+        player->duration_min = ARAS_PLAYER_SIM_DURATION_MIN;
+        player->duration_max = ARAS_PLAYER_SIM_DURATION_MAX;
+        player->trace_file = NULL;
+        player->callback_wake = NULL;
+        player->callback_wake_data = NULL;
+        for (unit = 0; unit < ARAS_PLAYER_MAX_UNITS; unit++) {
+                player->deck[unit].allocated = 0;
+                player->deck[unit].uri[0] = '\0';
+                player->deck[unit].next_uri[0] = '\0';
+                player->deck[unit].next_started = 0;
+                player->deck[unit].state = ARAS_PLAYER_STATE_STOP;
+                player->deck[unit].target = ARAS_PLAYER_SIM_TARGET_READY;
+                player->deck[unit].loads = 0;
+                player->deck[unit].duration = 0;
+                player->deck[unit].ready_time = 0;
+                player->deck[unit].start_time = 0;
+                player->deck[unit].volume = 0;
+                player->deck[unit].limit = 0;
+                player->deck[unit].ramp_start = 0;
+                player->deck[unit].ramp_time = 0;
+                player->deck[unit].ramp_points = 0;
+        }
+
+        return 0;
+}
+
+/**
+ * This function initializes a player structure with the block player
+ * configuration.
+ *
+ * @param   player          Pointer to the player
+ * @param   configuration   Pointer to the configuration
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_player_init_block_player(struct aras_player *player, struct aras_configuration *configuration)
+{
+        if (aras_player_init(player,
+                             configuration->block_player_name,
+                             configuration->block_player_audio_output,
+                             configuration->block_player_audio_device,
+                             configuration->block_player_sample_rate,
+                             configuration->block_player_channels,
+                             configuration->block_player_video_output,
+                             configuration->block_player_video_device,
+                             configuration->block_player_video_display,
+                             configuration->block_player_display_resolution) == -1)
+                return -1;
+
+        player->units = configuration->block_player_decks;
+
+        return 0;
+}
+
+/**
+ * This function initializes a player structure with the time signal player
+ * configuration. Time signal files are simulated shorter than block files.
+ *
+ * @param   player          Pointer to the player
+ * @param   configuration   Pointer to the configuration
+ *
+ * @return  0 if success, -1 if error
+ */
+int aras_player_init_time_signal_player(struct aras_player *player, struct aras_configuration *configuration)
+{
+        if (aras_player_init(player,
+                             configuration->time_signal_player_name,
+                             configuration->time_signal_player_audio_output,
+                             configuration->time_signal_player_audio_device,
+                             configuration->time_signal_player_sample_rate,
+                             configuration->time_signal_player_channels,
+                             configuration->time_signal_player_video_output,
+                             configuration->time_signal_player_video_device,
+                             configuration->time_signal_player_video_display,
+                             configuration->time_signal_player_display_resolution) == -1)
+                return -1;
+
+        player->units = configuration->time_signal_player_decks;
+        player->duration_min = ARAS_PLAYER_SIM_SIGNAL_DURATION_MIN;
+        player->duration_max = ARAS_PLAYER_SIM_SIGNAL_DURATION_MAX;
+
+        return 0;
+}
+
+/**
+ * This function sets the volume in a player. A volume ramp in progress is
+ * cancelled.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   volume  The volume value
+ */
+void aras_player_set_volume(struct aras_player *player, int unit, float volume)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        deck->volume = volume;
+        deck->limit = volume;
+        deck->ramp_time = 0;
+}
+
+/**
+ * This function sets a given volume increment in a player.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   slope   The slope of the volume curve
+ * @param   limit   The asymptotic limit for the volume
+ */
+void aras_player_set_volume_increment(struct aras_player *player, int unit, float slope, float limit)
+{
+        float volume;
+
+        volume = aras_player_get_volume(player, unit);
+        aras_player_set_volume(player, unit, volume + slope * (limit - volume));
+}
+
+/**
+ * This function schedules a volume ramp in a player unit. The ramp goes from
+ * the current volume to the limit in the given time, following a table of
+ * progress weights at equal intervals, from 0 at the start to 1 at the end.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   limit   The final volume
+ * @param   time    The duration of the ramp in miliseconds
+ * @param   weights Pointer to the table of points + 1 progress weights
+ * @param   points  The number of intervals of the ramp
+ */
+void aras_player_set_volume_ramp(struct aras_player *player, int unit, float limit, long int time, const float *weights, int points)
+{
+        struct aras_player_deck *deck;
+        char event[ARAS_LOG_MESSAGE_MAX];
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        if (time <= 0 || points <= 0 || points > ARAS_FADE_POINTS) {
+                aras_player_set_volume(player, unit, limit);
+                return;
+        }
+
+        deck->volume = aras_player_deck_volume(deck);
+        deck->limit = limit;
+        deck->ramp_start = aras_time_monotonic();
+        deck->ramp_time = time;
+        deck->ramp_points = points;
+        memcpy(deck->ramp_weights, weights, (points + 1) * sizeof(float));
+
+        snprintf(event, sizeof(event), "ramp from %.2f to %.2f in %ld ms", deck->volume, limit, time);
+        aras_player_trace(player, unit, event, deck->uri);
+}
+
+/**
+ * This function queues the URI to be played next in a player unit without a
+ * gap. The URI replaces any URI queued before, NULL empties the queue.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   uri     A pointer to the URI string, NULL to empty the queue
+ * @return  0 if success, -1 if error
+ */
+int aras_player_set_next_uri(struct aras_player *player, int unit, gchar *uri)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return -1;
+
+        aras_player_deck_update(player, unit);
+        g_strlcpy(deck->next_uri, uri != NULL ? uri : "", ARAS_PLAYER_MAX_URI);
+
+        return 0;
+}
+
+/**
+ * This function sets the URI in a player. A unit playing another URI is
+ * stopped.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   uri     A pointer to the URI string
+ */
+void aras_player_set_uri(struct aras_player *player, int unit, gchar *uri)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        if (deck->target != ARAS_PLAYER_SIM_TARGET_READY && strcmp(deck->uri, uri) != 0)
+                aras_player_set_state_ready(player, unit);
+
+        g_strlcpy(deck->uri, uri, ARAS_PLAYER_MAX_URI);
+}
+
+/**
+ * This function sets the player state to GST_STATE_NULL.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_state_null(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        aras_player_set_state_ready(player, unit);
+        deck->state = ARAS_PLAYER_STATE_ERROR;
+}
+
+/**
+ * This function sets the player state to GST_STATE_READY, stopping the media.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_state_ready(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        aras_player_deck_update(player, unit);
+        if (deck->state == ARAS_PLAYER_STATE_PLAYING)
+                aras_player_trace(player, unit, "stop", deck->uri);
+
+        deck->state = ARAS_PLAYER_STATE_STOP;
+        deck->target = ARAS_PLAYER_SIM_TARGET_READY;
+        deck->next_uri[0] = '\0';
+}
+
+/**
+ * This function sets the player state to GST_STATE_PAUSED, that is, it
+ * prerolls the media without starting it. A started unit is prerolled again
+ * from the beginning.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_state_paused(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        if (deck->target == ARAS_PLAYER_SIM_TARGET_PAUSED)
+                return;
+
+        aras_player_set_state_ready(player, unit);
+        aras_player_deck_load(player, deck);
+        deck->target = ARAS_PLAYER_SIM_TARGET_PAUSED;
+}
+
+/**
+ * This function sets the player state to GST_STATE_PLAYING. A prerolled unit
+ * starts immediately, otherwise it starts once prerolled.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_state_playing(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+        long long int now;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        if (deck->target == ARAS_PLAYER_SIM_TARGET_PLAYING)
+                return;
+
+        if (deck->target == ARAS_PLAYER_SIM_TARGET_READY || deck->state == ARAS_PLAYER_STATE_ERROR)
+                aras_player_deck_load(player, deck);
+
+        now = aras_time_monotonic();
+        deck->target = ARAS_PLAYER_SIM_TARGET_PLAYING;
+        deck->start_time = MAX(now, deck->ready_time);
+        aras_player_deck_update(player, unit);
+}
+
+/**
+ * This function sets the player current unit.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_set_current_unit(struct aras_player *player, int unit)
+{
+        player->current_unit = unit;
+}
+
+/**
+ * This function sets the function called when a player event requires the
+ * attention of the engine. Simulated decks change on the virtual clock, which
+ * the simulation only advances between runs of the engine, so the function is
+ * never called.
+ *
+ * @param   player          Pointer to the player
+ * @param   callback_wake   Pointer to the wake up function, NULL to disable it
+ * @param   data            Pointer to the data passed to the wake up function
+ */
+void aras_player_set_callback_wake(struct aras_player *player, void (*callback_wake)(void *data), void *data)
+{
+        player->callback_wake = callback_wake;
+        player->callback_wake_data = data;
+}
+
+/**
+ * This function sets the file where the events of the player units are
+ * written, as an as-run trace.
+ *
+ * @param   player      Pointer to the player
+ * @param   trace_file  Pointer to the file name string, NULL to disable the
+ *                      trace
+ */
+void aras_player_set_trace_file(struct aras_player *player, char *trace_file)
+{
+        player->trace_file = trace_file;
+}
+
+/**
+ * This function allocates a free deck of the pool of a player, stopped decks
+ * first.
+ *
+ * @param   player  Pointer to the player
+ * @return  The identifier of the player unit, ARAS_PLAYER_UNIT_NONE if every
+ *          deck is allocated
+ */
+int aras_player_alloc_unit(struct aras_player *player)
+{
+        int unit;
+        int free_unit;
+
+        free_unit = ARAS_PLAYER_UNIT_NONE;
+        for (unit = 0; unit < player->units; unit++) {
+                if (player->deck[unit].allocated)
+                        continue;
+                if (player->deck[unit].state == ARAS_PLAYER_STATE_STOP) {
+                        free_unit = unit;
+                        break;
+                }
+                if (free_unit == ARAS_PLAYER_UNIT_NONE)
+                        free_unit = unit;
+        }
+
+        if (free_unit != ARAS_PLAYER_UNIT_NONE)
+                player->deck[free_unit].allocated = 1;
+
+        return free_unit;
+}
+
+/**
+ * This function releases a deck of the pool of a player. The deck is muted
+ * and stopped.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ */
+void aras_player_release_unit(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        aras_player_set_volume(player, unit, 0);
+        aras_player_set_state_ready(player, unit);
+        deck->allocated = 0;
+}
+
+/**
+ * This function gets the volume in a player.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  volume  The volume value
+ */
+float aras_player_get_volume(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        return aras_player_deck_volume(deck);
+}
+
+/**
+ * This function gets the player state. Units prerolling or prerolled are
+ * reported as ARAS_PLAYER_STATE_OTHER.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   state   Pointer to the buffer where the state is written
+ */
+void aras_player_get_state(struct aras_player *player, int unit, int *state)
+{
+        if (aras_player_get_deck(player, unit) == NULL)
+                unit = 0;
+
+        aras_player_deck_update(player, unit);
+        *state = player->deck[unit].state;
+}
+
+/**
+ * This function checks whether a player unit is prerolled, that is, with the
+ * media ready to start playing.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  1 if the unit is prerolled, 0 otherwise
+ */
+int aras_player_get_prerolled(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        aras_player_deck_update(player, unit);
+
+        return deck->target == ARAS_PLAYER_SIM_TARGET_PAUSED && deck->state == ARAS_PLAYER_STATE_OTHER && aras_time_monotonic() >= deck->ready_time;
+}
+
+/**
+ * This function returns the buffer percent of a player unit. Simulated media
+ * is local, so it is always fully buffered.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The current buffer percent value
+ */
+int aras_player_get_buffer_percent(struct aras_player *player, int unit)
+{
+        return 100;
+}
+
+/**
+ * This function gets the player current unit.
+ *
+ * @param   player  Pointer to the player
+ * @return  The current unit
+ */
+int aras_player_get_current_unit(struct aras_player *player)
+{
+        return player->current_unit;
+}
+
+/**
+ * This function returns the number of decks in the pool of a player.
+ *
+ * @param   player  Pointer to the player
+ * @return  The number of player units
+ */
+int aras_player_get_units(struct aras_player *player)
+{
+        return player->units;
+}
+
+/**
+ * This function checks whether a deck of the pool of a player is allocated.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  1 if the unit is allocated, 0 otherwise
+ */
+int aras_player_get_allocated(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        return deck->allocated;
+}
+
+/**
+ * This function returns the duration in miliseconds of the file being played in
+ * a player structure.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The duration of the file being played
+ */
+long int aras_player_get_duration(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        aras_player_deck_update(player, unit);
+        if (deck->state != ARAS_PLAYER_STATE_PLAYING)
+                return 0;
+
+        return deck->duration;
+}
+
+/**
+ * This function returns the position in miliseconds of the file being played in
+ * a player structure.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The position of the file being played
+ */
+long int aras_player_get_position(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+        long int position;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        aras_player_deck_update(player, unit);
+        if (deck->state != ARAS_PLAYER_STATE_PLAYING)
+                return 0;
+
+        position = (long int)((aras_time_monotonic() - deck->start_time) / 1000);
+        if (position > deck->duration)
+                position = deck->duration;
+
+        return position;
+}
+
+/**
+ * This function returns the time until the next change in a deck of a player,
+ * that is, a media prerolled, started or ended, so that simulations advance
+ * the virtual clock up to it.
+ *
+ * @param   player  Pointer to the player
+ * @return  The time in miliseconds, -1 if no change is pending
+ */
+long int aras_player_get_timeout(struct aras_player *player)
+{
+        struct aras_player_deck *deck;
+        long long int now;
+        long long int next;
+        long long int event;
+        int unit;
+
+        now = aras_time_monotonic();
+        next = -1;
+        for (unit = 0; unit < player->units; unit++) {
+                aras_player_deck_update(player, unit);
+                deck = &player->deck[unit];
+                if (deck->target == ARAS_PLAYER_SIM_TARGET_READY || deck->state == ARAS_PLAYER_STATE_ERROR)
+                        continue;
+                if (now < deck->ready_time)
+                        event = deck->ready_time;
+                else if (deck->state == ARAS_PLAYER_STATE_OTHER && deck->target == ARAS_PLAYER_SIM_TARGET_PLAYING)
+                        event = deck->start_time;
+                else if (deck->state == ARAS_PLAYER_STATE_PLAYING)
+                        event = deck->start_time + (long long int)deck->duration * 1000;
+                else
+                        continue;
+                if (next == -1 || event < next)
+                        next = event;
+        }
+
+        if (next == -1)
+                return -1;
+
+        /* Round up, the change is due at the end of the interval */
+        return (long int)((next - now + 999) / 1000);
+}
+
+/**
+ * This function returns the number of queued URIs that have started playing
+ * in a player unit since the last call.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The number of queued URIs started
+ */
+int aras_player_take_next_started(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+        int started;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        aras_player_deck_update(player, unit);
+        started = deck->next_started;
+        deck->next_started = 0;
+
+        return started;
+}
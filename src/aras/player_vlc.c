@@ -27,73 +27,166 @@
  * module.
  */
 
+#include <glib.h>
 #include <vlc/vlc.h>
 #include <aras/configuration.h>
 #include <aras/player_vlc.h>
 
+/* libVLC arguments of audio only players */
+static const char *const aras_player_audio_only_args[] = {"--no-video"};
+
 /**
- * This function initializes a player structure with the block player
- * configuration.
+ * This function calls the wake up function of a player, if any. It is called
+ * from the main loop.
  *
- * @param   player          Pointer to the player
- * @param   configuration   Pointer to the configuration
+ * @param   data    Pointer to the player
  *
- * @return  This function always return 0
+ * @return  This function always returns FALSE
  */
-int aras_player_init_block_player(struct aras_player *player, struct aras_configuration *configuration)
+gboolean aras_player_wake(gpointer data)
 {
-        /* Initialize current unit, volume and buffer percent */
-        player->current_unit = 0;
-        player->volume_a = 0;
-        player->volume_b = 0;
-        player->buffer_percent_a = 0;
-        player->buffer_percent_b = 0;
+        struct aras_player *player;
 
-        XInitThreads();
+        player = (struct aras_player*)data;
 
-        /* Create player */
-        player->instance = libvlc_new(0, NULL);
-        player->player_a = libvlc_media_player_new(player->instance);
-        player->player_b = libvlc_media_player_new(player->instance);
-        player->media_a = libvlc_media_new_location(player->instance, "file:///dev/null");
-        player->media_b = libvlc_media_new_location(player->instance, "file:///dev/null");
+        if (player->callback_wake != NULL)
+                player->callback_wake(player->callback_wake_data);
+
+        return FALSE;
+}
+
+/**
+ * This function is the callback function for the libVLC events. It is called
+ * from a libVLC thread, so the wake up is deferred to the main context of the
+ * player.
+ *
+ * @param   event   Pointer to the libVLC event
+ * @param   data    Pointer to the player
+ */
+void aras_player_callback_event(const struct libvlc_event_t *event, void *data)
+{
+        struct aras_player *player;
+        GSource *source;
+
+        player = (struct aras_player*)data;
+
+        source = g_idle_source_new();
+        g_source_set_callback(source, aras_player_wake, player, NULL);
+        g_source_attach(source, player->context);
+        g_source_unref(source);
+}
+
+/**
+ * This function returns a deck of the pool of a player.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  The deck, NULL if the unit does not exist
+ */
+struct aras_player_deck *aras_player_get_deck(struct aras_player *player, int unit)
+{
+        if (unit < 0 || unit >= player->units)
+                return NULL;
+
+        return &player->deck[unit];
+}
+
+/**
+ * This function initializes a deck of the pool of a player. The media player
+ * is created once and reused for every playlist node.
+ *
+ * @param   player          Pointer to the player
+ * @param   unit            The identifier of the player unit
+ * @param   audio_output    Value for the audio output
+ * @param   audio_device    Pointer to the audio device string
+ * @param   video_output    Value for the video output
+ */
+void aras_player_init_deck(struct aras_player *player, int unit, int audio_output, char *audio_device, int video_output)
+{
+        struct aras_player_deck *deck;
+        libvlc_event_manager_t *event_manager;
 
-        switch (configuration->block_player_audio_output) {
+        /* Initialize volume and buffer percent */
+        deck = &player->deck[unit];
+        deck->allocated = 0;
+        deck->volume = 0;
+        deck->buffer_percent = 0;
+        deck->ramp.source = 0;
+
+        /* Create the media player */
+        deck->player = libvlc_media_player_new(player->instance);
+        deck->media = libvlc_media_new_location(player->instance, "file:///dev/null");
+
+        switch (audio_output) {
         case ARAS_CONFIGURATION_MODE_AUDIO_ALSA:
-                libvlc_audio_output_set(player->player_a, "alsa");
-                libvlc_audio_output_set(player->player_b, "alsa");
+                libvlc_audio_output_set(deck->player, "alsa");
                 break;
         case ARAS_CONFIGURATION_MODE_AUDIO_JACK:
-                libvlc_audio_output_set(player->player_a, "jack");
-                libvlc_audio_output_set(player->player_b, "jack");
+                libvlc_audio_output_set(deck->player, "jack");
                 break;
         case ARAS_CONFIGURATION_MODE_AUDIO_PULSEAUDIO:
-                libvlc_audio_output_set(player->player_a, "pulse");
-                libvlc_audio_output_set(player->player_b, "pulse");
+                libvlc_audio_output_set(deck->player, "pulse");
                 break;
         case ARAS_CONFIGURATION_MODE_AUDIO_FILE:
-                libvlc_audio_output_set(player->player_a, "afile");
-                libvlc_audio_output_set(player->player_b, "afile");
+                libvlc_audio_output_set(deck->player, "afile");
                 break;
         default:
-                libvlc_audio_output_set(player->player_a, "alsa");
-                libvlc_audio_output_set(player->player_b, "alsa");
+                libvlc_audio_output_set(deck->player, "alsa");
                 break;
         }
 
-        if (configuration->block_player_audio_output != ARAS_CONFIGURATION_MODE_AUDIO_PULSEAUDIO) {
-                libvlc_audio_output_device_set(player->player_a, NULL, configuration->block_player_audio_device);
-                libvlc_audio_output_device_set(player->player_b, NULL, configuration->block_player_audio_device);
-        }
+        if (audio_output != ARAS_CONFIGURATION_MODE_AUDIO_PULSEAUDIO)
+                libvlc_audio_output_device_set(deck->player, NULL, audio_device);
+
+        libvlc_audio_set_volume(deck->player, (int)deck->volume);
 
-        libvlc_audio_set_volume(player->player_a, (int)player->volume_a);
-        libvlc_audio_set_volume(player->player_b, (int)player->volume_b);
+        if (video_output != ARAS_CONFIGURATION_MODE_VIDEO_NONE)
+                libvlc_set_fullscreen(deck->player, true);
 
-        libvlc_set_fullscreen(player->player_a, true);
-        libvlc_set_fullscreen(player->player_b, true);
+        /* Attach the callback function for the libVLC events */
+        event_manager = libvlc_media_player_event_manager(deck->player);
+        libvlc_event_attach(event_manager, libvlc_MediaPlayerEndReached, aras_player_callback_event, player);
+        libvlc_event_attach(event_manager, libvlc_MediaPlayerEncounteredError, aras_player_callback_event, player);
+        libvlc_event_attach(event_manager, libvlc_MediaPlayerLengthChanged, aras_player_callback_event, player);
 
-        aras_player_set_state_ready(player, ARAS_PLAYER_UNIT_A);
-        aras_player_set_state_ready(player, ARAS_PLAYER_UNIT_B);
+        aras_player_set_state_ready(player, unit);
+}
+
+/**
+ * This function initializes a player structure with the block player
+ * configuration.
+ *
+ * @param   player          Pointer to the player
+ * @param   configuration   Pointer to the configuration
+ *
+ * @return  This function always return 0
+ */
+int aras_player_init_block_player(struct aras_player *player, struct aras_configuration *configuration)
+{
+        int unit;
+
+        /* Initialize current unit and the pool of decks */
+        player->current_unit = 0;
+        player->context = g_main_context_ref_thread_default();
+        player->units = configuration->block_player_decks;
+        player->callback_wake = NULL;
+        player->callback_wake_data = NULL;
+
+        XInitThreads();
+
+        /* Create player */
+        if (configuration->block_player_video_output == ARAS_CONFIGURATION_MODE_VIDEO_NONE)
+                player->instance = libvlc_new(1, aras_player_audio_only_args);
+        else
+                player->instance = libvlc_new(0, NULL);
+
+        /* Create the decks */
+        for (unit = 0; unit < player->units; unit++)
+                aras_player_init_deck(player,
+                                      unit,
+                                      configuration->block_player_audio_output,
+                                      configuration->block_player_audio_device,
+                                      configuration->block_player_video_output);
 
         return 0;
 }
@@ -109,64 +202,103 @@ int aras_player_init_block_player(struct aras_player *player, struct aras_config
  */
 int aras_player_init_time_signal_player(struct aras_player *player, struct aras_configuration *configuration)
 {
-        /* Initialize current unit, volume and buffer percent */
+        int unit;
+
+        /* Initialize current unit and the pool of decks */
         player->current_unit = 0;
-        player->volume_a = 0;
-        player->volume_b = 0;
-        player->buffer_percent_a = 0;
-        player->buffer_percent_b = 0;
+        player->context = g_main_context_ref_thread_default();
+        player->units = configuration->time_signal_player_decks;
+        player->callback_wake = NULL;
+        player->callback_wake_data = NULL;
 
         XInitThreads();
 
         /* Create player */
-        player->instance = libvlc_new(0, NULL);
-        player->player_a = libvlc_media_player_new(player->instance);
-        player->player_b = libvlc_media_player_new(player->instance);
-        player->media_a = libvlc_media_new_location(player->instance, "file:///dev/null");
-        player->media_b = libvlc_media_new_location(player->instance, "file:///dev/null");
+        if (configuration->time_signal_player_video_output == ARAS_CONFIGURATION_MODE_VIDEO_NONE)
+                player->instance = libvlc_new(1, aras_player_audio_only_args);
+        else
+                player->instance = libvlc_new(0, NULL);
+
+        /* Create the decks */
+        for (unit = 0; unit < player->units; unit++)
+                aras_player_init_deck(player,
+                                      unit,
+                                      configuration->time_signal_player_audio_output,
+                                      configuration->time_signal_player_audio_device,
+                                      configuration->time_signal_player_video_output);
 
-        switch (configuration->time_signal_player_audio_output) {
-        case ARAS_CONFIGURATION_MODE_AUDIO_ALSA:
-                libvlc_audio_output_set(player->player_a, "alsa");
-                libvlc_audio_output_set(player->player_b, "alsa");
-                break;
-        case ARAS_CONFIGURATION_MODE_AUDIO_JACK:
-                libvlc_audio_output_set(player->player_a, "jack");
-                libvlc_audio_output_set(player->player_b, "jack");
-                break;
-        case ARAS_CONFIGURATION_MODE_AUDIO_PULSEAUDIO:
-                libvlc_audio_output_set(player->player_a, "pulse");
-                libvlc_audio_output_set(player->player_b, "pulse");
-                break;
-        case ARAS_CONFIGURATION_MODE_AUDIO_FILE:
-                libvlc_audio_output_set(player->player_a, "afile");
-                libvlc_audio_output_set(player->player_b, "afile");
-                break;
-        default:
-                libvlc_audio_output_set(player->player_a, "alsa");
-                libvlc_audio_output_set(player->player_b, "alsa");
-                break;
-        }
+        return 0;
+}
 
-        if (configuration->time_signal_player_audio_output != ARAS_CONFIGURATION_MODE_AUDIO_PULSEAUDIO) {
-                libvlc_audio_output_device_set(player->player_a, NULL, configuration->time_signal_player_audio_device);
-                libvlc_audio_output_device_set(player->player_b, NULL, configuration->time_signal_player_audio_device);
-        }
+/**
+ * This function applies a volume to a player unit.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   volume  The volume value
+ */
+void aras_player_apply_volume(struct aras_player *player, int unit, float volume)
+{
+        struct aras_player_deck *deck;
 
-        libvlc_audio_set_volume(player->player_a, (int)player->volume_a);
-        libvlc_audio_set_volume(player->player_b, (int)player->volume_b);
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
 
-        libvlc_set_fullscreen(player->player_a, true);
-        libvlc_set_fullscreen(player->player_b, true);
+        deck->volume = volume;
+        libvlc_audio_set_volume(deck->player, (int)(1e2 * volume));
+}
 
-        aras_player_set_state_ready(player, ARAS_PLAYER_UNIT_A);
-        aras_player_set_state_ready(player, ARAS_PLAYER_UNIT_B);
+/**
+ * This function cancels the volume ramp of a player unit, if any.
+ *
+ * @param   ramp    Pointer to the volume ramp
+ */
+void aras_player_ramp_cancel(struct aras_player_ramp *ramp)
+{
+        if (ramp->source != 0) {
+                g_source_destroy(g_main_context_find_source_by_id(ramp->player->context, ramp->source));
+                ramp->source = 0;
+        }
+}
 
-        return 0;
+/**
+ * This function is the timeout function of a volume ramp. libVLC has no
+ * scheduled volume changes, so the volume curve is interpolated in small steps
+ * from the main loop.
+ *
+ * @param   data    Pointer to the volume ramp
+ *
+ * @return  TRUE while the ramp goes on, FALSE at its end
+ */
+gboolean aras_player_ramp_step(gpointer data)
+{
+        struct aras_player_ramp *ramp;
+        long int elapsed;
+        long int interval;
+        float weight;
+        float t;
+
+        ramp = (struct aras_player_ramp*)data;
+
+        elapsed = (long int)((g_get_monotonic_time() - ramp->start_time) / 1000);
+        if (elapsed >= ramp->time) {
+                ramp->source = 0;
+                aras_player_apply_volume(ramp->player, ramp->unit, ramp->limit);
+                return FALSE;
+        }
+
+        /* Interpolate between the progress weights around the elapsed time */
+        t = (float)elapsed * ramp->points / ramp->time;
+        interval = (long int)t;
+        weight = ramp->weights[interval] + (ramp->weights[interval + 1] - ramp->weights[interval]) * (t - interval);
+        aras_player_apply_volume(ramp->player, ramp->unit, ramp->start + weight * (ramp->limit - ramp->start));
+
+        return TRUE;
 }
 
 /**
- * This function sets the volume in a player.
+ * This function sets the volume in a player. A volume ramp in progress is
+ * cancelled.
  *
  * @param   player  Pointer to the player
  * @param   unit    The identifier of the player unit
@@ -174,18 +306,13 @@ int aras_player_init_time_signal_player(struct aras_player *player, struct aras_
  */
 void aras_player_set_volume(struct aras_player *player, int unit, float volume)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                player->volume_a = volume;
-                libvlc_audio_set_volume(player->player_a, (int)(1e2 * volume));
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                player->volume_b = volume;
-                libvlc_audio_set_volume(player->player_b, (int)(1e2 * volume));
-                break;
-        default:
-                break;
-        }
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        aras_player_ramp_cancel(&deck->ramp);
+        aras_player_apply_volume(player, unit, volume);
 }
 
 /**
@@ -198,18 +325,69 @@ void aras_player_set_volume(struct aras_player *player, int unit, float volume)
  */
 void aras_player_set_volume_increment(struct aras_player *player, int unit, float slope, float limit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                player->volume_a += slope * (limit - player->volume_a);
-                libvlc_audio_set_volume(player->player_a, (int)(1e2 * player->volume_a));
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                player->volume_b += slope * (limit - player->volume_b);
-                libvlc_audio_set_volume(player->player_b, (int)(1e2 * player->volume_b));
-                break;
-        default:
-                break;
+        float volume;
+
+        volume = aras_player_get_volume(player, unit);
+        aras_player_set_volume(player, unit, volume + slope * (limit - volume));
+}
+
+/**
+ * This function schedules a volume ramp in a player unit. The ramp goes from
+ * the current volume to the limit in the given time, following a table of
+ * progress weights at equal intervals, from 0 at the start to 1 at the end.
+ * The table is not copied and must be kept until the ramp ends.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   limit   The final volume
+ * @param   time    The duration of the ramp in miliseconds
+ * @param   weights Pointer to the table of points + 1 progress weights
+ * @param   points  The number of intervals of the ramp
+ */
+void aras_player_set_volume_ramp(struct aras_player *player, int unit, float limit, long int time, const float *weights, int points)
+{
+        struct aras_player_deck *deck;
+        struct aras_player_ramp *ramp;
+        GSource *source;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+        ramp = &deck->ramp;
+
+        aras_player_ramp_cancel(ramp);
+        if (time <= 0 || points <= 0) {
+                aras_player_apply_volume(player, unit, limit);
+                return;
         }
+
+        ramp->player = player;
+        ramp->unit = unit;
+        ramp->start_time = g_get_monotonic_time();
+        ramp->start = aras_player_get_volume(player, unit);
+        ramp->limit = limit;
+        ramp->time = time;
+        ramp->weights = weights;
+        ramp->points = points;
+        source = g_timeout_source_new(ARAS_PLAYER_RAMP_PERIOD);
+        g_source_set_callback(source, aras_player_ramp_step, ramp, NULL);
+        ramp->source = g_source_attach(source, player->context);
+        g_source_unref(source);
+}
+
+/**
+ * This function queues the URI to be played next in a player unit without a
+ * gap. libVLC media players do
+ * not announce the end of the media in advance, so there is no gapless queue
+ * and the engine crossfades consecutive media.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @param   uri     A pointer to the URI string, NULL to empty the queue
+ * @return  -1, gapless playback is not supported
+ */
+int aras_player_set_next_uri(struct aras_player *player, int unit, char *uri)
+{
+        return -1;
 }
 
 /**
@@ -221,20 +399,14 @@ void aras_player_set_volume_increment(struct aras_player *player, int unit, floa
  */
 void aras_player_set_uri(struct aras_player *player, int unit, char *uri)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                libvlc_media_release(player->media_a);
-                player->media_a = libvlc_media_new_location(player->instance, uri);
-                libvlc_media_player_set_media(player->player_a, player->media_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                libvlc_media_release(player->media_b);
-                player->media_b = libvlc_media_new_location(player->instance, uri);
-                libvlc_media_player_set_media(player->player_b, player->media_b);
-                break;
-        default:
-                break;
-        }
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        libvlc_media_release(deck->media);
+        deck->media = libvlc_media_new_location(player->instance, uri);
+        libvlc_media_player_set_media(deck->player, deck->media);
 }
 
 /**
@@ -245,16 +417,12 @@ void aras_player_set_uri(struct aras_player *player, int unit, char *uri)
  */
 void aras_player_set_state_null(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                libvlc_media_player_stop(player->player_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                libvlc_media_player_stop(player->player_b);
-                break;
-        default:
-                break;
-        }
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        libvlc_media_player_stop(deck->player);
 }
 
 /**
@@ -265,16 +433,12 @@ void aras_player_set_state_null(struct aras_player *player, int unit)
  */
 void aras_player_set_state_ready(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                libvlc_media_player_stop(player->player_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                libvlc_media_player_stop(player->player_b);
-                break;
-        default:
-                break;
-        }
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        libvlc_media_player_stop(deck->player);
 }
 
 /**
@@ -285,16 +449,12 @@ void aras_player_set_state_ready(struct aras_player *player, int unit)
  */
 void aras_player_set_state_paused(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                libvlc_media_player_pause(player->player_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                libvlc_media_player_pause(player->player_b);
-                break;
-        default:
-                break;
-        }
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        libvlc_media_player_pause(deck->player);
 }
 
 /**
@@ -305,16 +465,12 @@ void aras_player_set_state_paused(struct aras_player *player, int unit)
  */
 void aras_player_set_state_playing(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                libvlc_media_player_play(player->player_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                libvlc_media_player_play(player->player_b);
-                break;
-        default:
-                break;
-        }
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        libvlc_media_player_play(deck->player);
 }
 
 /**
@@ -329,14 +485,69 @@ void aras_player_set_current_unit(struct aras_player *player, int unit)
 }
 
 /**
- * This function sets the player current unit.
+ * This function sets the function called when a player event requires the
+ * attention of the engine, such as the end of the stream or an error.
+ *
+ * @param   player          Pointer to the player
+ * @param   callback_wake   Pointer to the wake up function, NULL to disable it
+ * @param   data            Pointer to the data passed to the wake up function
+ */
+void aras_player_set_callback_wake(struct aras_player *player, void (*callback_wake)(void *data), void *data)
+{
+        player->callback_wake = callback_wake;
+        player->callback_wake_data = data;
+}
+
+/**
+ * This function allocates a free deck of the pool of a player, stopped decks
+ * first.
+ *
+ * @param   player  Pointer to the player
+ * @return  The identifier of the player unit, ARAS_PLAYER_UNIT_NONE if every
+ *          deck is allocated
+ */
+int aras_player_alloc_unit(struct aras_player *player)
+{
+        int unit;
+        int free_unit;
+        int state;
+
+        free_unit = ARAS_PLAYER_UNIT_NONE;
+        for (unit = 0; unit < player->units; unit++) {
+                if (player->deck[unit].allocated)
+                        continue;
+                aras_player_get_state(player, unit, &state);
+                if (state == ARAS_PLAYER_STATE_STOP) {
+                        free_unit = unit;
+                        break;
+                }
+                if (free_unit == ARAS_PLAYER_UNIT_NONE)
+                        free_unit = unit;
+        }
+
+        if (free_unit != ARAS_PLAYER_UNIT_NONE)
+                player->deck[free_unit].allocated = 1;
+
+        return free_unit;
+}
+
+/**
+ * This function releases a deck of the pool of a player. The deck is muted
+ * and stopped, its media player is kept for the next allocation.
  *
  * @param   player  Pointer to the player
  * @param   unit    The identifier of the player unit
  */
-void aras_player_swap_current_unit(struct aras_player *player)
+void aras_player_release_unit(struct aras_player *player, int unit)
 {
-        player->current_unit = (player->current_unit + 1) % 2;
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return;
+
+        aras_player_set_volume(player, unit, 0);
+        aras_player_set_state_ready(player, unit);
+        deck->allocated = 0;
 }
 
 /**
@@ -348,14 +559,12 @@ void aras_player_swap_current_unit(struct aras_player *player)
  */
 float aras_player_get_volume(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                return(player->volume_a);
-        case ARAS_PLAYER_UNIT_B:
-                return(player->volume_b);
-        default:
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
                 return 0;
-        }
+
+        return deck->volume;
 }
 
 /**
@@ -367,19 +576,13 @@ float aras_player_get_volume(struct aras_player *player, int unit)
  */
 void aras_player_get_state(struct aras_player *player, int unit, int *state)
 {
+        struct aras_player_deck *deck;
         libvlc_state_t vlc_state;
 
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                vlc_state = libvlc_media_player_get_state(player->player_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                vlc_state = libvlc_media_player_get_state(player->player_b);
-                break;
-        default:
-                vlc_state = libvlc_media_player_get_state(player->player_a);
-                break;
-        }
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                deck = &player->deck[0];
+
+        vlc_state = libvlc_media_player_get_state(deck->player);
 
         switch (vlc_state) {
         case libvlc_Error:
@@ -412,6 +615,24 @@ void aras_player_get_state(struct aras_player *player, int unit, int *state)
         }
 }
 
+/**
+ * This function checks whether a player unit is prerolled, that is, paused
+ * with the media ready to start playing.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  1 if the unit is prerolled, 0 otherwise
+ */
+int aras_player_get_prerolled(struct aras_player *player, int unit)
+{
+        int state;
+
+        /* The media is opened when playback starts, it is only created in advance */
+        aras_player_get_state(player, unit, &state);
+
+        return state != ARAS_PLAYER_STATE_ERROR;
+}
+
 /**
  * This function returns the buffer percent field in a player structure.
  *
@@ -421,14 +642,12 @@ void aras_player_get_state(struct aras_player *player, int unit, int *state)
  */
 int aras_player_get_buffer_percent(struct aras_player *player, int unit)
 {
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                return player->buffer_percent_a;
-        case ARAS_PLAYER_UNIT_B:
-                return player->buffer_percent_b;
-        default:
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
                 return 0;
-        }
+
+        return deck->buffer_percent;
 }
 
 /**
@@ -442,6 +661,34 @@ int aras_player_get_current_unit(struct aras_player *player)
         return player->current_unit;
 }
 
+/**
+ * This function returns the number of decks in the pool of a player.
+ *
+ * @param   player  Pointer to the player
+ * @return  The number of player units
+ */
+int aras_player_get_units(struct aras_player *player)
+{
+        return player->units;
+}
+
+/**
+ * This function checks whether a deck of the pool of a player is allocated.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  1 if the unit is allocated, 0 otherwise
+ */
+int aras_player_get_allocated(struct aras_player *player, int unit)
+{
+        struct aras_player_deck *deck;
+
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        return deck->allocated;
+}
+
 /**
  * This function returns the duration in miliseconds of the file being played in
  * a player structure.
@@ -452,20 +699,12 @@ int aras_player_get_current_unit(struct aras_player *player)
  */
 long int aras_player_get_duration(struct aras_player *player, int unit)
 {
-        int64_t duration;
+        struct aras_player_deck *deck;
 
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                duration = libvlc_media_player_get_length(player->player_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                duration = libvlc_media_player_get_length(player->player_b);
-                break;
-        default:
-                duration = 0;
-                break;
-        }
-        return duration;
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        return libvlc_media_player_get_length(deck->player);
 }
 
 /**
@@ -478,18 +717,23 @@ long int aras_player_get_duration(struct aras_player *player, int unit)
  */
 long int aras_player_get_position(struct aras_player *player, int unit)
 {
-        int64_t position;
+        struct aras_player_deck *deck;
 
-        switch (unit) {
-        case ARAS_PLAYER_UNIT_A:
-                position = libvlc_media_player_get_time(player->player_a);
-                break;
-        case ARAS_PLAYER_UNIT_B:
-                position = libvlc_media_player_get_time(player->player_b);
-                break;
-        default:
-                        position = 0;
-                break;
-        }
-        return position;
+        if ((deck = aras_player_get_deck(player, unit)) == NULL)
+                return 0;
+
+        return libvlc_media_player_get_time(deck->player);
+}
+
+/**
+ * This function returns the number of queued URIs that have started playing
+ * in a player unit since the last call.
+ *
+ * @param   player  Pointer to the player
+ * @param   unit    The identifier of the player unit
+ * @return  0, gapless playback is not supported
+ */
+int aras_player_take_next_started(struct aras_player *player, int unit)
+{
+        return 0;
 }
@@ -33,6 +33,7 @@
 #include <glib.h>
 #include <aras/parse.h>
 #include <aras/block.h>
+#include <aras/media.h>
 #include <aras/playlist.h>
 
 /**
@@ -74,35 +75,49 @@ GList *aras_playlist_free(GList *playlist)
 
 /**
  * This function performs a random permutation of the playlist according to the
- * Fisher-Yates algorithm.
+ * Fisher-Yates algorithm. The permutation is performed on an array with the
+ * playlist data, so it takes linear time.
  *
  * @param   playlist    Pointer to the playlist
+ * @param   rand        Pointer to the pseudorandom number generator, NULL for
+ *                      the global one
  *
  * @return  The playlist itself
  */
-GList *aras_playlist_shuffle(GList *playlist)
+GList *aras_playlist_shuffle(GList *playlist, GRand *rand)
 {
         int n;
         int i;
         int j;
-        GList *pointer_1;
-        GList *pointer_2;
-        char *aux;
+        GList *pointer;
+        gpointer *array;
+        gpointer aux;
 
         if (playlist == NULL)
                 return playlist;
 
+        /* Copy the playlist data to an array */
         n = g_list_length(playlist);
+        array = g_new(gpointer, n);
+        for (pointer = playlist, i = 0; pointer != NULL; pointer = pointer->next, i++)
+                array[i] = pointer->data;
+
+        /* Shuffle the array */
         for (i = n - 1; i > 0; i--) {
-                j = rand() % (i + 1);
-                pointer_1 = g_list_nth(playlist, i);
-                pointer_2 = g_list_nth(playlist, j);
-                if ((pointer_1 != NULL) && (pointer_2 != NULL)) {
-                        aux = pointer_1->data;
-                        pointer_1->data = pointer_2->data;
-                        pointer_2->data = aux;
-                }
+                if (rand != NULL)
+                        j = g_rand_int_range(rand, 0, i + 1);
+                else
+                        j = g_random_int_range(0, i + 1);
+                aux = array[i];
+                array[i] = array[j];
+                array[j] = aux;
         }
+
+        /* Copy the array back to the playlist */
+        for (pointer = playlist, i = 0; pointer != NULL; pointer = pointer->next, i++)
+                pointer->data = array[i];
+        g_free(array);
+
         return playlist;
 }
 
@@ -178,99 +193,46 @@ GList *aras_playlist_load_m3u(GList *playlist, char *data)
         return playlist;
 }
 
-/**
- * This function adds a set of URIs to the playlist from a local directory.
- *
- * @param   playlist    Pointer to the playlist
- * @param   data        Pointer to the path string of a local directory
- * @param   recursion   Recursion counter used to limit recursions
- *
- * @return  The augmented playlist if success, NULL if error
- */
-GList *aras_playlist_load_directory(GList *playlist, char *data, int recursion)
-{
-        GDir *dir;
-        const char *entry;
-        char *path;
-        char *node = NULL;
-
-        /* If recursion is too deep, return the playlist itself */
-        if (recursion >= ARAS_PLAYLIST_MAX_RECURSION_DEPTH) {
-                fprintf(stderr, "aras: maximum number of recursions reached\n");
-                return playlist;
-        }
-
-        if (data == NULL)
-                return playlist;
-
-        /* Reverse the list */
-        playlist = g_list_reverse(playlist);
-
-        /* Open directory */
-        if ((dir = g_dir_open(data, 0, NULL)) == NULL)
-                return playlist;
-
-        /* Read directory entries */
-        while ((entry = g_dir_read_name(dir)) != NULL) {
-                /* Get the full path for entries */
-                path = g_build_filename(data, entry, NULL);
-                /* Check if the entry is a regular file or a subdirectory */
-                if (g_file_test(path, G_FILE_TEST_IS_REGULAR) == TRUE) {
-                        /* Add regular file to the playlist */
-                        if ((node = g_filename_to_uri(path, NULL, NULL)) != NULL)
-                                playlist = g_list_prepend(playlist, node);
-                } else if (g_file_test(path, G_FILE_TEST_IS_DIR) == TRUE) {
-                        /* If a directory, recursive call */
-                        playlist = aras_playlist_load_directory(playlist, path, recursion + 1);
-                }
-                g_free(path);
-        }
-
-        /* Reverse the list */
-        playlist = g_list_reverse(playlist);
-
-        /* Close directory */
-        g_dir_close(dir);
-
-        return playlist;
-}
-
 /**
  * This function adds a set of URIs to the playlist from a local directory and
  * performs a random permutation of the acquired playlist.
  *
  * @param   playlist    Pointer to the playlist
  * @param   data        Pointer to the path string of a local directory
+ * @param   rand        Pointer to the pseudorandom number generator
  *
  * @return  The augmented playlist if success, NULL if error
  */
-GList *aras_playlist_load_random_directory(GList *playlist, char *data)
+GList *aras_playlist_load_random_directory(GList *playlist, char *data, GRand *rand)
 {
         if (data == NULL)
                 return playlist;
 
-        playlist = aras_playlist_load_directory(playlist, data, 0);
-        playlist = aras_playlist_shuffle(playlist);
+        playlist = aras_media_load_directory(playlist, data);
+        playlist = aras_playlist_shuffle(playlist, rand);
 
         return playlist;
 }
 
 /**
- * This function adds a random URI to the playlist from a local directory.
+ * This function adds a random URI to the playlist tail from a local directory.
+ * The URI is picked from the directory index without shuffling the directory.
  *
  * @param   playlist    Pointer to the playlist
  * @param   data        Pointer to the path string of a local directory
+ * @param   rand        Pointer to the pseudorandom number generator
  *
  * @return  The playlist if success, NULL if error
  */
-GList *aras_playlist_load_random_file(GList *playlist, char *data)
+GList *aras_playlist_load_random_file(GList *playlist, char *data, GRand *rand)
 {
+        char *node;
+
         if (data == NULL)
                 return playlist;
 
-        if ((playlist = aras_playlist_load_random_directory(playlist, data)) != NULL)
-                if (playlist->next != NULL)
-                        playlist->next = aras_playlist_free(playlist->next);
+        if ((node = aras_media_pick_file(data, rand)) != NULL)
+                playlist = g_list_append(playlist, node);
 
         return playlist;
 }
@@ -284,10 +246,11 @@ GList *aras_playlist_load_random_file(GList *playlist, char *data)
  * @param   data        Pointer to the data string containing block names and
  *                      multiplicities
  * @param   recursion   Recursion counter used to limit recursions
+ * @param   rand        Pointer to the pseudorandom number generator
  *
  * @return  The playlist if success, NULL if error
  */
-GList *aras_playlist_load_interleave(GList *playlist, struct aras_block *block, char *data, int recursion)
+GList *aras_playlist_load_interleave(GList *playlist, struct aras_block *block, char *data, int recursion, GRand *rand)
 {
         int k;
         char arguments[4][ARAS_BLOCK_MAX_NAME];
@@ -323,8 +286,8 @@ GList *aras_playlist_load_interleave(GList *playlist, struct aras_block *block,
         playlist_1 = playlist_2 = NULL;
 
         /* If any playlist does not grow up, free both playlists and return the input playlist */
-        if (((playlist_1 = aras_playlist_load(playlist_1, &arguments[0][0], block, recursion + 1)) == NULL) ||
-            ((playlist_2 = aras_playlist_load(playlist_2, &arguments[1][0], block, recursion + 1)) == NULL)) {
+        if (((playlist_1 = aras_playlist_load(playlist_1, &arguments[0][0], block, recursion + 1, rand)) == NULL) ||
+            ((playlist_2 = aras_playlist_load(playlist_2, &arguments[1][0], block, recursion + 1, rand)) == NULL)) {
                 playlist_1 = aras_playlist_free(playlist_1);
                 playlist_2 = aras_playlist_free(playlist_2);
                 return playlist;
@@ -364,27 +327,21 @@ GList *aras_playlist_load_interleave(GList *playlist, struct aras_block *block,
 }
 
 /**
- * This function receives a playlist, a block name, a block structure and a
- * recursion counter, it looks for the block node and adds the appropriate
- * playlist to the playlist list.
+ * This function receives a playlist, a block node, a block structure and a
+ * recursion counter and adds the appropriate playlist to the playlist list.
  *
  * @param   playlist    A pointer to the playlist
- * @param   block_name  A pointer to the block name string
+ * @param   block_node  A pointer to the block node
  * @param   block       A pointer to a block structure
  * @param   recursion   Recursion counter used to limit recursions
+ * @param   rand        Pointer to the pseudorandom number generator
  *
  * @return  The playlist if success, NULL if error
  */
-GList *aras_playlist_load(GList *playlist, char *block_name, struct aras_block *block, int recursion)
+GList *aras_playlist_load_block_node(GList *playlist, struct aras_block_node *block_node, struct aras_block *block, int recursion, GRand *rand)
 {
-        struct aras_block_node *block_node;
-
-        /* Check if block name is NULL */
-        if (block == NULL || block_name == NULL)
-                return playlist;
-
-        /* Look for the block node in block list */
-        if ((block_node = aras_block_seek_node_name(block, block_name)) == NULL)
+        /* Check if block node is NULL */
+        if (block == NULL || block_node == NULL)
                 return playlist;
 
         /* Load playlist according to the block type */
@@ -396,16 +353,39 @@ GList *aras_playlist_load(GList *playlist, char *block_name, struct aras_block *
                 return aras_playlist_load_m3u(playlist, block_node->data);
                 break;
         case ARAS_BLOCK_TYPE_RANDOM:
-                return aras_playlist_load_random_directory(playlist, block_node->data);
+                return aras_playlist_load_random_directory(playlist, block_node->data, rand);
                 break;
         case ARAS_BLOCK_TYPE_RANDOM_FILE:
-                return aras_playlist_load_random_file(playlist, block_node->data);
+                return aras_playlist_load_random_file(playlist, block_node->data, rand);
                 break;
         case ARAS_BLOCK_TYPE_INTERLEAVE:
-                return aras_playlist_load_interleave(playlist, block, block_node->data, recursion);
+                return aras_playlist_load_interleave(playlist, block, block_node->data, recursion, rand);
                 break;
         default:
                 break;
         }
         return playlist;
 }
+
+/**
+ * This function receives a playlist, a block name, a block structure and a
+ * recursion counter, it looks for the block node and adds the appropriate
+ * playlist to the playlist list.
+ *
+ * @param   playlist    A pointer to the playlist
+ * @param   block_name  A pointer to the block name string
+ * @param   block       A pointer to a block structure
+ * @param   recursion   Recursion counter used to limit recursions
+ * @param   rand        Pointer to the pseudorandom number generator
+ *
+ * @return  The playlist if success, NULL if error
+ */
+GList *aras_playlist_load(GList *playlist, char *block_name, struct aras_block *block, int recursion, GRand *rand)
+{
+        /* Check if block name is NULL */
+        if (block == NULL || block_name == NULL)
+                return playlist;
+
+        /* Look for the block node in block list */
+        return aras_playlist_load_block_node(playlist, aras_block_seek_node_name(block, block_name), block, recursion, rand);
+}
@@ -34,6 +34,8 @@
 #include <glib.h>
 #include <aras/parse.h>
 #include <aras/time.h>
+#include <aras/log.h>
+#include <aras/block.h>
 #include <aras/schedule.h>
 
 /**
@@ -132,14 +134,16 @@ void aras_schedule_node_set_time(struct aras_schedule_node *node, long int time)
 }
 
 /**
- * This function sets the block_name field in a schedule structure.
+ * This function sets the block_name field in a schedule structure. The block
+ * node is resolved later by aras_schedule_resolve.
  *
  * @param   schedule    Pointer to the schedule structure
  * @param   block_name  Pointer to the block name string
  */
 void aras_schedule_node_set_block_name(struct aras_schedule_node *node, char *block_name)
 {
-        snprintf(node->block_name, sizeof(node->block_name), "%s", block_name);
+        node->block_name = g_intern_string(block_name);
+        node->block_node = NULL;
 }
 
 /**
@@ -205,6 +209,77 @@ int aras_schedule_load_line(struct aras_schedule *schedule, char *line)
         return 0;
 }
 
+/**
+ * This function compares two schedule nodes according to their week time.
+ *
+ * @param   a   Pointer to the first schedule node
+ * @param   b   Pointer to the second schedule node
+ *
+ * @return  A negative value if a is earlier than b, a positive value if a is
+ *          later than b, 0 if both have the same week time
+ */
+int aras_schedule_node_compare(const void *a, const void *b)
+{
+        const struct aras_schedule_node *node_a = a;
+        const struct aras_schedule_node *node_b = b;
+
+        if (node_a->time < node_b->time)
+                return -1;
+        else if (node_a->time > node_b->time)
+                return 1;
+        else
+                return 0;
+}
+
+/**
+ * This function moves the nodes in the schedule list to the schedule array,
+ * which is kept sorted by week time. Nodes with the same week time keep the
+ * order in which they were loaded.
+ *
+ * @param   schedule    Pointer to the schedule structure
+ *
+ * @return  This function always returns 0
+ */
+int aras_schedule_build_array(struct aras_schedule *schedule)
+{
+        GList *pointer;
+        struct aras_schedule_node *array;
+        int length;
+        int i;
+        int j;
+
+        if (schedule->list == NULL)
+                return 0;
+
+        /* Sort the schedule list, g_list_sort is a stable sort */
+        schedule->list = g_list_sort(schedule->list, aras_schedule_node_compare);
+
+        /* Merge the schedule array and the schedule list in a new array */
+        length = schedule->length + g_list_length(schedule->list);
+        array = g_new(struct aras_schedule_node, length);
+
+        pointer = schedule->list;
+        i = j = 0;
+        while (i < schedule->length || pointer != NULL) {
+                if (pointer == NULL ||
+                    (i < schedule->length && aras_schedule_node_compare(&schedule->array[i], pointer->data) <= 0)) {
+                        array[j++] = schedule->array[i++];
+                } else {
+                        array[j++] = *(struct aras_schedule_node *)pointer->data;
+                        pointer = pointer->next;
+                }
+        }
+
+        /* Replace the schedule array and free the schedule list */
+        g_free(schedule->array);
+        schedule->array = array;
+        schedule->length = length;
+        g_list_free_full(schedule->list, g_free);
+        schedule->list = NULL;
+
+        return 0;
+}
+
 /**
  * This function loads in a schedule structure the data contained in a file.
  *
@@ -229,6 +304,9 @@ int aras_schedule_load_file(struct aras_schedule *schedule, char *file)
         /* Reverse the schedule list */
         schedule->list = g_list_reverse(schedule->list);
 
+        /* Sort the loaded nodes in the schedule array */
+        aras_schedule_build_array(schedule);
+
         /* Close schedule file */
         if (fclose(fp) != 0)
                 return -1;
@@ -248,14 +326,17 @@ int aras_schedule_init(struct aras_schedule *schedule)
         /* Clean structure */
         memset(schedule, 0, sizeof(*schedule));
 
-        /* Schedule list initialization */
+        /* Schedule list and array initialization */
         schedule->list = NULL;
+        schedule->array = NULL;
+        schedule->length = 0;
         return 0;
 }
 
 
 /**
- * This function receives a schedule structure and frees the schedule list.
+ * This function receives a schedule structure and frees the schedule list and
+ * the schedule array.
  *
  * @param   schedule    Pointer to the schedule structure
  *
@@ -265,75 +346,178 @@ int aras_schedule_list_free(struct aras_schedule *schedule)
 {
         g_list_free_full(schedule->list, g_free);
         schedule->list = NULL;
+        g_free(schedule->array);
+        schedule->array = NULL;
+        schedule->length = 0;
+
+        return 0;
+}
+
+/**
+ * This function copies the schedule array of a schedule structure to another
+ * schedule structure, including the block nodes of the schedule nodes.
+ *
+ * @param   schedule    Pointer to the destination schedule structure
+ * @param   source      Pointer to the source schedule structure
+ *
+ * @return  This function always returns 0
+ */
+int aras_schedule_copy(struct aras_schedule *schedule, struct aras_schedule *source)
+{
+        g_free(schedule->array);
+        schedule->array = g_new(struct aras_schedule_node, source->length > 0 ? source->length : 1);
+        memcpy(schedule->array, source->array, source->length * sizeof(struct aras_schedule_node));
+        schedule->length = source->length;
 
         return 0;
 }
 
+/**
+ * This function links each node in the schedule array to the block node with
+ * the same name, so that the engine does not need to seek blocks by name.
+ * Each unknown block name is written once in the log file.
+ *
+ * @param   schedule    Pointer to the schedule structure
+ * @param   block       Pointer to the block structure
+ * @param   log_file    The name of the log file
+ *
+ * @return  The number of unknown block names
+ */
+int aras_schedule_resolve(struct aras_schedule *schedule, struct aras_block *block, char *log_file)
+{
+        char msg[ARAS_LOG_MESSAGE_MAX];
+        GHashTable *unknown;
+        int count;
+        int i;
+
+        unknown = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+        for (i = 0; i < schedule->length; i++) {
+                schedule->array[i].block_node = aras_block_seek_node_name(block, (char*)schedule->array[i].block_name);
+
+                /* Block names are interned, so pointers can be compared */
+                if (schedule->array[i].block_node == NULL && g_hash_table_add(unknown, (gpointer)schedule->array[i].block_name)) {
+                        snprintf(msg, sizeof(msg), "Unknown block: \"%s\"\n", schedule->array[i].block_name);
+                        aras_log_write(log_file, msg);
+                }
+        }
+
+        count = g_hash_table_size(unknown);
+        g_hash_table_destroy(unknown);
+
+        return count;
+}
+
+/**
+ * This function receives a schedule structure and a time and returns the index
+ * of the first node in the schedule array whose time is not earlier than the
+ * time.
+ *
+ * @param   schedule    Pointer to the schedule structure
+ * @param   time        Week time to be sought
+ *
+ * @return  The index of the first node not earlier than the time, the length of
+ *          the schedule array if all the nodes are earlier than the time
+ */
+int aras_schedule_lower_bound(struct aras_schedule *schedule, long int time)
+{
+        int low;
+        int high;
+        int middle;
+
+        low = 0;
+        high = schedule->length;
+        while (low < high) {
+                middle = low + (high - low) / 2;
+                if (schedule->array[middle].time < time)
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+
+        return low;
+}
+
+/**
+ * This function receives a schedule structure and a time and returns the index
+ * of the first node in the schedule array whose time is later than the time.
+ *
+ * @param   schedule    Pointer to the schedule structure
+ * @param   time        Week time to be sought
+ *
+ * @return  The index of the first node later than the time, the length of the
+ *          schedule array if no node is later than the time
+ */
+int aras_schedule_upper_bound(struct aras_schedule *schedule, long int time)
+{
+        int low;
+        int high;
+        int middle;
+
+        low = 0;
+        high = schedule->length;
+        while (low < high) {
+                middle = low + (high - low) / 2;
+                if (schedule->array[middle].time <= time)
+                        low = middle + 1;
+                else
+                        high = middle;
+        }
+
+        return low;
+}
+
 /**
  * This function receives a schedule structure and a time and returns a pointer
- * to the current node in the schedule in relation to the time
+ * to the current node in the schedule in relation to the time, that is, the
+ * last node started at or before the time in a weekly cyclic way.
  *
  * @param   schedule    Pointer to the schedule structure
- * @param   time        Time in relation to which the next node is sought
+ * @param   time        Time in relation to which the current node is sought
  *
- * @return  A pointer to the current node in the schedule in relation to the
- *          time
+ * @return  A pointer to the current node if the schedule is not empty
+ *          A pointer to NULL if the schedule is empty
  */
 struct aras_schedule_node *aras_schedule_seek_node_current(struct aras_schedule *schedule, long int time)
 {
-        GList *pointer;
-        struct aras_schedule_node *node;
-        struct aras_schedule_node *next_node;
+        int i;
 
-        if (schedule == NULL)
+        if (schedule == NULL || schedule->length == 0)
                 return NULL;
 
-        pointer = schedule->list;
-        next_node = pointer->data;
+        /* Last node not later than the time, wrap to the end of the week */
+        if ((i = aras_schedule_upper_bound(schedule, time) - 1) < 0)
+                i = schedule->length - 1;
 
-        while (pointer != NULL) {
-                node = pointer->data;
-                if (aras_time_difference(time, node->time) < aras_time_difference(time, next_node->time))
-                        next_node = node;
-                pointer = pointer->next;
-        }
+        /* First node loaded with the same time */
+        i = aras_schedule_lower_bound(schedule, schedule->array[i].time);
 
-        return (struct aras_schedule_node *)next_node;
+        return &schedule->array[i];
 }
 
 /**
  * This function receives a schedule structure and a time and returns a pointer
- * to the next node in the schedule in relation to the time
+ * to the next node in the schedule in relation to the time, that is, the first
+ * node starting after the time in a weekly cyclic way.
  *
  * @param   schedule    Pointer to the schedule structure
  * @param   time        Time in relation to which the next node is sought
  *
- * @return  A pointer to the next node if next node found
- *          A pointer to NULL if next node not found
+ * @return  A pointer to the next node if the schedule is not empty
+ *          A pointer to NULL if the schedule is empty
  */
 struct aras_schedule_node *aras_schedule_seek_node_next(struct aras_schedule *schedule, long int time)
 {
-        GList *pointer;
-        struct aras_schedule_node *node;
-        struct aras_schedule_node *next_node;
-        long int time_difference;
+        int i;
 
-        if (schedule == NULL)
+        if (schedule == NULL || schedule->length == 0)
                 return NULL;
 
-        pointer = schedule->list;
-        next_node = pointer->data;
-
-        while (pointer != NULL) {
-                node = pointer->data;
-                time_difference = aras_time_difference(node->time, time);
-                if (time_difference < aras_time_difference(next_node->time, time) &&
-                    time_difference > 0)
-                                next_node = node;
-                pointer = pointer->next;
-        }
+        /* First node later than the time, wrap to the beginning of the week */
+        if ((i = aras_schedule_upper_bound(schedule, time)) == schedule->length)
+                i = 0;
 
-        return (struct aras_schedule_node *)next_node;
+        return &schedule->array[i];
 }
 
 /**
@@ -343,18 +527,13 @@ struct aras_schedule_node *aras_schedule_seek_node_next(struct aras_schedule *sc
  */
 void aras_schedule_print(struct aras_schedule *schedule)
 {
-        GList *pointer;
-        struct aras_schedule_node *node;
+        int i;
 
         printf("Schedule list\n");
         printf("-------------\n");
 
-        pointer = schedule->list;
-        while (pointer != NULL) {
-                node = pointer->data;
-                printf("%s %ld\n", node->block_name, node->time);
-                pointer = pointer->next;
-        }
+        for (i = 0; i < schedule->length; i++)
+                printf("%s %ld\n", schedule->array[i].block_name, schedule->array[i].time);
 
         printf("\n");
         fflush(stdout);
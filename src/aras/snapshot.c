@@ -0,0 +1,601 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Source file for the ARAS Radio Automation System. Functions for the snapshot
+ * module.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <glib.h>
+#include <aras/log.h>
+#include <aras/configuration.h>
+#include <aras/schedule.h>
+#include <aras/block.h>
+#include <aras/media.h>
+#include <aras/snapshot.h>
+
+/**
+ * This function allocates a configuration structure shared between snapshots.
+ *
+ * @return  A pointer to the new configuration structure
+ */
+struct aras_configuration *aras_snapshot_configuration_new(void)
+{
+        struct aras_configuration *configuration;
+
+        configuration = g_atomic_rc_box_new(struct aras_configuration);
+        aras_configuration_init(configuration);
+
+        return configuration;
+}
+
+/**
+ * This function allocates a schedule structure shared between snapshots.
+ *
+ * @return  A pointer to the new schedule structure
+ */
+struct aras_schedule *aras_snapshot_schedule_new(void)
+{
+        struct aras_schedule *schedule;
+
+        schedule = g_atomic_rc_box_new(struct aras_schedule);
+        aras_schedule_init(schedule);
+
+        return schedule;
+}
+
+/**
+ * This function allocates a block structure shared between snapshots.
+ *
+ * @return  A pointer to the new block structure
+ */
+struct aras_block *aras_snapshot_block_new(void)
+{
+        struct aras_block *block;
+
+        block = g_atomic_rc_box_new(struct aras_block);
+        aras_block_init(block);
+
+        return block;
+}
+
+/**
+ * This function creates a snapshot with the default configuration, an empty
+ * schedule and an empty block. The reference count is set to 1.
+ *
+ * @return  A pointer to the new snapshot
+ */
+struct aras_snapshot *aras_snapshot_new(void)
+{
+        struct aras_snapshot *snapshot;
+
+        snapshot = g_new(struct aras_snapshot, 1);
+        snapshot->ref_count = 1;
+        snapshot->configuration = aras_snapshot_configuration_new();
+        snapshot->schedule = aras_snapshot_schedule_new();
+        snapshot->block = aras_snapshot_block_new();
+
+        return snapshot;
+}
+
+/**
+ * This function loads in a snapshot the configuration file and the schedule
+ * and block files it refers to. Missing schedule or block files leave the
+ * schedule or the block empty.
+ *
+ * @param   snapshot            Pointer to the snapshot
+ * @param   configuration_file  Pointer to the configuration file name string
+ *
+ * @return  0 if success, -1 if the configuration file cannot be loaded
+ */
+int aras_snapshot_load_file(struct aras_snapshot *snapshot, char *configuration_file)
+{
+        if (aras_configuration_load_file(snapshot->configuration, configuration_file) == -1)
+                return -1;
+
+        aras_schedule_load_file(snapshot->schedule, snapshot->configuration->schedule_file);
+        aras_block_load_file(snapshot->block, snapshot->configuration->block_file);
+        aras_schedule_resolve(snapshot->schedule, snapshot->block, snapshot->configuration->log_file);
+
+        return 0;
+}
+
+/**
+ * This function increases the reference count of a snapshot.
+ *
+ * @param   snapshot    Pointer to the snapshot
+ *
+ * @return  The pointer to the snapshot
+ */
+struct aras_snapshot *aras_snapshot_ref(struct aras_snapshot *snapshot)
+{
+        if (snapshot != NULL)
+                g_atomic_int_inc(&snapshot->ref_count);
+
+        return snapshot;
+}
+
+/**
+ * This function decreases the reference count of a snapshot and frees it when
+ * the count reaches 0. The configuration, schedule and block are freed when no
+ * other snapshot shares them.
+ *
+ * @param   snapshot    Pointer to the snapshot
+ */
+void aras_snapshot_unref(struct aras_snapshot *snapshot)
+{
+        if (snapshot == NULL)
+                return;
+
+        if (!g_atomic_int_dec_and_test(&snapshot->ref_count))
+                return;
+
+        g_atomic_rc_box_release(snapshot->configuration);
+        g_atomic_rc_box_release_full(snapshot->schedule, (GDestroyNotify)aras_schedule_list_free);
+        g_atomic_rc_box_release_full(snapshot->block, (GDestroyNotify)aras_block_list_free);
+        g_free(snapshot);
+}
+
+/**
+ * This function returns a new reference to the published snapshot. The caller
+ * releases it with aras_snapshot_unref.
+ *
+ * @param   snapshot    Pointer to the published snapshot pointer
+ *
+ * @return  A pointer to the published snapshot
+ */
+struct aras_snapshot *aras_snapshot_get(struct aras_snapshot **snapshot)
+{
+        return aras_snapshot_ref(g_atomic_pointer_get(snapshot));
+}
+
+/**
+ * This function computes the checksum of the contents of a file.
+ *
+ * @param   file    Pointer to the file name string
+ *
+ * @return  A newly allocated checksum string, NULL if the file cannot be read
+ */
+char *aras_snapshot_checksum(char *file)
+{
+        gchar *contents;
+        gsize length;
+        gchar *checksum;
+
+        if (!g_file_get_contents(file, &contents, &length, NULL))
+                return NULL;
+
+        checksum = g_compute_checksum_for_data(G_CHECKSUM_SHA1, (guchar*)contents, length);
+        g_free(contents);
+
+        return checksum;
+}
+
+/**
+ * This function checks whether the contents of a file differ from the ones
+ * seen in the previous reload and stores the new checksum.
+ *
+ * @param   reload  Pointer to the snapshot reload structure
+ * @param   index   The index of the file
+ * @param   file    Pointer to the file name string
+ *
+ * @return  1 if the contents changed, 0 otherwise
+ */
+int aras_snapshot_reload_changed(struct aras_snapshot_reload *reload, int index, char *file)
+{
+        char *checksum;
+
+        checksum = aras_snapshot_checksum(file);
+        if (g_strcmp0(checksum, reload->checksum[index]) == 0) {
+                g_free(checksum);
+                return 0;
+        }
+
+        g_free(reload->checksum[index]);
+        reload->checksum[index] = checksum;
+
+        return 1;
+}
+
+/**
+ * This function returns the name of a file watched by a snapshot reload.
+ *
+ * @param   reload          Pointer to the snapshot reload structure
+ * @param   configuration   Pointer to the configuration structure
+ * @param   index           The index of the file
+ *
+ * @return  A pointer to the file name string
+ */
+char *aras_snapshot_reload_file(struct aras_snapshot_reload *reload, struct aras_configuration *configuration, int index)
+{
+        switch (index) {
+        case ARAS_SNAPSHOT_FILE_SCHEDULE:
+                return configuration->schedule_file;
+        case ARAS_SNAPSHOT_FILE_BLOCK:
+                return configuration->block_file;
+        default:
+                return reload->configuration_file;
+        }
+}
+
+/**
+ * This function initializes a snapshot reload structure. The checksums of the
+ * files loaded in the published snapshot are computed, so that the first
+ * reload skips unchanged files. The callbacks run in the thread default main
+ * context of the caller.
+ *
+ * @param   reload              Pointer to the snapshot reload structure
+ * @param   snapshot            Pointer to the published snapshot pointer
+ * @param   configuration_file  Pointer to the configuration file name string
+ *
+ * @return  This function always returns 0
+ */
+int aras_snapshot_reload_init(struct aras_snapshot_reload *reload, struct aras_snapshot **snapshot, char *configuration_file)
+{
+        int i;
+
+        reload->configuration_file = configuration_file;
+        reload->snapshot = snapshot;
+        reload->retired = NULL;
+        reload->thread = NULL;
+        reload->context = g_main_context_ref_thread_default();
+        reload->time = 0;
+        reload->pending = 0;
+        reload->loading = 0;
+        reload->watch_fd = -1;
+        reload->watch_channel = NULL;
+        reload->watch_source = 0;
+        reload->callback_done = NULL;
+        reload->callback_done_data = NULL;
+
+        for (i = 0; i < ARAS_SNAPSHOT_FILES; i++) {
+                reload->checksum[i] = aras_snapshot_checksum(aras_snapshot_reload_file(reload, (*snapshot)->configuration, i));
+                reload->watch_descriptor[i] = -1;
+                reload->watch_name[i] = NULL;
+        }
+
+        return 0;
+}
+
+/**
+ * This function sets the function called in the main loop after a new
+ * snapshot is published.
+ *
+ * @param   reload          Pointer to the snapshot reload structure
+ * @param   callback_done   Pointer to the function, NULL to disable it
+ * @param   data            Pointer to the data passed to the function
+ */
+void aras_snapshot_reload_set_callback_done(struct aras_snapshot_reload *reload, void (*callback_done)(void *data), void *data)
+{
+        reload->callback_done = callback_done;
+        reload->callback_done_data = data;
+}
+
+/**
+ * This function adds inotify watches on the directories containing the
+ * configuration, schedule and block files of the published snapshot. Watching
+ * the directories catches editors which replace files instead of rewriting
+ * them. Previous watches are removed.
+ *
+ * @param   reload  Pointer to the snapshot reload structure
+ *
+ * @return  0 if success, -1 if a directory cannot be watched
+ */
+int aras_snapshot_reload_watch_update(struct aras_snapshot_reload *reload)
+{
+        struct aras_snapshot *snapshot;
+        char *file;
+        char *directory;
+        int result;
+        int i;
+
+        result = 0;
+        snapshot = aras_snapshot_get(reload->snapshot);
+
+        for (i = 0; i < ARAS_SNAPSHOT_FILES; i++) {
+                /* Remove previous watch, descriptors are shared by files in the same directory */
+                if (reload->watch_descriptor[i] != -1)
+                        inotify_rm_watch(reload->watch_fd, reload->watch_descriptor[i]);
+                g_free(reload->watch_name[i]);
+
+                /* Watch the directory and remember the file name */
+                file = aras_snapshot_reload_file(reload, snapshot->configuration, i);
+                directory = g_path_get_dirname(file);
+                reload->watch_descriptor[i] = inotify_add_watch(reload->watch_fd, directory,
+                                                                IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+                reload->watch_name[i] = g_path_get_basename(file);
+                if (reload->watch_descriptor[i] == -1)
+                        result = -1;
+                g_free(directory);
+        }
+
+        aras_snapshot_unref(snapshot);
+
+        return result;
+}
+
+/**
+ * This function is the callback function for the inotify file descriptor. It
+ * starts a reload of the files changed.
+ *
+ * @param   channel     Pointer to the channel
+ * @param   condition   The condition
+ * @param   data        Pointer to the snapshot reload structure
+ *
+ * @return  This function always returns TRUE
+ */
+gboolean aras_snapshot_reload_callback_watch(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+        struct aras_snapshot_reload *reload;
+        struct inotify_event *event;
+        char buffer[ARAS_SNAPSHOT_WATCH_BUFFER] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+        ssize_t length;
+        char *pointer;
+        int files;
+        int i;
+
+        reload = (struct aras_snapshot_reload*)data;
+
+        files = 0;
+        while ((length = read(reload->watch_fd, buffer, sizeof(buffer))) > 0) {
+                for (pointer = buffer; pointer < buffer + length; pointer += sizeof(struct inotify_event) + event->len) {
+                        event = (struct inotify_event*)pointer;
+                        if (event->len == 0)
+                                continue;
+                        for (i = 0; i < ARAS_SNAPSHOT_FILES; i++) {
+                                if (event->wd == reload->watch_descriptor[i] && !strcmp(event->name, reload->watch_name[i]))
+                                        files |= 1 << i;
+                        }
+                }
+        }
+
+        if (files != 0)
+                aras_snapshot_reload_start(reload, files);
+
+        return TRUE;
+}
+
+/**
+ * This function starts watching the configuration, schedule and block files,
+ * so that changes are reloaded as soon as they are written.
+ *
+ * @param   reload  Pointer to the snapshot reload structure
+ *
+ * @return  0 if success, -1 if the files cannot be watched
+ */
+int aras_snapshot_reload_watch(struct aras_snapshot_reload *reload)
+{
+        GSource *source;
+
+        if ((reload->watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) == -1)
+                return -1;
+
+        if (aras_snapshot_reload_watch_update(reload) == -1) {
+                close(reload->watch_fd);
+                reload->watch_fd = -1;
+                return -1;
+        }
+
+        reload->watch_channel = g_io_channel_unix_new(reload->watch_fd);
+        source = g_io_create_watch(reload->watch_channel, G_IO_IN);
+        g_source_set_callback(source, (GSourceFunc)aras_snapshot_reload_callback_watch, reload, NULL);
+        reload->watch_source = g_source_attach(source, reload->context);
+        g_source_unref(source);
+
+        return 0;
+}
+
+/**
+ * This function is called in the main loop once a reload finishes. It writes
+ * the reload time in the log file, releases the retired snapshot, joins the
+ * reload thread and starts a new reload if more files changed meanwhile.
+ *
+ * @param   data    Pointer to the snapshot reload structure
+ *
+ * @return  This function always returns FALSE
+ */
+gboolean aras_snapshot_reload_done(gpointer data)
+{
+        struct aras_snapshot_reload *reload;
+        struct aras_snapshot *snapshot;
+        char msg[ARAS_LOG_MESSAGE_MAX];
+
+        reload = (struct aras_snapshot_reload*)data;
+
+        g_thread_join(reload->thread);
+        reload->thread = NULL;
+
+        /* The retired snapshot is NULL if nothing changed or the configuration file was not loaded */
+        if (reload->retired != NULL) {
+                snapshot = aras_snapshot_get(reload->snapshot);
+                snprintf(msg, sizeof(msg), "Configuration reload: %ld ms\n", (long int)(reload->time / 1000));
+                aras_log_write(snapshot->configuration->log_file, msg);
+
+                /* Follow the schedule and block files if their names changed */
+                if (reload->watch_fd != -1 &&
+                    (strcmp(snapshot->configuration->schedule_file, reload->retired->configuration->schedule_file) ||
+                     strcmp(snapshot->configuration->block_file, reload->retired->configuration->block_file)))
+                        aras_snapshot_reload_watch_update(reload);
+                aras_snapshot_unref(snapshot);
+
+                /* Drop the reference held while the snapshot was published */
+                aras_snapshot_unref(reload->retired);
+                reload->retired = NULL;
+
+                if (reload->callback_done != NULL)
+                        reload->callback_done(reload->callback_done_data);
+        }
+
+        /* Reload the files changed during the reload */
+        if (reload->pending != 0)
+                aras_snapshot_reload_start(reload, 0);
+
+        return FALSE;
+}
+
+/**
+ * This function is the body of the reload thread. It builds a new snapshot in
+ * which the files being reloaded are parsed again if their contents changed,
+ * and the rest of the data is shared with the published snapshot. Then, it
+ * publishes the new snapshot with an atomic pointer swap. The previous snapshot
+ * is released from the main loop, so callbacks running in the main loop can use
+ * the published snapshot until they return.
+ *
+ * @param   data    Pointer to the snapshot reload structure
+ *
+ * @return  This function always returns NULL
+ */
+gpointer aras_snapshot_reload_thread(gpointer data)
+{
+        struct aras_snapshot_reload *reload;
+        struct aras_snapshot *current;
+        struct aras_snapshot *snapshot;
+        struct aras_schedule *schedule;
+        int changed;
+        int schedule_loaded;
+        int block_loaded;
+        gint64 time;
+        GSource *source;
+
+        reload = (struct aras_snapshot_reload*)data;
+
+        time = g_get_monotonic_time();
+        current = aras_snapshot_get(reload->snapshot);
+        snapshot = g_new(struct aras_snapshot, 1);
+        snapshot->ref_count = 1;
+        changed = 0;
+        schedule_loaded = 0;
+        block_loaded = 0;
+
+        /* Configuration */
+        if ((reload->loading & (1 << ARAS_SNAPSHOT_FILE_CONFIGURATION)) &&
+            aras_snapshot_reload_changed(reload, ARAS_SNAPSHOT_FILE_CONFIGURATION, reload->configuration_file)) {
+                snapshot->configuration = aras_snapshot_configuration_new();
+                if (aras_configuration_load_file(snapshot->configuration, reload->configuration_file) == -1) {
+                        fprintf(stderr, "aras: unable to open configuration file ""%s""\n", reload->configuration_file);
+                        g_atomic_rc_box_release(snapshot->configuration);
+                        snapshot->configuration = g_atomic_rc_box_acquire(current->configuration);
+                } else {
+                        changed = 1;
+                }
+        } else {
+                snapshot->configuration = g_atomic_rc_box_acquire(current->configuration);
+        }
+
+        /* Files renamed in the configuration are always loaded */
+        if (strcmp(snapshot->configuration->schedule_file, current->configuration->schedule_file)) {
+                g_free(reload->checksum[ARAS_SNAPSHOT_FILE_SCHEDULE]);
+                reload->checksum[ARAS_SNAPSHOT_FILE_SCHEDULE] = NULL;
+                reload->loading |= 1 << ARAS_SNAPSHOT_FILE_SCHEDULE;
+        }
+        if (strcmp(snapshot->configuration->block_file, current->configuration->block_file)) {
+                g_free(reload->checksum[ARAS_SNAPSHOT_FILE_BLOCK]);
+                reload->checksum[ARAS_SNAPSHOT_FILE_BLOCK] = NULL;
+                reload->loading |= 1 << ARAS_SNAPSHOT_FILE_BLOCK;
+        }
+
+        /* Schedule */
+        if ((reload->loading & (1 << ARAS_SNAPSHOT_FILE_SCHEDULE)) &&
+            aras_snapshot_reload_changed(reload, ARAS_SNAPSHOT_FILE_SCHEDULE, snapshot->configuration->schedule_file)) {
+                snapshot->schedule = aras_snapshot_schedule_new();
+                aras_schedule_load_file(snapshot->schedule, snapshot->configuration->schedule_file);
+                schedule_loaded = 1;
+                changed = 1;
+        } else {
+                snapshot->schedule = g_atomic_rc_box_acquire(current->schedule);
+        }
+
+        /* Block */
+        if ((reload->loading & (1 << ARAS_SNAPSHOT_FILE_BLOCK)) &&
+            aras_snapshot_reload_changed(reload, ARAS_SNAPSHOT_FILE_BLOCK, snapshot->configuration->block_file)) {
+                snapshot->block = aras_snapshot_block_new();
+                aras_block_load_file(snapshot->block, snapshot->configuration->block_file);
+                aras_media_scan_block(snapshot->block);
+                block_loaded = 1;
+                changed = 1;
+        } else {
+                snapshot->block = g_atomic_rc_box_acquire(current->block);
+        }
+
+        /* Resolve the block nodes, a shared schedule is copied if only the block changed */
+        if (!schedule_loaded && block_loaded) {
+                schedule = aras_snapshot_schedule_new();
+                aras_schedule_copy(schedule, snapshot->schedule);
+                g_atomic_rc_box_release_full(snapshot->schedule, (GDestroyNotify)aras_schedule_list_free);
+                snapshot->schedule = schedule;
+        }
+        if (schedule_loaded || block_loaded)
+                aras_schedule_resolve(snapshot->schedule, snapshot->block, snapshot->configuration->log_file);
+
+        aras_snapshot_unref(current);
+
+        /* Publish the new snapshot only if something changed */
+        if (changed) {
+                reload->time = g_get_monotonic_time() - time;
+                do {
+                        reload->retired = g_atomic_pointer_get(reload->snapshot);
+                } while (!g_atomic_pointer_compare_and_exchange(reload->snapshot, reload->retired, snapshot));
+        } else {
+                aras_snapshot_unref(snapshot);
+        }
+
+        source = g_idle_source_new();
+        g_source_set_callback(source, aras_snapshot_reload_done, reload, NULL);
+        g_source_attach(source, reload->context);
+        g_source_unref(source);
+
+        return NULL;
+}
+
+/**
+ * This function starts reloading some files in a new thread. If a reload is
+ * already in progress, the files are reloaded once it finishes.
+ *
+ * @param   reload  Pointer to the snapshot reload structure
+ * @param   files   Bit mask of the files to be reloaded, the bit for each file
+ *                  is 1 shifted by one of these values:
+ *                  (1) ARAS_SNAPSHOT_FILE_CONFIGURATION
+ *                  (2) ARAS_SNAPSHOT_FILE_SCHEDULE
+ *                  (3) ARAS_SNAPSHOT_FILE_BLOCK
+ *
+ * @return  0 if the reload is started, -1 if it is delayed
+ */
+int aras_snapshot_reload_start(struct aras_snapshot_reload *reload, int files)
+{
+        reload->pending |= files;
+
+        if (reload->thread != NULL)
+                return -1;
+
+        reload->loading = reload->pending;
+        reload->pending = 0;
+        reload->thread = g_thread_new("aras-reload", aras_snapshot_reload_thread, reload);
+
+        return 0;
+}
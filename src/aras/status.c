@@ -0,0 +1,239 @@
+/**
+ * @file
+ * @author  Erasmo Alonso Iglesias <erasmo1982@users.sourceforge.net>
+ * @version 4.6
+ *
+ * @section LICENSE
+ *
+ * The ARAS Radio Automation System
+ * Copyright (C) 2020  Erasmo Alonso Iglesias
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * @section DESCRIPTION
+ *
+ * Source file for the ARAS Radio Automation System. Functions for the status
+ * module.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <aras/time.h>
+#include <aras/schedule.h>
+#include <aras/status.h>
+
+/**
+ * This function creates a named shared memory segment and maps it to publish
+ * the status of the engines. The segment is locked while it is published, so
+ * that a segment published by another process or channel is never reset. The
+ * lock is released by the system if the publisher dies, so a segment left over
+ * by a previous run is reused.
+ *
+ * @param   status  Pointer to the status structure
+ * @param   name    The name of the segment, a POSIX shared memory object name
+ *                  such as "/aras"
+ *
+ * @return  0 if success, -1 if error or if the segment is already published
+ */
+int aras_status_open(struct aras_status *status, char *name)
+{
+        int fd;
+        void *segment;
+
+        status->segment = NULL;
+        status->owner = 1;
+        status->fd = -1;
+        g_strlcpy(status->name, name, sizeof(status->name));
+
+        if ((fd = shm_open(name, O_CREAT | O_RDWR, 0644)) == -1)
+                return -1;
+
+        /* Only one publisher for each segment */
+        if (flock(fd, LOCK_EX | LOCK_NB) == -1) {
+                fprintf(stderr, "aras: status segment ""%s"" already in use\n", name);
+                close(fd);
+                return -1;
+        }
+
+        if (ftruncate(fd, sizeof(struct aras_status_segment)) == -1) {
+                close(fd);
+                return -1;
+        }
+
+        segment = mmap(NULL, sizeof(struct aras_status_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (segment == MAP_FAILED) {
+                close(fd);
+                return -1;
+        }
+
+        status->fd = fd;
+        status->segment = (struct aras_status_segment*)segment;
+        memset(status->segment, 0, sizeof(struct aras_status_segment));
+        status->segment->version = ARAS_STATUS_VERSION;
+
+        return 0;
+}
+
+/**
+ * This function maps a named shared memory segment published by another
+ * process, read only.
+ *
+ * @param   status  Pointer to the status structure
+ * @param   name    The name of the segment
+ *
+ * @return  0 if success, -1 if error or if the segment has another version
+ */
+int aras_status_attach(struct aras_status *status, char *name)
+{
+        int fd;
+        void *segment;
+        struct stat st;
+
+        status->segment = NULL;
+        status->owner = 0;
+        status->fd = -1;
+        g_strlcpy(status->name, name, sizeof(status->name));
+
+        if ((fd = shm_open(name, O_RDONLY, 0)) == -1)
+                return -1;
+
+        if (fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(struct aras_status_segment)) {
+                close(fd);
+                return -1;
+        }
+
+        segment = mmap(NULL, sizeof(struct aras_status_segment), PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (segment == MAP_FAILED)
+                return -1;
+
+        status->segment = (struct aras_status_segment*)segment;
+        if (status->segment->version != ARAS_STATUS_VERSION) {
+                aras_status_close(status);
+                return -1;
+        }
+
+        return 0;
+}
+
+/**
+ * This function unmaps a shared memory segment, and removes it if it was
+ * published by this process.
+ *
+ * @param   status  Pointer to the status structure
+ */
+void aras_status_close(struct aras_status *status)
+{
+        if (status->segment == NULL)
+                return;
+
+        munmap(status->segment, sizeof(struct aras_status_segment));
+        status->segment = NULL;
+        if (status->owner)
+                shm_unlink(status->name);
+
+        /* Release the lock after unlinking, so a new publisher gets a new segment */
+        if (status->fd != -1) {
+                close(status->fd);
+                status->fd = -1;
+        }
+}
+
+/**
+ * This function sets the names of the current and next blocks in a status
+ * segment according to the schedule.
+ *
+ * @param   segment     Pointer to the status segment
+ * @param   schedule    Pointer to the schedule structure
+ */
+void aras_status_set_blocks(struct aras_status_segment *segment, struct aras_schedule *schedule)
+{
+        struct aras_schedule_node *node;
+
+        node = aras_schedule_seek_node_current(schedule, aras_time_current());
+        g_strlcpy(segment->block_current, node != NULL ? node->block_name : "", sizeof(segment->block_current));
+        node = aras_schedule_seek_node_next(schedule, aras_time_current());
+        g_strlcpy(segment->block_next, node != NULL ? node->block_name : "", sizeof(segment->block_next));
+}
+
+/**
+ * This function publishes a status in the shared memory segment. The status
+ * is sampled beforehand, so the segment is only odd for the time of the copy.
+ *
+ * @param   status  Pointer to the status structure
+ * @param   segment Pointer to the sampled status, its version and sequence
+ *                  are ignored
+ */
+void aras_status_publish(struct aras_status *status, struct aras_status_segment *segment)
+{
+        struct aras_status_segment *shared;
+        gint sequence;
+
+        if ((shared = status->segment) == NULL)
+                return;
+
+        /* Odd sequence, readers retry */
+        sequence = shared->sequence;
+        g_atomic_int_set(&shared->sequence, sequence + 1);
+        __sync_synchronize();
+
+        shared->time = aras_time_real();
+        memcpy(shared->block_current, segment->block_current, sizeof(shared->block_current));
+        memcpy(shared->block_next, segment->block_next, sizeof(shared->block_next));
+        shared->block_player = segment->block_player;
+        shared->time_signal_player = segment->time_signal_player;
+
+        /* Even sequence, the copy is complete */
+        __sync_synchronize();
+        g_atomic_int_set(&shared->sequence, sequence + 2);
+}
+
+/**
+ * This function reads a consistent copy of a shared memory segment. It retries
+ * while the publisher is writing, without ever blocking it.
+ *
+ * @param   status  Pointer to the status structure
+ * @param   segment Pointer to the structure receiving the copy
+ *
+ * @return  0 if success, -1 if no consistent copy could be read
+ */
+int aras_status_read(struct aras_status *status, struct aras_status_segment *segment)
+{
+        gint sequence;
+        int retries;
+
+        if (status->segment == NULL)
+                return -1;
+
+        for (retries = 0; retries < ARAS_STATUS_MAX_RETRIES; retries++) {
+                if ((sequence = g_atomic_int_get(&status->segment->sequence)) & 1)
+                        continue;
+
+                __sync_synchronize();
+                memcpy(segment, status->segment, sizeof(struct aras_status_segment));
+                __sync_synchronize();
+
+                if (g_atomic_int_get(&status->segment->sequence) == sequence)
+                        return 0;
+        }
+
+        return -1;
+}
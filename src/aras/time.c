@@ -33,6 +33,73 @@
 #include <time.h>
 #include <aras/time.h>
 
+/* Virtual clock, time only advances when told so */
+static int aras_time_virtual = 0;
+static long long int aras_time_virtual_start = 0;
+static long long int aras_time_virtual_elapsed = 0;
+
+/**
+ * This function switches the time module to a virtual clock, so that the
+ * engine runs without real time passing. The virtual clock stands still until
+ * it is advanced.
+ *
+ * @param   start   The real time in microseconds since the Epoch at which the
+ *                  virtual clock starts
+ */
+void aras_time_virtual_init(long long int start)
+{
+        aras_time_virtual = 1;
+        aras_time_virtual_start = start;
+        aras_time_virtual_elapsed = 0;
+}
+
+/**
+ * This function advances the virtual clock.
+ *
+ * @param   time    The time to advance in miliseconds
+ */
+void aras_time_virtual_advance(long int time)
+{
+        aras_time_virtual_elapsed += (long long int)time * 1000;
+}
+
+/**
+ * This function returns the real time, or the virtual time if the virtual
+ * clock is in use.
+ *
+ * @return  The time in microseconds since the Epoch
+ */
+long long int aras_time_real(void)
+{
+        struct timeval tv;
+        struct timezone tz;
+
+        if (aras_time_virtual)
+                return aras_time_virtual_start + aras_time_virtual_elapsed;
+
+        gettimeofday(&tv, &tz);
+        return (long long int)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/**
+ * This function returns the monotonic time, or the time elapsed in the virtual
+ * clock if it is in use. Unlike the real time, it does not jump when the
+ * system clock is set. The virtual monotonic time starts at a non zero value,
+ * since the engine takes 0 as an unset time.
+ *
+ * @return  The monotonic time in microseconds
+ */
+long long int aras_time_monotonic(void)
+{
+        struct timespec ts;
+
+        if (aras_time_virtual)
+                return ARAS_TIME_VIRTUAL_MONOTONIC_START + aras_time_virtual_elapsed;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (long long int)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 /**
  * This function returns the current week time in miliseconds.
  *
@@ -40,13 +107,14 @@
  */
 long int aras_time_current(void)
 {
-        struct timeval tv;
-        struct timezone tz;
+        long long int now;
+        time_t t;
         struct tm tm;
 
-        gettimeofday(&tv, &tz);
-        localtime_r(&tv.tv_sec, &tm);
-        return ARAS_TIME_DAY * tm.tm_wday + ARAS_TIME_HOUR * tm.tm_hour + ARAS_TIME_MINUTE * tm.tm_min + ARAS_TIME_SECOND * tm.tm_sec + ldiv(tv.tv_usec, 1000).quot;
+        now = aras_time_real();
+        t = (time_t)(now / 1000000);
+        localtime_r(&t, &tm);
+        return ARAS_TIME_DAY * tm.tm_wday + ARAS_TIME_HOUR * tm.tm_hour + ARAS_TIME_MINUTE * tm.tm_min + ARAS_TIME_SECOND * tm.tm_sec + (long int)(now % 1000000 / 1000);
 }
 
 /**